@@ -1,23 +1,36 @@
 #include "MonitorPanel.h"
-#include "CoffeeEngine/Core/DataStructures/CircularBuffer.h"
-#include "CoffeeEngine/Core/SystemInfo.h"
-#include "CoffeeEngine/Core/Application.h"
-#include "CoffeeEngine/Core/Timer.h"
+#include "CoffeeEngine/Core/FileDialog.h"
+#include "CoffeeEngine/Core/MemoryProfiler.h"
+#include "CoffeeEngine/Core/Metrics.h"
+#include "CoffeeEngine/Renderer/OcclusionCuller.h"
+#include "CoffeeEngine/Renderer/Renderer.h"
+#include "CoffeeEngine/Scripting/Lua/LuaBackend.h"
 #include <cstdint>
+#include <filesystem>
 #include <imgui.h>
 #include <string>
 
 namespace Coffee {
 
+    // Plots the history of a metric, oldest sample on the left
+    static void PlotMetric(const char* label, const Metric& metric, const char* overlay, float height)
+    {
+        ImGui::PlotLines(label, [](void* data, int idx) -> float {
+            return ((const Metric*)data)->GetSample((uint32_t)idx);
+        }, (void*)&metric, (int)metric.GetSampleCount(), 0, overlay, 0.0f, FLT_MAX, ImVec2(0, height));
+    }
+
     void MonitorPanel::OnImGuiRender()
     {
-        static float FPS = 0.0f;
-        static float FrameTime = 0.0f;
-        static uint64_t MemoryUsage = 0.0f;
+        static Metric& fpsMetric = Metrics::Gauge("FPS");
+        static Metric& frameTimeMetric = Metrics::Gauge("Frame Time");
+        static Metric& memoryMetric = Metrics::Gauge("Process Memory");
+        static Metric& gpuFrameTimeMetric = Metrics::Gauge("GPU Frame Time");
 
-        FPS = Application::Get().GetFPS();
-        FrameTime = Application::Get().GetFrameTime();
-        MemoryUsage = SystemInfo::GetProcessMemoryUsage();
+        float FPS = fpsMetric.GetLast();
+        float FrameTime = frameTimeMetric.GetLast();
+        float MemoryUsage = memoryMetric.GetLast();
+        FrameTimeStats frameTimeStats = Metrics::GetFrameTimeStats();
 
 
         ImGui::Begin("Monitor");
@@ -55,7 +68,25 @@ namespace Coffee {
             ImGui::TableNextColumn();
             ImGui::Checkbox("Frame Time", &m_ShowFrameTime);
             ImGui::TableNextColumn();
-            ImGui::Text("%f", FrameTime);
+            ImGui::Text("%.3f ms", FrameTime);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("  p50 / p95 / p99");
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f / %.2f / %.2f ms", frameTimeStats.FrameTime.P50, frameTimeStats.FrameTime.P95, frameTimeStats.FrameTime.P99);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("  Max");
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f ms", frameTimeStats.FrameTime.Max);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("  Hitches");
+            ImGui::TableNextColumn();
+            if (frameTimeStats.HitchCount > 0)
+                ImGui::Text("%llu (last: frame %llu, %.2f ms)", (unsigned long long)frameTimeStats.HitchCount, (unsigned long long)frameTimeStats.LastHitchFrame, frameTimeStats.LastHitchTime);
+            else
+                ImGui::Text("0");
             ImGui::EndTable();
             ImGui::TreePop();
         }
@@ -68,10 +99,190 @@ namespace Coffee {
             ImGui::TableNextColumn();
             ImGui::Checkbox("Memory Usage", &m_MemoryUsage);
             ImGui::TableNextColumn();
-            ImGui::Text("%lu", MemoryUsage);
+            ImGui::Text("%.0f MB", MemoryUsage);
+            ImGui::EndTable();
+            ImGui::TreePop();
+        }
+        // GPU
+        if(ImGui::TreeNode("GPU")) {
+            if(!GpuProfiler::IsEnabled())
+            {
+                ImGui::TextDisabled("GPU timings need the OpenGL backend");
+            }
+
+            const GpuPassTimings& gpuTimings = Renderer::GetStats().GpuTimings;
+
+            ImGui::BeginTable("GpuTable", 2, ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_BordersOuterV | ImGuiTableFlags_RowBg);
+            ImGui::TableSetupColumn("GpuColumn1", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("GpuColumn2", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Checkbox("GPU Frame Time", &m_ShowGpuTime);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f ms", gpuTimings.FrameTime);
+            for(size_t i = 0; i < (size_t)GpuPass::Count; i++)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("  %s", GpuProfiler::GetPassName((GpuPass)i));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f ms", gpuTimings.PassTimes[i]);
+            }
+            // The GPU is the bottleneck when it is busy for most of the frame
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("Bound");
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", gpuTimings.FrameTime >= FrameTime * 0.9f ? "GPU" : "CPU");
+            ImGui::EndTable();
+            ImGui::TreePop();
+        }
+        // Memory by subsystem
+        if(ImGui::TreeNode("Memory by Subsystem")) {
+            if(!MemoryProfiler::IsCpuTrackingEnabled())
+            {
+                ImGui::TextDisabled("Heap tracking needs a build with COFFEE_MEMORY_PROFILING");
+            }
+
+            ImGui::BeginTable("SubsystemMemoryTable", 4, ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_BordersOuterV | ImGuiTableFlags_RowBg);
+            ImGui::TableSetupColumn("Subsystem", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Heap", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Textures", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Buffers", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableHeadersRow();
+
+            const double megabyte = 1024.0 * 1024.0;
+            for(size_t i = 0; i < (size_t)MemoryTag::Count; i++)
+            {
+                MemoryTag tag = (MemoryTag)i;
+                MemoryProfiler::TagStats stats = MemoryProfiler::GetStats(tag);
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", MemoryProfiler::GetTagName(tag));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f MB (%lld)", stats.CpuBytes / megabyte, (long long)stats.CpuAllocations);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f MB", stats.GpuBytes[(size_t)GpuMemoryType::Texture] / megabyte);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f MB", stats.GpuBytes[(size_t)GpuMemoryType::Buffer] / megabyte);
+            }
+            ImGui::EndTable();
+            ImGui::TreePop();
+        }
+        // Culling
+        if(ImGui::TreeNode("Culling")) {
+            bool occlusionCulling = OcclusionCuller::IsEnabled();
+            if(ImGui::Checkbox("Occlusion Culling", &occlusionCulling))
+            {
+                OcclusionCuller::SetEnabled(occlusionCulling);
+            }
+            if(ImGui::IsItemHovered())
+            {
+                ImGui::SetTooltip("Hides the meshes behind the static occluders at runtime");
+            }
+
+            Metric* testedMetric = Metrics::Find("Occlusion Tested");
+            Metric* occludedMetric = Metrics::Find("Occlusion Culled");
+            Metric* trianglesMetric = Metrics::Find("Occluder Triangles");
+
+            ImGui::BeginTable("CullingTable", 2, ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_BordersOuterV | ImGuiTableFlags_RowBg);
+            ImGui::TableSetupColumn("CullingColumn1", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("CullingColumn2", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("Tested");
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", testedMetric ? testedMetric->GetLast() : 0.0f);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("Occluded");
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", occludedMetric ? occludedMetric->GetLast() : 0.0f);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("Occluder Triangles");
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", trianglesMetric ? trianglesMetric->GetLast() : 0.0f);
             ImGui::EndTable();
             ImGui::TreePop();
         }
+        // Scripts
+        if(ImGui::TreeNode("Scripts")) {
+            bool parallelScripts = LuaBackend::IsParallelScriptsEnabled();
+            if(ImGui::Checkbox("Parallel Thread-Safe Scripts", &parallelScripts))
+            {
+                LuaBackend::SetParallelScripts(parallelScripts);
+            }
+            if(ImGui::IsItemHovered())
+            {
+                ImGui::SetTooltip("Applies to the scripts instanced afterwards");
+            }
+
+            std::vector<std::pair<std::string, LuaScriptStats>> scriptStats = LuaBackend::GetScriptStats();
+            if(scriptStats.empty())
+            {
+                ImGui::TextDisabled("No script has run");
+            }
+
+            ImGui::BeginTable("ScriptsTable", 6, ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_BordersOuterV | ImGuiTableFlags_RowBg);
+            ImGui::TableSetupColumn("Script", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("CPU", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Instructions", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Allocated", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Live", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Violations", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableHeadersRow();
+
+            for(const auto& [scriptPath, stats] : scriptStats)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s (%u)", std::filesystem::path(scriptPath).filename().string().c_str(), stats.instances);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f ms", stats.cpuTime);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long)stats.instructions);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f KB", stats.allocatedBytes / 1024.0);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f KB", stats.liveBytes / 1024.0);
+                ImGui::TableNextColumn();
+                if(stats.violations > 0)
+                    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%llu", (unsigned long long)stats.violations);
+                else
+                    ImGui::Text("0");
+            }
+            ImGui::EndTable();
+            ImGui::TreePop();
+        }
+
+        ImGui::Separator();
+        if(ImGui::Button("Export CSV"))
+        {
+            FileDialogArgs args;
+            args.Filters = {{"CSV", "csv"}};
+            args.DefaultName = "Metrics.csv";
+            const std::filesystem::path& path = FileDialog::SaveFile(args);
+
+            if (!path.empty())
+            {
+                Metrics::ExportCSV(path);
+            }
+        }
+        ImGui::SameLine();
+        if(ImGui::Button("Export JSON"))
+        {
+            FileDialogArgs args;
+            args.Filters = {{"JSON", "json"}};
+            args.DefaultName = "Metrics.json";
+            const std::filesystem::path& path = FileDialog::SaveFile(args);
+
+            if (!path.empty())
+            {
+                Metrics::ExportJSON(path);
+            }
+        }
         ImGui::EndChild();
 
         ImGui::NextColumn();
@@ -83,45 +294,38 @@ namespace Coffee {
         {
             ImGui::Text("FPS");
             std::string FPSoverlay = "FPS: " + std::to_string((int)FPS);
-            ImGui::PlotLines("##FPS", [](void* data, int idx) -> float {
-                return FPS;
-            }, NULL, 100, 0, FPSoverlay.c_str(), FLT_MIN, FLT_MAX, ImVec2(0, 80)); // Minimum height of 80
+            PlotMetric("##FPS", fpsMetric, FPSoverlay.c_str(), 80.0f); // Minimum height of 80
         }
 
         if (m_ShowFrameTime)
         {
             ImGui::Text("Frame Time");
             std::string FrameTimeOverlay = "Frame Time: " + std::to_string(FrameTime) + " ms";
-            ImGui::PlotLines("##FrameTime", [](void* data, int idx) -> float {
-                return FrameTime;
-            }, NULL, 100, 0, FrameTimeOverlay.c_str(), FLT_MIN, FLT_MAX, ImVec2(0, 80)); // Minimum height of 80
+            PlotMetric("##FrameTime", frameTimeMetric, FrameTimeOverlay.c_str(), 80.0f);
         }
 
-        if (m_MemoryUsage)
+        if (m_ShowGpuTime && GpuProfiler::IsEnabled())
         {
-            ImGui::Text("Memory Usage");
-
-            //Test if this is better or is better to update the memory usage every x time
-            static CircularBuffer<uint64_t> memoryUsage(10000);
-
-            static Timer timer(0.5f, true, false, [&]() {
-                memoryUsage.push_back(MemoryUsage);
-            });
-
-            static float yMin = 0.0f;
-            static float yMax = 0.0f;
+            ImGui::Text("GPU Frame Time");
+            std::string GpuOverlay = "GPU: " + std::to_string(gpuFrameTimeMetric.GetLast()) + " ms";
+            PlotMetric("##GpuFrameTime", gpuFrameTimeMetric, GpuOverlay.c_str(), 80.0f);
 
-            std::string MemoryUsageOverlay = "";
-            if(memoryUsage.size() > 0)
+            for(size_t i = 0; i < (size_t)GpuPass::Count; i++)
             {
-                MemoryUsageOverlay = "Memory Usage: " + std::to_string(memoryUsage.back()) + " MB";
+                const char* passName = GpuProfiler::GetPassName((GpuPass)i);
+                if (Metric* passMetric = Metrics::Find(std::string("GPU ") + passName))
+                {
+                    std::string label = std::string("##Gpu") + passName;
+                    PlotMetric(label.c_str(), *passMetric, passName, 40.0f);
+                }
             }
-            ImGui::PlotLines("##MemoryUsage", [](void* data, int idx) -> float {
-                auto& memoryUsage = *(CircularBuffer<uint64_t>*)data;
-                uint64_t& mu = memoryUsage[idx];
-                if (mu > yMax - 100) yMax = mu + 100;
-                return mu;
-            }, &memoryUsage, memoryUsage.size(), 0, MemoryUsageOverlay.c_str(), yMin, yMax, ImVec2(0, 80)); // Minimum height of 80
+        }
+
+        if (m_MemoryUsage)
+        {
+            ImGui::Text("Memory Usage");
+            std::string MemoryUsageOverlay = "Memory Usage: " + std::to_string((uint64_t)MemoryUsage) + " MB";
+            PlotMetric("##MemoryUsage", memoryMetric, MemoryUsageOverlay.c_str(), 80.0f);
         }
         ImGui::EndChild();
 
@@ -1,6 +1,7 @@
 #include "OutputPanel.h"
 #include "CoffeeEngine/Core/Application.h"
 #include "CoffeeEngine/Core/Log.h"
+#include <algorithm>
 #include <cstdlib>
 #include <imgui.h>
 #include <spdlog/spdlog.h>
@@ -14,7 +15,26 @@ namespace Coffee {
         if (!m_Visible) return;
 
         ImGui::Begin("Output", nullptr, ImGuiWindowFlags_HorizontalScrollbar);
-        const std::vector<std::string>& logBuffer = Coffee::Log::GetLogBuffer();
+
+        if (ImGui::BeginPopupContextWindow())
+        {
+            if (ImGui::MenuItem("Clear"))
+                Coffee::Log::ClearLogBuffer();
+
+            int capacity = (int)Coffee::Log::GetLogBufferCapacity();
+            if (ImGui::InputInt("Max Messages", &capacity, 256, 1024, ImGuiInputTextFlags_EnterReturnsTrue))
+                Coffee::Log::SetLogBufferCapacity((size_t)std::max(capacity, 1));
+
+            ImGui::EndPopup();
+        }
+
+        // The buffer is only copied when a new message arrives
+        uint64_t logBufferVersion = Coffee::Log::GetLogBufferVersion();
+        if (logBufferVersion != m_LogBufferVersion)
+        {
+            Coffee::Log::CopyLogBuffer(m_LogBuffer);
+            m_LogBufferVersion = logBufferVersion;
+        }
         /* for (const auto& log : logBuffer)
         {
             auto [before_level, level_str, after_level] = ParseLogMessage(log);
@@ -22,7 +42,7 @@ namespace Coffee {
             RenderLogMessage(before_level, level_str, after_level, level);
         } */
 
-        for (const std::string& log : logBuffer)
+        for (const std::string& log : m_LogBuffer)
         {
             auto [before_level, level_str, after_level] = ParseLogMessage(log);
             spdlog::level::level_enum level = spdlog::level::from_str(level_str);
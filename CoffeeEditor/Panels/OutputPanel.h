@@ -6,6 +6,10 @@
 #include "Panel.h"
 #include "imgui.h"
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace Coffee {
 
   class OutputPanel : public Panel {
@@ -42,6 +46,8 @@ namespace Coffee {
      */
     ImVec4 GetLogLevelColor(spdlog::level::level_enum level);
 
+    std::vector<std::string> m_LogBuffer; ///< Copy of the log buffer shown in the panel.
+    uint64_t m_LogBufferVersion = UINT64_MAX; ///< Version of the log buffer when it was copied.
   };
 
 } // Coffee
\ No newline at end of file
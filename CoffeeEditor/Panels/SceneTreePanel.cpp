@@ -66,11 +66,12 @@ namespace Coffee {
 
         ImGui::BeginChild("entity tree", {0,0}, ImGuiChildFlags_Border);
 
-        auto view = m_Context->m_Registry.view<entt::entity>();
+        // Entities reserved by a streamed scene have no components until their section is merged
+        auto view = m_Context->m_Registry.view<HierarchyComponent>();
         for(auto entityID: view)
         {
             Entity entity{ entityID, m_Context.get()};
-            auto& hierarchyComponent = entity.GetComponent<HierarchyComponent>();
+            auto& hierarchyComponent = view.get<HierarchyComponent>(entityID);
 
             if(hierarchyComponent.m_Parent == entt::null)
             {
@@ -396,6 +397,22 @@ namespace Coffee {
                 }
                 ImGui::Checkbox("Draw AABB", &meshComponent.drawAABB);
 
+                // Static meshes are merged with the other static meshes of their material when the runtime starts
+                bool isStatic = entity.HasComponent<StaticComponent>();
+                if(ImGui::Checkbox("Static", &isStatic))
+                {
+                    if(isStatic)
+                        entity.AddComponent<StaticComponent>();
+                    else
+                        entity.RemoveComponent<StaticComponent>();
+                }
+
+                if(isStatic)
+                {
+                    // Large meshes that hide others, rasterized by the occlusion culling at runtime
+                    ImGui::Checkbox("Occluder", &entity.GetComponent<StaticComponent>().Occluder);
+                }
+
                 if(!isCollapsingHeaderOpen)
                 {
                     entity.RemoveComponent<MeshComponent>();
@@ -575,19 +592,21 @@ namespace Coffee {
                 ImGui::Text(scriptComponent.script.GetPath().string().c_str());
                 */
 
-                // Get the exposed variables
-                std::vector<LuaVariable> exposedVariables = LuaBackend::MapVariables(scriptComponent.script.GetPath().string());
+                // The variables live in the script instance of this entity
+                sol::environment* instanceEnvironment = LuaBackend::GetInstanceEnvironment(entity);
+                if (!instanceEnvironment)
+                {
+                    ImGui::TextDisabled("The script is not running");
+                }
+
+                // Get the exposed variables, cached when the script was compiled
+                static const std::vector<LuaVariable> noVariables;
+                const std::vector<LuaVariable>& exposedVariables = instanceEnvironment ? LuaBackend::MapVariables(scriptComponent.script.GetPath().string()) : noVariables;
 
                 // print the exposed variables
-                for (auto& variable : exposedVariables)
+                for (const auto& variable : exposedVariables)
                 {
-                    auto it = LuaBackend::scriptEnvironments.find(scriptComponent.script.GetPath().string());
-                    if (it == LuaBackend::scriptEnvironments.end()) {
-                        COFFEE_CORE_ERROR("Script environment for {0} not found", scriptComponent.script.GetPath().string());
-                        continue;
-                    }
-
-                    sol::environment& env = it->second;
+                    sol::environment& env = *instanceEnvironment;
 
                     switch (variable.type)
                     {
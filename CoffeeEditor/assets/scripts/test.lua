@@ -18,7 +18,7 @@ end
 function OnUpdate()
     --log("OnUpdate()")
 
-    local entityTag = entity:GetComponent(entity)
+    local entityTag = self:GetComponent(component.Tag).tag
     --print("Entity tag: " .. entityTag)
 
     if input.is_key_pressed(input.keycode.Space) then
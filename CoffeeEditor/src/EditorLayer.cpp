@@ -15,6 +15,7 @@
 #include "CoffeeEngine/Project/Project.h"
 #include "CoffeeEngine/Renderer/DebugRenderer.h"
 #include "CoffeeEngine/Renderer/EditorCamera.h"
+#include "CoffeeEngine/Renderer/FrameCapture.h"
 #include "CoffeeEngine/Renderer/Renderer.h"
 #include "CoffeeEngine/Scene/Components.h"
 #include "CoffeeEngine/Scene/PrimitiveMesh.h"
@@ -151,6 +152,10 @@ namespace Coffee {
 
                     Entity hoveredEntity = entityID == 16777215 ? Entity() : Entity((entt::entity)entityID, m_ActiveScene.get());
 
+                    // The ID buffer was rendered last frame, the entity may have been destroyed since
+                    if(hoveredEntity && !hoveredEntity.IsValid())
+                        hoveredEntity = Entity();
+
                     m_SceneTreePanel.SetSelectedEntity(hoveredEntity);
                 }
             }
@@ -200,6 +205,7 @@ namespace Coffee {
                 if (ImGui::MenuItem(ICON_LC_FOLDER_OPEN " Open Scene...", "Ctrl+O")) { OpenScene(); }
                 if (ImGui::MenuItem(ICON_LC_SAVE " Save Scene", "Ctrl+S")) { SaveScene(); }
                 if (ImGui::MenuItem(ICON_LC_SAVE " Save Scene As...", "Ctrl+Shift+S")) { SaveSceneAs(); }
+                if (ImGui::MenuItem("Bake Static Batches", nullptr, false, m_SceneState == SceneState::Edit)) { m_EditorScene->BakeStaticBatches(); }
                 if (ImGui::MenuItem(ICON_LC_X " Exit")) { Application::Get().Close(); }
                 ImGui::EndMenu();
             }
@@ -479,6 +485,29 @@ namespace Coffee {
 
         ImGui::DragFloat("Exposure", &Renderer::GetRenderSettings().Exposure, 0.001f, 100.0f);
 
+        ImGui::Checkbox("Bindless Textures", &Renderer::GetRenderSettings().BindlessTextures);
+        ImGui::Checkbox("Texture Arrays", &Renderer::GetRenderSettings().TextureArrays);
+
+        // Saved with the scene
+        SceneSettings sceneSettings = m_ActiveScene->GetSettings();
+        if(ImGui::Checkbox("Sorted Transforms", &sceneSettings.SortedTransforms))
+        {
+            m_ActiveScene->SetSettings(sceneSettings);
+        }
+
+        if(ImGui::Button("Capture Frame"))
+        {
+            FileDialogArgs args;
+            args.Filters = {{"Coffee Frame Capture", "TeaCapture"}};
+            args.DefaultName = "Frame.TeaCapture";
+            const std::filesystem::path& path = FileDialog::SaveFile(args);
+
+            if (!path.empty())
+            {
+                FrameCapture::RequestCapture(path);
+            }
+        }
+
         ImGui::End();
 
         // Debug Window for testing the ResourceRegistry
@@ -640,17 +669,10 @@ namespace Coffee {
 
     void EditorLayer::OnScenePlay()
     {
-        if(m_ActiveScene->m_FilePath.empty())
-        {
-            COFFEE_ERROR("Scene is not saved! Please save the scene before playing.");
-            return;
-        }
-
         m_SceneState = SceneState::Play;
 
-        Scene::Save(m_EditorScene->m_FilePath, m_EditorScene);
-
-        m_ActiveScene = Scene::Load(m_ActiveScene->m_FilePath);
+        // The runtime works on a copy, the editor scene and its file are left untouched
+        m_ActiveScene = Scene::Copy(m_EditorScene);
         m_ActiveScene->OnInitRuntime();
 
         m_SceneTreePanel.SetContext(m_ActiveScene);
@@ -732,12 +754,17 @@ namespace Coffee {
     void EditorLayer::OpenScene()
     {
         FileDialogArgs args;
-        args.Filters = {{"Coffee Scene", "TeaScene"}};
+        args.Filters = {{"Coffee Scene", "TeaScene,TeaSceneBin"}};
         const std::filesystem::path& path = FileDialog::OpenFile(args);
 
-        if (!path.empty() and path.extension() == ".TeaScene")
+        if (!path.empty() and (path.extension() == ".TeaScene" or path.extension() == ".TeaSceneBin"))
         {
-            m_EditorScene = Scene::Load(path);
+            // Binary scenes stream in over the next frames instead of freezing the editor
+            Ref<Scene> scene = Scene::LoadAsync(path);
+            if (!scene)
+                return;
+
+            m_EditorScene = scene;
             m_ActiveScene = m_EditorScene;
             m_ActiveScene->OnInitEditor();
 
@@ -755,12 +782,14 @@ namespace Coffee {
     void EditorLayer::SaveScene()
     {
         FileDialogArgs args;
-        args.Filters = {{"Coffee Scene", "TeaScene"}};
+        args.Filters = {{"Coffee Scene", "TeaScene"}, {"Coffee Binary Scene", "TeaSceneBin"}};
         const std::filesystem::path& path = FileDialog::SaveFile(args);
 
         if (!path.empty())
         {
-            Scene::Save(path, m_ActiveScene);
+            // JSON is kept for version control diffs, the binary format loads much faster
+            ResourceFormat format = path.extension() == ".TeaSceneBin" ? ResourceFormat::Binary : ResourceFormat::JSON;
+            Scene::Save(path, m_ActiveScene, format);
         }
         else
         {
@@ -6,6 +6,7 @@
 #include "CoffeeEngine/Core/Layer.h"
 #include "CoffeeEngine/Core/Log.h"
 #include "CoffeeEngine/Core/Assert.h"
+#include "CoffeeEngine/Core/JobSystem.h"
 
 // ---Entry Point------------------
 #include "CoffeeEngine/Core/EntryPoint.h"
@@ -1,7 +1,12 @@
 #include "CoffeeEngine/Core/Application.h"
+#include "CoffeeEngine/Core/FrameAllocator.h"
 #include "CoffeeEngine/Core/Layer.h"
+#include "CoffeeEngine/Core/MemoryProfiler.h"
+#include "CoffeeEngine/Core/Metrics.h"
 #include "CoffeeEngine/Core/Stopwatch.h"
+#include "CoffeeEngine/Core/SystemInfo.h"
 #include "CoffeeEngine/Events/KeyEvent.h"
+#include "CoffeeEngine/IO/FileWatcher.h"
 #include "CoffeeEngine/Renderer/Renderer.h"
 
 #include <SDL3/SDL_timer.h>
@@ -12,6 +17,8 @@ namespace Coffee
 {
     Application* Application::s_Instance = nullptr;
 
+    static constexpr double s_MemorySampleInterval = 0.5; ///< Seconds between two samples of the process memory.
+
     Application::Application()
     {
         ZoneScoped;
@@ -22,14 +29,22 @@ namespace Coffee
         m_Window = Window::Create(WindowProps("Coffee Engine"));
         SetEventCallback(COFFEE_BIND_EVENT_FN(OnEvent));
 
+        FrameAllocator::Init();
         Renderer::Init();
 
+        FileWatcher::Init();
+
         m_ImGuiLayer = new ImGuiLayer();
 		PushOverlay(m_ImGuiLayer);
     }
 
     Application::~Application()
     {
+        FileWatcher::Shutdown();
+
+        // The render queue points into the frame arenas
+        Renderer::Shutdown();
+        FrameAllocator::Shutdown();
     }
 
     void Application::PushLayer(Layer* layer)
@@ -75,19 +90,40 @@ namespace Coffee
 
         static Stopwatch frameTimeStopwatch;
 
+        Metric& fpsMetric = Metrics::Gauge("FPS");
+        Metric& memoryMetric = Metrics::Gauge("Process Memory");
+        double memorySampleElapsed = s_MemorySampleInterval;
+
         while (m_Running)
         {   
             ZoneScopedN("RunLoop");
 
+            FrameAllocator::NewFrame();
+
             m_LastFrameTime = frameTimeStopwatch.GetPreciseElapsedTime();
             frameTimeStopwatch.Reset();
             frameTimeStopwatch.Start();
 
             float deltaTime = m_LastFrameTime;
 
+            // Reading the process memory is a system call, it is sampled a few times per second
+            memorySampleElapsed += m_LastFrameTime;
+            if (memorySampleElapsed >= s_MemorySampleInterval)
+            {
+                memoryMetric.Set(SystemInfo::GetProcessMemoryUsage());
+                memorySampleElapsed = 0.0;
+            }
+
+            // Closes the metrics of the last frame before this one starts adding to them
+            fpsMetric.Set(m_LastFrameTime > 0.0 ? GetFPS() : 0.0f);
+            Metrics::EndFrame(GetFrameTime());
+
             //Poll and handle events
             ProcessEvents();
 
+            //Reload the resources that changed on disk
+            FileWatcher::Update();
+
             //Update and render
             {
                 ZoneScopedN("LayerStack Update");
@@ -97,14 +133,18 @@ namespace Coffee
             }
 
             //Render ImGui
-            m_ImGuiLayer->Begin();
             {
-                ZoneScopedN("LayerStack ImGuiRender");
+                COFFEE_MEMORY_TAG(ImGui);
 
-                for(Layer* layer : m_LayerStack)
-                    layer->OnImGuiRender();
+                m_ImGuiLayer->Begin();
+                {
+                    ZoneScopedN("LayerStack ImGuiRender");
+
+                    for(Layer* layer : m_LayerStack)
+                        layer->OnImGuiRender();
+                }
+                m_ImGuiLayer->End();
             }
-            m_ImGuiLayer->End();
 
             m_Window->OnUpdate();
         }
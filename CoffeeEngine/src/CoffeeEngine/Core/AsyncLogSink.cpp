@@ -0,0 +1,237 @@
+#include "CoffeeEngine/Core/AsyncLogSink.h"
+
+#include <algorithm>
+#include <array>
+#include <spdlog/details/log_msg.h>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee
+{
+    // Single producer, single consumer ring. The producer is the thread that owns it, the consumer is the flusher.
+    class AsyncLogSink::Ring
+    {
+      public:
+        struct Record
+        {
+            spdlog::level::level_enum Level = spdlog::level::off;
+            spdlog::log_clock::time_point Time;
+            size_t ThreadId = 0;
+            spdlog::string_view_t LoggerName; // Points to the name of the logger, loggers outlive the sink
+            spdlog::source_loc Source;
+            std::string Payload; // Reused between messages, so the steady state does not allocate
+        };
+
+        bool TryPush(const spdlog::details::log_msg& msg)
+        {
+            size_t head = m_Head.load(std::memory_order_relaxed);
+            if (head - m_Tail.load(std::memory_order_acquire) == RingCapacity)
+                return false;
+
+            Record& record = m_Records[head % RingCapacity];
+            record.Level = msg.level;
+            record.Time = msg.time;
+            record.ThreadId = msg.thread_id;
+            record.LoggerName = msg.logger_name;
+            record.Source = msg.source;
+            record.Payload.assign(msg.payload.data(), msg.payload.size());
+
+            m_Head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        template <typename Func>
+        size_t Drain(Func&& func)
+        {
+            size_t tail = m_Tail.load(std::memory_order_relaxed);
+            size_t head = m_Head.load(std::memory_order_acquire);
+
+            for (size_t i = tail; i != head; i++)
+            {
+                func(m_Records[i % RingCapacity]);
+            }
+
+            m_Tail.store(head, std::memory_order_release);
+            return head - tail;
+        }
+
+        bool Empty() const { return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire); }
+
+      private:
+        alignas(64) std::atomic<size_t> m_Head = 0;
+        alignas(64) std::atomic<size_t> m_Tail = 0;
+        std::array<Record, RingCapacity> m_Records;
+    };
+
+    AsyncLogSink::AsyncLogSink(std::vector<spdlog::sink_ptr> sinks)
+        : m_Sinks(std::move(sinks))
+    {
+        m_Running = true;
+        m_Flusher = std::thread(&AsyncLogSink::FlusherLoop, this);
+    }
+
+    AsyncLogSink::~AsyncLogSink()
+    {
+        Stop();
+    }
+
+    AsyncLogSink::Ring& AsyncLogSink::GetThreadRing()
+    {
+        struct ThreadRing
+        {
+            AsyncLogSink* Owner = nullptr;
+            std::shared_ptr<Ring> Buffer;
+        };
+        thread_local ThreadRing threadRing;
+
+        if (threadRing.Owner != this)
+        {
+            threadRing.Owner = this;
+            threadRing.Buffer = std::make_shared<Ring>();
+
+            std::lock_guard<std::mutex> lock(m_RingsMutex);
+            m_Rings.push_back(threadRing.Buffer);
+        }
+
+        return *threadRing.Buffer;
+    }
+
+    void AsyncLogSink::log(const spdlog::details::log_msg& msg)
+    {
+        if (!m_Running)
+        {
+            std::lock_guard<std::mutex> lock(m_SinksMutex);
+            Forward(msg);
+            return;
+        }
+
+        Ring& ring = GetThreadRing();
+
+        while (!ring.TryPush(msg))
+        {
+            m_WakeCondition.notify_one();
+            std::this_thread::yield();
+
+            if (!m_Running)
+            {
+                std::lock_guard<std::mutex> lock(m_SinksMutex);
+                Forward(msg);
+                return;
+            }
+        }
+
+        // Errors are shown right away instead of waiting for the next flush interval
+        if (msg.level >= spdlog::level::err)
+            m_WakeCondition.notify_one();
+    }
+
+    void AsyncLogSink::flush()
+    {
+        if (!m_Running || std::this_thread::get_id() == m_Flusher.get_id())
+            return;
+
+        std::unique_lock<std::mutex> lock(m_WakeMutex);
+        uint64_t request = ++m_FlushRequests;
+        m_WakeCondition.notify_one();
+        m_FlushedCondition.wait(lock, [this, request] { return m_FlushesDone >= request || !m_Running; });
+    }
+
+    void AsyncLogSink::Stop()
+    {
+        if (!m_Running.exchange(false))
+            return;
+
+        m_WakeCondition.notify_one();
+        m_Flusher.join();
+
+        {
+            // The flusher is gone, but producers that saw m_Running false already forward directly
+            std::lock_guard<std::mutex> lock(m_SinksMutex);
+
+            Drain();
+            for (const spdlog::sink_ptr& sink : m_Sinks)
+            {
+                sink->flush();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_WakeMutex);
+        m_FlushedCondition.notify_all();
+    }
+
+    bool AsyncLogSink::Drain()
+    {
+        // The wrapped sinks are slow, the list is copied so new threads are not blocked while forwarding
+        std::vector<std::shared_ptr<Ring>> rings;
+        {
+            std::lock_guard<std::mutex> lock(m_RingsMutex);
+            rings = m_Rings;
+        }
+
+        size_t forwarded = 0;
+        for (const std::shared_ptr<Ring>& ring : rings)
+        {
+            forwarded += ring->Drain([this](const Ring::Record& record) {
+                spdlog::details::log_msg msg(record.Time, record.Source, record.LoggerName, record.Level, spdlog::string_view_t(record.Payload.data(), record.Payload.size()));
+                msg.thread_id = record.ThreadId;
+                Forward(msg);
+            });
+        }
+        rings.clear();
+
+        std::lock_guard<std::mutex> lock(m_RingsMutex);
+
+        // Rings only referenced here belong to threads that have exited
+        m_Rings.erase(std::remove_if(m_Rings.begin(), m_Rings.end(), [](const std::shared_ptr<Ring>& ring) {
+            return ring.use_count() == 1 && ring->Empty();
+        }), m_Rings.end());
+
+        return forwarded > 0;
+    }
+
+    void AsyncLogSink::Forward(const spdlog::details::log_msg& msg)
+    {
+        for (const spdlog::sink_ptr& sink : m_Sinks)
+        {
+            if (sink->should_log(msg.level))
+                sink->log(msg);
+        }
+    }
+
+    void AsyncLogSink::FlusherLoop()
+    {
+        tracy::SetThreadName("Log Flusher");
+
+        while (m_Running)
+        {
+            uint64_t flushRequests;
+            {
+                std::unique_lock<std::mutex> lock(m_WakeMutex);
+                m_WakeCondition.wait_for(lock, FlushInterval);
+                flushRequests = m_FlushRequests;
+            }
+
+            {
+                // Uncontended while running, producers only forward directly once Stop() cleared m_Running
+                std::lock_guard<std::mutex> lock(m_SinksMutex);
+
+                bool forwarded = Drain();
+
+                if (forwarded || flushRequests != m_FlushesDone)
+                {
+                    for (const spdlog::sink_ptr& sink : m_Sinks)
+                    {
+                        sink->flush();
+                    }
+                }
+            }
+
+            if (flushRequests != m_FlushesDone)
+            {
+                std::lock_guard<std::mutex> lock(m_WakeMutex);
+                m_FlushesDone = flushRequests;
+                m_FlushedCondition.notify_all();
+            }
+        }
+    }
+
+} // namespace Coffee
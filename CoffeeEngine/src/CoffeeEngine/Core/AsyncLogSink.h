@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <spdlog/sinks/sink.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Coffee
+{
+    /**
+     * @defgroup core Core
+     * @{
+     */
+
+    /**
+     * @brief A sink that hands log messages to a background thread.
+     *
+     * Every thread that logs gets its own lock-free single producer ring of messages. The calling
+     * thread only copies the formatted payload into its ring; the flusher thread drains all the
+     * rings and forwards the messages to the wrapped sinks. After Stop() producers forward their
+     * messages directly; both paths hold the same mutex, so the wrapped sinks do not need to be
+     * thread safe. When a ring is full the producer waits for the flusher instead of dropping messages.
+     */
+    class AsyncLogSink : public spdlog::sinks::sink
+    {
+      public:
+        static constexpr size_t RingCapacity = 1024; ///< Messages buffered per thread.
+        static constexpr std::chrono::milliseconds FlushInterval{10}; ///< Time the flusher sleeps when there is nothing to do.
+
+        /**
+         * @brief Starts the flusher thread.
+         * @param sinks The sinks the messages are forwarded to. Their pattern must be set before.
+         */
+        AsyncLogSink(std::vector<spdlog::sink_ptr> sinks);
+
+        /**
+         * @brief Forwards the pending messages and stops the flusher thread.
+         */
+        ~AsyncLogSink() override;
+
+        void log(const spdlog::details::log_msg& msg) override;
+
+        /**
+         * @brief Blocks until every message logged before the call has been forwarded.
+         */
+        void flush() override;
+
+        /**
+         * @brief Ignored, the wrapped sinks are formatted from the flusher thread and keep their own pattern.
+         */
+        void set_pattern(const std::string& pattern) override {}
+
+        /**
+         * @brief Ignored, the wrapped sinks are formatted from the flusher thread and keep their own pattern.
+         */
+        void set_formatter(std::unique_ptr<spdlog::formatter> sinkFormatter) override {}
+
+        /**
+         * @brief Forwards the pending messages and stops the flusher thread.
+         *
+         * Messages logged afterwards are forwarded directly on the calling thread.
+         */
+        void Stop();
+
+      private:
+        class Ring;
+
+        Ring& GetThreadRing();
+        bool Drain();
+        void Forward(const spdlog::details::log_msg& msg);
+        void FlusherLoop();
+
+      private:
+        std::vector<spdlog::sink_ptr> m_Sinks; ///< The wrapped sinks, only written to while holding m_SinksMutex.
+
+        std::mutex m_RingsMutex; ///< Protects m_Rings, only taken when a thread logs for the first time.
+        std::vector<std::shared_ptr<Ring>> m_Rings; ///< The rings of every thread that logged.
+
+        std::thread m_Flusher; ///< Drains the rings.
+        std::atomic<bool> m_Running = false; ///< False once the flusher is stopped.
+        std::mutex m_WakeMutex; ///< Used with m_WakeCondition.
+        std::condition_variable m_WakeCondition; ///< Wakes the flusher before the flush interval.
+        std::condition_variable m_FlushedCondition; ///< Wakes the threads waiting in flush().
+        uint64_t m_FlushRequests = 0; ///< Number of flushes requested, protected by m_WakeMutex.
+        uint64_t m_FlushesDone = 0; ///< Number of flushes completed, protected by m_WakeMutex.
+
+        std::mutex m_SinksMutex; ///< Serializes the drains with the messages forwarded directly once the flusher stops.
+    };
+
+    /** @} */
+} // namespace Coffee
@@ -45,6 +45,14 @@ namespace Coffee {
 
         std::vector<ObjectContainer<T>> Query(const Frustum& frustum) const;
 
+        /**
+         * @brief Appends the objects inside a frustum to a container, so per frame queries can reuse transient storage.
+         * @param frustum The frustum.
+         * @param results The container the objects are appended to.
+         */
+        template <typename Container>
+        void Query(const Frustum& frustum, Container& results) const { Query(rootNode, frustum, results); }
+
     private:
         void Insert(OctreeNode<T>& node, const ObjectContainer<T>& object);
         void InsertIntoLeaf(OctreeNode<T>& node, const ObjectContainer<T>& object);
@@ -53,7 +61,8 @@ namespace Coffee {
         void Subdivide(OctreeNode<T>& node);
         void CreateChildren(OctreeNode<T>& node, const glm::vec3& center);
 
-        void Query(const OctreeNode<T>& node, const Frustum& frustum, std::vector<ObjectContainer<T>>& results) const;
+        template <typename Container>
+        void Query(const OctreeNode<T>& node, const Frustum& frustum, Container& results) const;
 
         OctreeNode<T> rootNode;
         int maxObjectsPerNode;
@@ -139,7 +148,8 @@ namespace Coffee {
     }
 
     template <typename T>
-    void Octree<T>::Query(const OctreeNode<T>& node, const Frustum& frustum, std::vector<ObjectContainer<T>>& results) const
+    template <typename Container>
+    void Octree<T>::Query(const OctreeNode<T>& node, const Frustum& frustum, Container& results) const
     {
         if (!frustum.Contains(node.aabb))
             return;
@@ -1,5 +1,11 @@
 #pragma once
 
+#include "CoffeeEngine/Core/JobSystem.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
 extern Coffee::Application* Coffee::CreateApplication();
 
 int main(int argc, const char** argv)
@@ -7,9 +13,21 @@ int main(int argc, const char** argv)
     Coffee::Log::Init();
     COFFEE_CORE_WARN("Initialized Log!");
 
+    // --job-workers N overrides the worker count, by default one per physical core minus the main thread
+    uint32_t jobWorkers = 0;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string(argv[i]) == "--job-workers")
+            jobWorkers = (uint32_t)std::max(0, std::atoi(argv[i + 1]));
+    }
+    Coffee::JobSystem::Init(jobWorkers);
+
     auto app = Coffee::CreateApplication();
     app->Run();
     delete app;
 
+    Coffee::JobSystem::Shutdown();
+    Coffee::Log::Shutdown();
+
     return 0;
 }
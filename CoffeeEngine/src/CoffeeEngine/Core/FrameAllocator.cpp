@@ -0,0 +1,146 @@
+#include "FrameAllocator.h"
+
+#include "CoffeeEngine/Core/Assert.h"
+#include "CoffeeEngine/Core/Log.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    struct FrameArena
+    {
+        std::unique_ptr<std::byte[]> Memory;
+        size_t Capacity = 0;
+        std::atomic<size_t> Offset = 0;
+
+        // Allocations that did not fit, freed when the arena is reset
+        std::mutex OverflowMutex;
+        std::vector<void*> Overflow;
+        size_t OverflowBytes = 0;
+    };
+
+    static constexpr size_t OverflowAlignment = 64; // Covers every alignment the arena is asked for
+
+    static std::array<FrameArena, FrameAllocator::ArenaCount> s_Arenas;
+    static std::atomic<size_t> s_CurrentArena = 0;
+    static bool s_Initialized = false;
+
+    static void ResetArena(FrameArena& arena)
+    {
+        if(!arena.Overflow.empty())
+        {
+            // Grow so the next frame of this size fits in the arena
+            size_t capacity = std::max(arena.Capacity * 2, arena.Capacity + arena.OverflowBytes);
+            COFFEE_CORE_WARN("FrameAllocator: Arena overflowed by {0} bytes, growing to {1} bytes", arena.OverflowBytes, capacity);
+
+            for(void* allocation : arena.Overflow)
+            {
+                ::operator delete(allocation, std::align_val_t(OverflowAlignment));
+            }
+            arena.Overflow.clear();
+            arena.OverflowBytes = 0;
+
+            arena.Memory = std::make_unique<std::byte[]>(capacity);
+            arena.Capacity = capacity;
+        }
+
+        arena.Offset = 0;
+    }
+
+    void FrameAllocator::Init(size_t arenaSize)
+    {
+        if(s_Initialized)
+            return;
+
+        for(FrameArena& arena : s_Arenas)
+        {
+            arena.Memory = std::make_unique<std::byte[]>(arenaSize);
+            arena.Capacity = arenaSize;
+            arena.Offset = 0;
+        }
+
+        s_CurrentArena = 0;
+        s_Initialized = true;
+    }
+
+    void FrameAllocator::Shutdown()
+    {
+        if(!s_Initialized)
+            return;
+
+        for(FrameArena& arena : s_Arenas)
+        {
+            for(void* allocation : arena.Overflow)
+            {
+                ::operator delete(allocation, std::align_val_t(OverflowAlignment));
+            }
+            arena.Overflow.clear();
+            arena.OverflowBytes = 0;
+
+            arena.Memory.reset();
+            arena.Capacity = 0;
+            arena.Offset = 0;
+        }
+
+        s_Initialized = false;
+    }
+
+    void FrameAllocator::NewFrame()
+    {
+        ZoneScoped;
+
+        TracyPlot("FrameAllocator Used", (int64_t)GetUsedBytes());
+
+        size_t next = (s_CurrentArena + 1) % ArenaCount;
+        ResetArena(s_Arenas[next]);
+        s_CurrentArena = next;
+    }
+
+    void* FrameAllocator::Allocate(size_t size, size_t alignment)
+    {
+        COFFEE_CORE_ASSERT(s_Initialized, "FrameAllocator::Allocate: The FrameAllocator is not initialized");
+        COFFEE_CORE_ASSERT(alignment <= OverflowAlignment, "FrameAllocator::Allocate: Alignment too large");
+
+        FrameArena& arena = s_Arenas[s_CurrentArena];
+        uintptr_t base = reinterpret_cast<uintptr_t>(arena.Memory.get());
+
+        size_t offset = arena.Offset.load(std::memory_order_relaxed);
+        size_t alignedOffset, newOffset;
+        do
+        {
+            alignedOffset = ((base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+            newOffset = alignedOffset + size;
+
+            if(newOffset > arena.Capacity)
+            {
+                std::lock_guard<std::mutex> lock(arena.OverflowMutex);
+
+                void* allocation = ::operator new(size, std::align_val_t(OverflowAlignment));
+                arena.Overflow.push_back(allocation);
+                arena.OverflowBytes += size;
+                return allocation;
+            }
+        }
+        while(!arena.Offset.compare_exchange_weak(offset, newOffset, std::memory_order_relaxed));
+
+        return arena.Memory.get() + alignedOffset;
+    }
+
+    size_t FrameAllocator::GetUsedBytes()
+    {
+        return s_Initialized ? s_Arenas[s_CurrentArena].Offset.load() : 0;
+    }
+
+    size_t FrameAllocator::GetCapacity()
+    {
+        return s_Initialized ? s_Arenas[s_CurrentArena].Capacity : 0;
+    }
+
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup core Core
+     * @{
+     */
+
+    /**
+     * @brief Bump allocator for data that only lives for a few frames.
+     *
+     * Allocations are carved out of the arena of the current frame and are never freed one by one;
+     * the whole arena is reset when it comes around again in NewFrame(). The arena of the previous
+     * frame is kept, so data handed over a frame boundary, like a render queue only released by the
+     * next BeginScene, stays valid during the current frame. Allocate() is lock free and can be
+     * called from any thread.
+     *
+     * When an arena runs out the allocation falls back to the heap and the arena grows the next
+     * time it is reset, so the steady state frame does not touch the heap.
+     */
+    class FrameAllocator
+    {
+    public:
+        static constexpr size_t DefaultArenaSize = 4 * 1024 * 1024; ///< Initial size of each arena.
+        static constexpr size_t ArenaCount = 2; ///< Number of arenas, the current frame and the previous one.
+
+        /**
+         * @brief Allocates the arenas.
+         * @param arenaSize Initial size of each arena in bytes.
+         */
+        static void Init(size_t arenaSize = DefaultArenaSize);
+
+        /**
+         * @brief Frees the arenas. Nothing allocated from them may be used afterwards.
+         */
+        static void Shutdown();
+
+        /**
+         * @brief Moves to the next arena and resets it. Called once at the start of every frame.
+         */
+        static void NewFrame();
+
+        /**
+         * @brief Allocates memory that stays valid until the end of the next frame.
+         * @param size Size in bytes.
+         * @param alignment Alignment in bytes, a power of two.
+         * @return The memory.
+         */
+        static void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        /**
+         * @brief Gets the bytes allocated from the arena of the current frame.
+         * @return The used bytes.
+         */
+        static size_t GetUsedBytes();
+
+        /**
+         * @brief Gets the size of the arena of the current frame.
+         * @return The size in bytes.
+         */
+        static size_t GetCapacity();
+    };
+
+    /**
+     * @brief STL allocator that allocates from the FrameAllocator. Deallocation does nothing.
+     * @tparam T The type of the elements.
+     */
+    template<typename T>
+    class FrameStlAllocator
+    {
+    public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        FrameStlAllocator() noexcept = default;
+
+        template<typename U>
+        FrameStlAllocator(const FrameStlAllocator<U>&) noexcept {}
+
+        T* allocate(size_t count)
+        {
+            return static_cast<T*>(FrameAllocator::Allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T*, size_t) noexcept {}
+
+        template<typename U>
+        bool operator==(const FrameStlAllocator<U>&) const noexcept { return true; }
+
+        template<typename U>
+        bool operator!=(const FrameStlAllocator<U>&) const noexcept { return false; }
+    };
+
+    template<typename T>
+    using FrameVector = std::vector<T, FrameStlAllocator<T>>; ///< Vector whose storage lives in the FrameAllocator.
+
+    using FrameString = std::basic_string<char, std::char_traits<char>, FrameStlAllocator<char>>; ///< String whose storage lives in the FrameAllocator.
+
+    /** @} */
+
+}
@@ -0,0 +1,376 @@
+#include "JobSystem.h"
+
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/Core/SystemInfo.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    struct Job
+    {
+        const char* Name = nullptr;
+        std::function<void()> Function;
+
+        std::atomic<uint32_t> PendingDependencies = 1; // Starts at 1 so the job is not queued while its dependencies are added
+        std::atomic<bool> Finished = false;
+
+        std::mutex ContinuationsMutex;
+        std::vector<JobHandle> Continuations; // Jobs that depend on this one
+    };
+
+    struct JobQueue
+    {
+        std::mutex Mutex;
+        std::deque<JobHandle> Jobs;
+    };
+
+    static std::vector<std::thread> s_Workers;
+    static std::vector<std::unique_ptr<JobQueue>> s_Queues; // One per worker, the last one is shared by the other threads
+    static std::atomic<bool> s_Running = false;
+    static std::atomic<uint32_t> s_QueuedJobs = 0;
+    static std::mutex s_WakeMutex;
+    static std::condition_variable s_WakeCondition;
+
+    static thread_local int32_t s_WorkerIndex = -1;
+
+    static void Enqueue(const JobHandle& job);
+
+    static void Execute(const JobHandle& job)
+    {
+        {
+            ZoneScopedN("Job");
+            ZoneName(job->Name, std::strlen(job->Name));
+
+            if (job->Function)
+                job->Function();
+            job->Function = nullptr;
+        }
+
+        std::vector<JobHandle> continuations;
+        {
+            std::lock_guard<std::mutex> lock(job->ContinuationsMutex);
+            job->Finished = true;
+            continuations.swap(job->Continuations);
+        }
+
+        for (const JobHandle& continuation : continuations)
+        {
+            if (--continuation->PendingDependencies == 0)
+                Enqueue(continuation);
+        }
+    }
+
+    static void Enqueue(const JobHandle& job)
+    {
+        if (!s_Running)
+        {
+            Execute(job);
+            return;
+        }
+
+        JobQueue& queue = s_WorkerIndex >= 0 ? *s_Queues[s_WorkerIndex] : *s_Queues.back();
+        {
+            std::lock_guard<std::mutex> lock(queue.Mutex);
+            queue.Jobs.push_back(job);
+            s_QueuedJobs++;
+        }
+
+        s_WakeCondition.notify_one();
+    }
+
+    // Pops from the back of the own queue, or steals from the front of the others
+    static JobHandle TryGetJob()
+    {
+        if (s_QueuedJobs == 0)
+            return nullptr;
+
+        size_t queueCount = s_Queues.size();
+        size_t ownIndex = s_WorkerIndex >= 0 ? (size_t)s_WorkerIndex : queueCount - 1;
+
+        {
+            JobQueue& queue = *s_Queues[ownIndex];
+            std::lock_guard<std::mutex> lock(queue.Mutex);
+            if (!queue.Jobs.empty())
+            {
+                JobHandle job = std::move(queue.Jobs.back());
+                queue.Jobs.pop_back();
+                s_QueuedJobs--;
+                return job;
+            }
+        }
+
+        for (size_t i = 1; i < queueCount; i++)
+        {
+            JobQueue& queue = *s_Queues[(ownIndex + i) % queueCount];
+            std::lock_guard<std::mutex> lock(queue.Mutex);
+            if (!queue.Jobs.empty())
+            {
+                JobHandle job = std::move(queue.Jobs.front());
+                queue.Jobs.pop_front();
+                s_QueuedJobs--;
+                return job;
+            }
+        }
+
+        return nullptr;
+    }
+
+    static void WorkerLoop(uint32_t index)
+    {
+        s_WorkerIndex = (int32_t)index;
+
+        std::string threadName = "Job Worker " + std::to_string(index);
+        tracy::SetThreadName(threadName.c_str());
+
+        while (true)
+        {
+            if (JobHandle job = TryGetJob())
+            {
+                Execute(job);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(s_WakeMutex);
+            if (!s_Running && s_QueuedJobs == 0)
+                break;
+
+            // The timeout covers a notification sent between TryGetJob and the wait
+            s_WakeCondition.wait_for(lock, std::chrono::milliseconds(1), [] { return s_QueuedJobs > 0 || !s_Running; });
+        }
+    }
+
+    void JobSystem::Init(uint32_t workerCount)
+    {
+        ZoneScoped;
+
+        if (s_Running)
+            return;
+
+        if (workerCount == 0)
+        {
+            uint32_t cores = std::max(SystemInfo::GetPhysicalProcessorCount(), 1u);
+            workerCount = std::max(cores - 1, 1u);
+        }
+
+        s_Queues.clear();
+        for (uint32_t i = 0; i < workerCount + 1; i++)
+        {
+            s_Queues.push_back(std::make_unique<JobQueue>());
+        }
+
+        s_Running = true;
+
+        for (uint32_t i = 0; i < workerCount; i++)
+        {
+            s_Workers.emplace_back(WorkerLoop, i);
+        }
+
+        COFFEE_CORE_INFO("JobSystem: Started {0} workers", workerCount);
+    }
+
+    void JobSystem::Shutdown()
+    {
+        if (!s_Running)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(s_WakeMutex);
+            s_Running = false;
+        }
+        s_WakeCondition.notify_all();
+
+        // The workers run what is still queued before leaving
+        for (std::thread& worker : s_Workers)
+        {
+            worker.join();
+        }
+
+        s_Workers.clear();
+        s_Queues.clear();
+    }
+
+    uint32_t JobSystem::GetWorkerCount()
+    {
+        return (uint32_t)s_Workers.size();
+    }
+
+    bool JobSystem::IsWorkerThread()
+    {
+        return s_WorkerIndex >= 0;
+    }
+
+    JobHandle JobSystem::CreateJob(const char* name, std::function<void()> function)
+    {
+        JobHandle job = CreateRef<Job>();
+        job->Name = name;
+        job->Function = std::move(function);
+        return job;
+    }
+
+    void JobSystem::AddDependency(const JobHandle& job, const JobHandle& dependency)
+    {
+        if (!dependency)
+            return;
+
+        std::lock_guard<std::mutex> lock(dependency->ContinuationsMutex);
+        if (dependency->Finished)
+            return;
+
+        job->PendingDependencies++;
+        dependency->Continuations.push_back(job);
+    }
+
+    void JobSystem::Release(const JobHandle& job)
+    {
+        if (--job->PendingDependencies == 0)
+            Enqueue(job);
+    }
+
+    JobHandle JobSystem::Schedule(const char* name, std::function<void()> function, std::initializer_list<JobHandle> dependencies)
+    {
+        JobHandle job = CreateJob(name, std::move(function));
+
+        for (const JobHandle& dependency : dependencies)
+        {
+            AddDependency(job, dependency);
+        }
+
+        Release(job);
+        return job;
+    }
+
+    JobHandle JobSystem::Schedule(const char* name, std::function<void()> function, const std::vector<JobHandle>& dependencies)
+    {
+        JobHandle job = CreateJob(name, std::move(function));
+
+        for (const JobHandle& dependency : dependencies)
+        {
+            AddDependency(job, dependency);
+        }
+
+        Release(job);
+        return job;
+    }
+
+    bool JobSystem::IsFinished(const JobHandle& job)
+    {
+        return !job || job->Finished;
+    }
+
+    void JobSystem::Wait(const JobHandle& job)
+    {
+        if (IsFinished(job))
+            return;
+
+        ZoneScoped;
+
+        while (!job->Finished)
+        {
+            if (JobHandle other = TryGetJob())
+                Execute(other);
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    void JobSystem::ParallelFor(const char* name, size_t count, size_t batchSize, const std::function<void(size_t begin, size_t end)>& function)
+    {
+        if (count == 0)
+            return;
+
+        batchSize = std::max<size_t>(batchSize, 1);
+        size_t batchCount = (count + batchSize - 1) / batchSize;
+
+        // The batches are handed out from a shared counter, so a few jobs are enough to keep every worker busy
+        std::atomic<size_t> nextBatch = 0;
+        auto runBatches = [&]() {
+            size_t batch;
+            while ((batch = nextBatch++) < batchCount)
+            {
+                size_t begin = batch * batchSize;
+                function(begin, std::min(begin + batchSize, count));
+            }
+        };
+
+        size_t helperCount = std::min<size_t>(GetWorkerCount(), batchCount - 1);
+
+        std::vector<JobHandle> helpers;
+        helpers.reserve(helperCount);
+        for (size_t i = 0; i < helperCount; i++)
+        {
+            helpers.push_back(Schedule(name, runBatches));
+        }
+
+        {
+            ZoneScopedN("Job");
+            ZoneName(name, std::strlen(name));
+            runBatches();
+        }
+
+        for (const JobHandle& helper : helpers)
+        {
+            Wait(helper);
+        }
+    }
+
+    JobGraph::TaskID JobGraph::AddTask(const char* name, std::function<void()> function)
+    {
+        m_Tasks.push_back({ name, std::move(function), {} });
+        return (TaskID)(m_Tasks.size() - 1);
+    }
+
+    void JobGraph::AddDependency(TaskID task, TaskID dependency)
+    {
+        COFFEE_CORE_ASSERT(task < m_Tasks.size() && dependency < m_Tasks.size() && task != dependency, "JobGraph::AddDependency: Invalid task");
+
+        m_Tasks[task].Dependencies.push_back(dependency);
+    }
+
+    JobHandle JobGraph::Run()
+    {
+        ZoneScoped;
+
+        // Every job is created before any is released, so the dependencies can be wired in any order
+        std::vector<JobHandle> jobs;
+        jobs.reserve(m_Tasks.size());
+        for (const Task& task : m_Tasks)
+        {
+            jobs.push_back(JobSystem::CreateJob(task.Name, task.Function));
+        }
+
+        JobHandle done = JobSystem::CreateJob("JobGraph", nullptr);
+
+        for (size_t i = 0; i < m_Tasks.size(); i++)
+        {
+            for (TaskID dependency : m_Tasks[i].Dependencies)
+            {
+                JobSystem::AddDependency(jobs[i], jobs[dependency]);
+            }
+            JobSystem::AddDependency(done, jobs[i]);
+        }
+
+        for (const JobHandle& job : jobs)
+        {
+            JobSystem::Release(job);
+        }
+        JobSystem::Release(done);
+
+        return done;
+    }
+
+    void JobGraph::RunAndWait()
+    {
+        JobSystem::Wait(Run());
+    }
+
+}
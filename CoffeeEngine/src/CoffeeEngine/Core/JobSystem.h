@@ -0,0 +1,163 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup core Core
+     * @{
+     */
+
+    struct Job;
+
+    /**
+     * @brief Reference to a scheduled job, used to wait for it or to make other jobs depend on it.
+     */
+    using JobHandle = Ref<Job>;
+
+    /**
+     * @brief Runs jobs on a pool of worker threads.
+     *
+     * Every worker owns a deque of jobs. A worker pushes and pops the jobs it schedules at the back
+     * of its own deque and, when it runs out of work, steals from the front of the other deques.
+     * Jobs scheduled from other threads go to a shared deque that the workers steal from.
+     *
+     * Dependent jobs are continuations: a job is queued only when all its dependencies have
+     * finished, so no worker ever blocks on a dependency. Threads that wait for a job keep running
+     * other jobs until it finishes.
+     *
+     * When the job system is not initialized, jobs run inline on the thread that schedules them.
+     */
+    class JobSystem
+    {
+    public:
+        /**
+         * @brief Starts the worker threads.
+         * @param workerCount Number of worker threads. 0 uses one per physical core, minus the main thread.
+         */
+        static void Init(uint32_t workerCount = 0);
+
+        /**
+         * @brief Runs the queued jobs and stops the worker threads.
+         */
+        static void Shutdown();
+
+        /**
+         * @brief Gets the number of worker threads.
+         * @return The number of worker threads, 0 if the job system is not initialized.
+         */
+        static uint32_t GetWorkerCount();
+
+        /**
+         * @brief Checks if the calling thread is one of the workers.
+         * @return True on a worker thread.
+         */
+        static bool IsWorkerThread();
+
+        /**
+         * @brief Schedules a job.
+         * @param name Name of the job, shown in the profiler. Must outlive the job.
+         * @param function The work to do.
+         * @param dependencies Jobs that have to finish before this one starts.
+         * @return The handle of the job.
+         */
+        static JobHandle Schedule(const char* name, std::function<void()> function, std::initializer_list<JobHandle> dependencies = {});
+
+        /**
+         * @brief Schedules a job.
+         * @param name Name of the job, shown in the profiler. Must outlive the job.
+         * @param function The work to do.
+         * @param dependencies Jobs that have to finish before this one starts.
+         * @return The handle of the job.
+         */
+        static JobHandle Schedule(const char* name, std::function<void()> function, const std::vector<JobHandle>& dependencies);
+
+        /**
+         * @brief Checks if a job has finished.
+         * @param job The job.
+         * @return True if the job has finished or the handle is empty.
+         */
+        static bool IsFinished(const JobHandle& job);
+
+        /**
+         * @brief Runs other jobs on the calling thread until a job has finished.
+         * @param job The job to wait for.
+         */
+        static void Wait(const JobHandle& job);
+
+        /**
+         * @brief Splits a range in batches and runs them on the workers and the calling thread.
+         *
+         * Returns once every batch has run.
+         * @param name Name of the jobs, shown in the profiler.
+         * @param count Number of elements in the range.
+         * @param batchSize Number of elements per batch.
+         * @param function Called with the first and one past the last element of each batch.
+         */
+        static void ParallelFor(const char* name, size_t count, size_t batchSize, const std::function<void(size_t begin, size_t end)>& function);
+
+    private:
+        friend class JobGraph;
+
+        static JobHandle CreateJob(const char* name, std::function<void()> function);
+        static void AddDependency(const JobHandle& job, const JobHandle& dependency);
+        static void Release(const JobHandle& job);
+    };
+
+    /**
+     * @brief A set of tasks with dependencies between them, scheduled on the JobSystem as a whole.
+     *
+     * The graph can be run again after it has finished, for work that repeats every frame.
+     */
+    class JobGraph
+    {
+    public:
+        using TaskID = uint32_t;
+
+        /**
+         * @brief Adds a task to the graph.
+         * @param name Name of the task, shown in the profiler. Must outlive the graph.
+         * @param function The work to do.
+         * @return The ID of the task.
+         */
+        TaskID AddTask(const char* name, std::function<void()> function);
+
+        /**
+         * @brief Makes a task wait for another one.
+         * @param task The task that waits.
+         * @param dependency The task that has to finish first.
+         */
+        void AddDependency(TaskID task, TaskID dependency);
+
+        /**
+         * @brief Schedules every task of the graph.
+         * @return A job that finishes when every task has finished.
+         */
+        JobHandle Run();
+
+        /**
+         * @brief Schedules every task of the graph and waits for them.
+         */
+        void RunAndWait();
+
+    private:
+        struct Task
+        {
+            const char* Name; ///< Name shown in the profiler.
+            std::function<void()> Function; ///< The work to do.
+            std::vector<TaskID> Dependencies; ///< Tasks that have to finish first.
+        };
+
+        std::vector<Task> m_Tasks; ///< The tasks, indexed by TaskID.
+    };
+
+    /** @} */
+
+}
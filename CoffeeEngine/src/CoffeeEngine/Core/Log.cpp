@@ -1,8 +1,14 @@
 #include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/Core/AsyncLogSink.h"
+#include "CoffeeEngine/Core/DataStructures/CircularBuffer.h"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <spdlog/details/null_mutex.h>
 #include <spdlog/logger.h>
+#include <spdlog/sinks/base_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 #include <string>
@@ -12,22 +18,133 @@ namespace Coffee
 {
     std::shared_ptr<spdlog::logger> Log::s_CoreLogger;
     std::shared_ptr<spdlog::logger> Log::s_ClientLogger;
-    std::vector<std::string> Log::s_LogBuffer;
 
-    void Log::Init()
+    static std::mutex s_LogBufferMutex; ///< Protects s_LogBuffer, the editor reads it while the sinks write it.
+    static CircularBuffer<std::string> s_LogBuffer(Log::DefaultLogBufferCapacity); ///< Last messages, shown by the editor.
+    static std::atomic<uint64_t> s_LogBufferVersion = 0; ///< Incremented every time s_LogBuffer changes.
+    static std::shared_ptr<AsyncLogSink> s_AsyncSink; ///< Set in async mode.
+
+    template <typename Mutex>
+    class LogBufferSink : public spdlog::sinks::base_sink<Mutex>
+    {
+    protected:
+        void sink_it_(const spdlog::details::log_msg& msg) override
+        {
+            spdlog::memory_buf_t formatted;
+            this->formatter_->format(msg, formatted);
+
+            std::lock_guard<std::mutex> lock(s_LogBufferMutex);
+            s_LogBuffer.push_back(fmt::to_string(formatted));
+            s_LogBufferVersion++;
+        }
+
+        void flush_() override {}
+    };
+
+    void Log::Init(LogMode mode)
     {
-        spdlog::set_pattern("%^[%T] %n: %v%$");
+        const std::string pattern = "%^[%T] %n: %v%$";
+        spdlog::set_pattern(pattern);
+
+        std::vector<spdlog::sink_ptr> sinks;
+
+        if (mode == LogMode::Async)
+        {
+            // Every write to the wrapped sinks is serialized by the AsyncLogSink, they do not need locks of their own
+            std::vector<spdlog::sink_ptr> asyncSinks = {
+                std::make_shared<spdlog::sinks::stdout_color_sink_st>(),
+                std::make_shared<LogBufferSink<spdlog::details::null_mutex>>()
+            };
+            for (const spdlog::sink_ptr& sink : asyncSinks)
+            {
+                sink->set_pattern(pattern);
+                sink->set_level(spdlog::level::trace);
+            }
+
+            s_AsyncSink = std::make_shared<AsyncLogSink>(std::move(asyncSinks));
+            sinks.push_back(s_AsyncSink);
+        }
+        else
+        {
+            sinks.push_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
+            sinks.push_back(std::make_shared<LogBufferSink<std::mutex>>());
 
-        auto imGuiSink = std::make_shared<LogSink<std::mutex>>();
-        imGuiSink->set_level(spdlog::level::trace);
+            for (const spdlog::sink_ptr& sink : sinks)
+            {
+                sink->set_pattern(pattern);
+                sink->set_level(spdlog::level::trace);
+            }
+        }
 
-        s_CoreLogger = spdlog::stdout_color_mt("CORE");
+        s_CoreLogger = std::make_shared<spdlog::logger>("CORE", sinks.begin(), sinks.end());
         s_CoreLogger->set_level(spdlog::level::trace);
-        s_CoreLogger.get()->sinks().push_back(imGuiSink);
+        spdlog::register_logger(s_CoreLogger);
 
-        s_ClientLogger = spdlog::stdout_color_mt("APP");
+        s_ClientLogger = std::make_shared<spdlog::logger>("APP", sinks.begin(), sinks.end());
         s_ClientLogger->set_level(spdlog::level::trace);
-        s_ClientLogger.get()->sinks().push_back(imGuiSink);
+        spdlog::register_logger(s_ClientLogger);
+    }
+
+    void Log::Shutdown()
+    {
+        if (s_AsyncSink)
+            s_AsyncSink->Stop();
+        else if (s_CoreLogger)
+            s_CoreLogger->flush();
+    }
+
+    void Log::Flush()
+    {
+        if (s_CoreLogger)
+            s_CoreLogger->flush();
+    }
+
+    void Log::CopyLogBuffer(std::vector<std::string>& messages)
+    {
+        std::lock_guard<std::mutex> lock(s_LogBufferMutex);
+        messages.clear();
+        messages.reserve(s_LogBuffer.size());
+        for (size_t i = 0; i < s_LogBuffer.size(); i++)
+        {
+            messages.push_back(s_LogBuffer[i]);
+        }
+    }
+
+    uint64_t Log::GetLogBufferVersion()
+    {
+        return s_LogBufferVersion;
+    }
+
+    void Log::ClearLogBuffer()
+    {
+        std::lock_guard<std::mutex> lock(s_LogBufferMutex);
+        s_LogBuffer.clear();
+        s_LogBufferVersion++;
+    }
+
+    void Log::SetLogBufferCapacity(size_t capacity)
+    {
+        capacity = std::max<size_t>(capacity, 1);
+
+        std::lock_guard<std::mutex> lock(s_LogBufferMutex);
+        if (capacity == s_LogBuffer.capacity())
+            return;
+
+        // Keep the newest messages that fit
+        CircularBuffer<std::string> buffer(capacity);
+        for (size_t i = 0; i < s_LogBuffer.size(); i++)
+        {
+            buffer.push_back(std::move(s_LogBuffer[i]));
+        }
+
+        s_LogBuffer = std::move(buffer);
+        s_LogBufferVersion++;
+    }
+
+    size_t Log::GetLogBufferCapacity()
+    {
+        std::lock_guard<std::mutex> lock(s_LogBufferMutex);
+        return s_LogBuffer.capacity();
     }
 
 } // namespace Coffee
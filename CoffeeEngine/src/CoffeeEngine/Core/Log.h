@@ -1,12 +1,24 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <spdlog/logger.h>
-#include <spdlog/sinks/base_sink.h>
-#include <mutex>
 #include <vector>
 #include <string>
 
+// Levels for COFFEE_LOG_LEVEL, the macros below it compile to nothing
+#define COFFEE_LOG_LEVEL_TRACE    0
+#define COFFEE_LOG_LEVEL_INFO     2
+#define COFFEE_LOG_LEVEL_WARN     3
+#define COFFEE_LOG_LEVEL_ERROR    4
+#define COFFEE_LOG_LEVEL_CRITICAL 5
+#define COFFEE_LOG_LEVEL_OFF      6
+
+#ifndef COFFEE_LOG_LEVEL
+    #define COFFEE_LOG_LEVEL COFFEE_LOG_LEVEL_TRACE
+#endif
+
 namespace Coffee
 {
     /**
@@ -15,16 +27,38 @@ namespace Coffee
      * @{
      */
 
+    /**
+     * @brief How the loggers write their messages.
+     */
+    enum class LogMode
+    {
+        Sync, ///< Messages are written to the sinks by the thread that logs them.
+        Async ///< Messages are queued in a per-thread ring and written by a background thread.
+    };
+
     /**
      * @brief The Log class is responsible for initializing and providing access to the core and client loggers.
      */
     class Log
     {
       public:
+        static constexpr size_t DefaultLogBufferCapacity = 1024; ///< Messages kept for the editor by default.
+
         /**
          * @brief Initializes the logging system.
+         * @param mode Whether the messages are written synchronously or by a background thread.
          */
-        static void Init();
+        static void Init(LogMode mode = LogMode::Async);
+
+        /**
+         * @brief Writes the pending messages and stops the background thread.
+         */
+        static void Shutdown();
+
+        /**
+         * @brief Blocks until every message logged so far has been written.
+         */
+        static void Flush();
 
         /**
          * @brief Gets the core logger.
@@ -38,46 +72,81 @@ namespace Coffee
          */
         inline static std::shared_ptr<spdlog::logger>& GetClientLogger() { return s_ClientLogger; }
 
-        static const std::vector<std::string>& GetLogBuffer() { return s_LogBuffer; }
-        static void ClearLogBuffer() { s_LogBuffer.clear(); }
+        /**
+         * @brief Copies the messages kept for the editor, oldest first.
+         * @param messages The vector the messages are copied to.
+         */
+        static void CopyLogBuffer(std::vector<std::string>& messages);
+
+        /**
+         * @brief Gets a counter that changes every time the log buffer changes.
+         * @return The version of the log buffer.
+         */
+        static uint64_t GetLogBufferVersion();
+
+        /**
+         * @brief Removes every message kept for the editor.
+         */
+        static void ClearLogBuffer();
+
+        /**
+         * @brief Sets how many messages are kept for the editor. The oldest ones are dropped first.
+         * @param capacity The maximum number of messages, at least 1.
+         */
+        static void SetLogBufferCapacity(size_t capacity);
+
+        /**
+         * @brief Gets how many messages are kept for the editor.
+         * @return The maximum number of messages.
+         */
+        static size_t GetLogBufferCapacity();
 
       private:
         static std::shared_ptr<spdlog::logger> s_CoreLogger; ///< The core logger.
         static std::shared_ptr<spdlog::logger> s_ClientLogger; ///< The client logger.
-        static std::vector<std::string> s_LogBuffer; ///< The log buffer.
-
-        template <typename Mutex>
-        class LogSink : public spdlog::sinks::base_sink<Mutex>
-        {
-        protected:
-            void sink_it_(const spdlog::details::log_msg& msg) override
-            {
-                if(s_LogBuffer.size() > 1024)
-                {
-                    s_LogBuffer.erase(s_LogBuffer.begin());
-                }
-
-                spdlog::memory_buf_t formatted;
-                this->formatter_->format(msg, formatted);
-                s_LogBuffer.push_back(fmt::to_string(formatted));
-            }
-
-            void flush_() override {}
-        };
     };
     /** @} */
 } // namespace Coffee
 
-// Core log macros
-#define COFFEE_CORE_TRACE(...)    ::Coffee::Log::GetCoreLogger()->trace(__VA_ARGS__)
-#define COFFEE_CORE_INFO(...)     ::Coffee::Log::GetCoreLogger()->info(__VA_ARGS__)
-#define COFFEE_CORE_WARN(...)     ::Coffee::Log::GetCoreLogger()->warn(__VA_ARGS__)
-#define COFFEE_CORE_ERROR(...)    ::Coffee::Log::GetCoreLogger()->error(__VA_ARGS__)
-#define COFFEE_CORE_CRITICAL(...) ::Coffee::Log::GetCoreLogger()->critical(__VA_ARGS__)
-
-// Client log macros
-#define COFFEE_TRACE(...)         ::Coffee::Log::GetClientLogger()->trace(__VA_ARGS__)
-#define COFFEE_INFO(...)          ::Coffee::Log::GetClientLogger()->info(__VA_ARGS__)
-#define COFFEE_WARN(...)          ::Coffee::Log::GetClientLogger()->warn(__VA_ARGS__)
-#define COFFEE_ERROR(...)         ::Coffee::Log::GetClientLogger()->error(__VA_ARGS__)
-#define COFFEE_CRITICAL(...)      ::Coffee::Log::GetClientLogger()->critical(__VA_ARGS__)
\ No newline at end of file
+#define COFFEE_LOG_DISABLED(...) ((void)0)
+
+// Log macros, the levels below COFFEE_LOG_LEVEL are stripped at compile time
+#if COFFEE_LOG_LEVEL <= COFFEE_LOG_LEVEL_TRACE
+    #define COFFEE_CORE_TRACE(...)    ::Coffee::Log::GetCoreLogger()->trace(__VA_ARGS__)
+    #define COFFEE_TRACE(...)         ::Coffee::Log::GetClientLogger()->trace(__VA_ARGS__)
+#else
+    #define COFFEE_CORE_TRACE(...)    COFFEE_LOG_DISABLED(__VA_ARGS__)
+    #define COFFEE_TRACE(...)         COFFEE_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if COFFEE_LOG_LEVEL <= COFFEE_LOG_LEVEL_INFO
+    #define COFFEE_CORE_INFO(...)     ::Coffee::Log::GetCoreLogger()->info(__VA_ARGS__)
+    #define COFFEE_INFO(...)          ::Coffee::Log::GetClientLogger()->info(__VA_ARGS__)
+#else
+    #define COFFEE_CORE_INFO(...)     COFFEE_LOG_DISABLED(__VA_ARGS__)
+    #define COFFEE_INFO(...)          COFFEE_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if COFFEE_LOG_LEVEL <= COFFEE_LOG_LEVEL_WARN
+    #define COFFEE_CORE_WARN(...)     ::Coffee::Log::GetCoreLogger()->warn(__VA_ARGS__)
+    #define COFFEE_WARN(...)          ::Coffee::Log::GetClientLogger()->warn(__VA_ARGS__)
+#else
+    #define COFFEE_CORE_WARN(...)     COFFEE_LOG_DISABLED(__VA_ARGS__)
+    #define COFFEE_WARN(...)          COFFEE_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if COFFEE_LOG_LEVEL <= COFFEE_LOG_LEVEL_ERROR
+    #define COFFEE_CORE_ERROR(...)    ::Coffee::Log::GetCoreLogger()->error(__VA_ARGS__)
+    #define COFFEE_ERROR(...)         ::Coffee::Log::GetClientLogger()->error(__VA_ARGS__)
+#else
+    #define COFFEE_CORE_ERROR(...)    COFFEE_LOG_DISABLED(__VA_ARGS__)
+    #define COFFEE_ERROR(...)         COFFEE_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if COFFEE_LOG_LEVEL <= COFFEE_LOG_LEVEL_CRITICAL
+    #define COFFEE_CORE_CRITICAL(...) ::Coffee::Log::GetCoreLogger()->critical(__VA_ARGS__)
+    #define COFFEE_CRITICAL(...)      ::Coffee::Log::GetClientLogger()->critical(__VA_ARGS__)
+#else
+    #define COFFEE_CORE_CRITICAL(...) COFFEE_LOG_DISABLED(__VA_ARGS__)
+    #define COFFEE_CRITICAL(...)      COFFEE_LOG_DISABLED(__VA_ARGS__)
+#endif
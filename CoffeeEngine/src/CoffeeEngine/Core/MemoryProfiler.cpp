@@ -0,0 +1,180 @@
+#include "MemoryProfiler.h"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <tracy/Tracy.hpp>
+
+#ifndef COFFEE_MEMORY_PROFILING
+    #define COFFEE_MEMORY_PROFILING 0
+#endif
+
+namespace Coffee {
+
+    struct TagCounters
+    {
+        std::atomic<int64_t> CpuBytes = 0;
+        std::atomic<int64_t> CpuAllocations = 0;
+        std::atomic<int64_t> GpuBytes[(size_t)GpuMemoryType::Count] = {};
+    };
+
+    // Constant initialized, operator new can run before any dynamic initializer
+    static std::array<TagCounters, (size_t)MemoryTag::Count> s_Counters;
+    static thread_local MemoryTag s_CurrentTag = MemoryTag::Untagged;
+
+    static constexpr const char* s_TagNames[] = { "Untagged", "Renderer", "Resources", "Scene", "Scripting", "ImGui" };
+    static constexpr const char* s_GpuPoolNames[] = { "GPU Textures", "GPU Buffers" };
+
+    static_assert(std::size(s_TagNames) == (size_t)MemoryTag::Count, "Every MemoryTag needs a name");
+    static_assert(std::size(s_GpuPoolNames) == (size_t)GpuMemoryType::Count, "Every GpuMemoryType needs a name");
+
+    bool MemoryProfiler::IsCpuTrackingEnabled()
+    {
+        return COFFEE_MEMORY_PROFILING;
+    }
+
+    MemoryTag MemoryProfiler::GetCurrentTag()
+    {
+        return s_CurrentTag;
+    }
+
+    void MemoryProfiler::SetCurrentTag(MemoryTag tag)
+    {
+        s_CurrentTag = tag;
+    }
+
+    const char* MemoryProfiler::GetTagName(MemoryTag tag)
+    {
+        return tag < MemoryTag::Count ? s_TagNames[(size_t)tag] : "Unknown";
+    }
+
+    const char* MemoryProfiler::GetGpuMemoryTypeName(GpuMemoryType type)
+    {
+        return type < GpuMemoryType::Count ? s_GpuPoolNames[(size_t)type] : "Unknown";
+    }
+
+    MemoryProfiler::TagStats MemoryProfiler::GetStats(MemoryTag tag)
+    {
+        const TagCounters& counters = s_Counters[(size_t)tag];
+
+        TagStats stats;
+        stats.CpuBytes = counters.CpuBytes.load(std::memory_order_relaxed);
+        stats.CpuAllocations = counters.CpuAllocations.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < (size_t)GpuMemoryType::Count; i++)
+        {
+            stats.GpuBytes[i] = counters.GpuBytes[i].load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    void MemoryProfiler::TrackExternal(MemoryTag tag, int64_t bytes)
+    {
+        s_Counters[(size_t)tag].CpuBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void MemoryProfiler::TrackGpuAllocation(MemoryTag tag, GpuMemoryType type, const void* owner, size_t bytes)
+    {
+        s_Counters[(size_t)tag].GpuBytes[(size_t)type].fetch_add((int64_t)bytes, std::memory_order_relaxed);
+        TracyAllocN(owner, bytes, s_GpuPoolNames[(size_t)type]);
+    }
+
+    void MemoryProfiler::TrackGpuFree(MemoryTag tag, GpuMemoryType type, const void* owner, size_t bytes)
+    {
+        s_Counters[(size_t)tag].GpuBytes[(size_t)type].fetch_sub((int64_t)bytes, std::memory_order_relaxed);
+        TracyFreeN(owner, s_GpuPoolNames[(size_t)type]);
+    }
+
+#if COFFEE_MEMORY_PROFILING
+
+    // Stored in front of every allocation, its size keeps the returned memory aligned like malloc
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) AllocationHeader
+    {
+        size_t Size;
+        MemoryTag Tag;
+    };
+
+    static void* TrackedAllocate(size_t size)
+    {
+        void* block = std::malloc(sizeof(AllocationHeader) + size);
+        if (!block)
+            return nullptr;
+
+        MemoryTag tag = s_CurrentTag;
+        AllocationHeader* header = static_cast<AllocationHeader*>(block);
+        header->Size = size;
+        header->Tag = tag;
+
+        TagCounters& counters = s_Counters[(size_t)tag];
+        counters.CpuBytes.fetch_add((int64_t)size, std::memory_order_relaxed);
+        counters.CpuAllocations.fetch_add(1, std::memory_order_relaxed);
+
+        void* ptr = header + 1;
+        TracyAllocN(ptr, size, s_TagNames[(size_t)tag]);
+        return ptr;
+    }
+
+    static void TrackedFree(void* ptr)
+    {
+        if (!ptr)
+            return;
+
+        AllocationHeader* header = static_cast<AllocationHeader*>(ptr) - 1;
+
+        TracyFreeN(ptr, s_TagNames[(size_t)header->Tag]);
+
+        TagCounters& counters = s_Counters[(size_t)header->Tag];
+        counters.CpuBytes.fetch_sub((int64_t)header->Size, std::memory_order_relaxed);
+        counters.CpuAllocations.fetch_sub(1, std::memory_order_relaxed);
+
+        std::free(header);
+    }
+
+#endif
+
+}
+
+#if COFFEE_MEMORY_PROFILING
+
+// The replacements live in this translation unit so they are linked in with the MemoryProfiler, which
+// the engine always references. The array and nothrow forms of the standard library forward to these,
+// the over-aligned forms keep their own allocator and are not tracked.
+
+void* operator new(std::size_t size)
+{
+    void* ptr = Coffee::TrackedAllocate(size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+    void* ptr = Coffee::TrackedAllocate(size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    Coffee::TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    Coffee::TrackedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    Coffee::TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    Coffee::TrackedFree(ptr);
+}
+
+#endif
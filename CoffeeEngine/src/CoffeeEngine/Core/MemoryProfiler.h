@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Coffee {
+
+    /**
+     * @defgroup core Core
+     * @{
+     */
+
+    /**
+     * @brief Subsystem an allocation is attributed to.
+     */
+    enum class MemoryTag : uint8_t
+    {
+        Untagged,
+        Renderer,
+        Resources,
+        Scene,
+        Scripting,
+        ImGui,
+        Count
+    };
+
+    /**
+     * @brief Kind of GPU memory.
+     */
+    enum class GpuMemoryType : uint8_t
+    {
+        Texture,
+        Buffer,
+        Count
+    };
+
+    /**
+     * @brief Tracks where the memory of the engine goes, by subsystem.
+     *
+     * Every thread has a current MemoryTag, set with COFFEE_MEMORY_TAG. When the engine is built
+     * with COFFEE_MEMORY_PROFILING the global operator new and delete are replaced, and each heap
+     * allocation is counted under the tag of the thread that made it and reported to a Tracy
+     * memory pool named after the tag. GPU memory of textures and buffers is always counted.
+     */
+    class MemoryProfiler
+    {
+    public:
+        /**
+         * @brief Live memory of a subsystem.
+         */
+        struct TagStats
+        {
+            int64_t CpuBytes = 0; ///< Heap bytes allocated and not freed yet.
+            int64_t CpuAllocations = 0; ///< Heap allocations not freed yet.
+            int64_t GpuBytes[(size_t)GpuMemoryType::Count] = {}; ///< GPU bytes by GpuMemoryType.
+        };
+
+        /**
+         * @brief Whether the heap allocations are tracked, that is, the engine was built with COFFEE_MEMORY_PROFILING.
+         * @return True if the heap allocations are tracked.
+         */
+        static bool IsCpuTrackingEnabled();
+
+        /**
+         * @brief Gets the tag of the calling thread.
+         * @return The current tag.
+         */
+        static MemoryTag GetCurrentTag();
+
+        /**
+         * @brief Sets the tag of the calling thread. Prefer COFFEE_MEMORY_TAG, which restores the previous tag.
+         * @param tag The new tag.
+         */
+        static void SetCurrentTag(MemoryTag tag);
+
+        /**
+         * @brief Gets the name of a tag, which is also the name of its Tracy memory pool.
+         * @param tag The tag.
+         * @return The name.
+         */
+        static const char* GetTagName(MemoryTag tag);
+
+        /**
+         * @brief Gets the name of a kind of GPU memory.
+         * @param type The kind of GPU memory.
+         * @return The name.
+         */
+        static const char* GetGpuMemoryTypeName(GpuMemoryType type);
+
+        /**
+         * @brief Gets the live memory of a subsystem.
+         * @param tag The tag of the subsystem.
+         * @return The stats of the tag.
+         */
+        static TagStats GetStats(MemoryTag tag);
+
+        /**
+         * @brief Counts memory allocated outside of operator new, such as by the Lua allocator.
+         * @param tag The tag the memory is attributed to.
+         * @param bytes Bytes allocated, negative when freed.
+         */
+        static void TrackExternal(MemoryTag tag, int64_t bytes);
+
+        /**
+         * @brief Counts a GPU allocation.
+         * @param tag The tag the memory is attributed to.
+         * @param type The kind of GPU memory.
+         * @param owner The object owning the memory, used to identify it in Tracy.
+         * @param bytes The size of the allocation.
+         */
+        static void TrackGpuAllocation(MemoryTag tag, GpuMemoryType type, const void* owner, size_t bytes);
+
+        /**
+         * @brief Counts a GPU deallocation.
+         * @param tag The tag the memory was attributed to.
+         * @param type The kind of GPU memory.
+         * @param owner The object owning the memory.
+         * @param bytes The size of the allocation.
+         */
+        static void TrackGpuFree(MemoryTag tag, GpuMemoryType type, const void* owner, size_t bytes);
+    };
+
+    /**
+     * @brief Sets the tag of the calling thread for its lifetime.
+     */
+    class MemoryTagScope
+    {
+    public:
+        MemoryTagScope(MemoryTag tag) : m_PreviousTag(MemoryProfiler::GetCurrentTag()) { MemoryProfiler::SetCurrentTag(tag); }
+        ~MemoryTagScope() { MemoryProfiler::SetCurrentTag(m_PreviousTag); }
+
+        MemoryTagScope(const MemoryTagScope&) = delete;
+        MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+
+    private:
+        MemoryTag m_PreviousTag;
+    };
+
+    /**
+     * @brief GPU memory owned by an object, released when the object is destroyed.
+     *
+     * The memory is attributed to the tag of the thread that tracks it.
+     */
+    class GpuMemoryAllocation
+    {
+    public:
+        GpuMemoryAllocation() = default;
+        ~GpuMemoryAllocation() { Release(); }
+
+        GpuMemoryAllocation(const GpuMemoryAllocation&) = delete;
+        GpuMemoryAllocation& operator=(const GpuMemoryAllocation&) = delete;
+
+        /**
+         * @brief Tracks the memory of the owner, replacing what was tracked before.
+         * @param type The kind of GPU memory.
+         * @param owner The object owning the memory.
+         * @param bytes The size of the memory.
+         */
+        void Track(GpuMemoryType type, const void* owner, size_t bytes)
+        {
+            Release();
+
+            m_Tag = MemoryProfiler::GetCurrentTag();
+            m_Type = type;
+            m_Owner = owner;
+            m_Bytes = bytes;
+            MemoryProfiler::TrackGpuAllocation(m_Tag, m_Type, m_Owner, m_Bytes);
+        }
+
+        /**
+         * @brief Stops tracking the memory.
+         */
+        void Release()
+        {
+            if (!m_Owner)
+                return;
+
+            MemoryProfiler::TrackGpuFree(m_Tag, m_Type, m_Owner, m_Bytes);
+            m_Owner = nullptr;
+            m_Bytes = 0;
+        }
+
+    private:
+        const void* m_Owner = nullptr;
+        size_t m_Bytes = 0;
+        MemoryTag m_Tag = MemoryTag::Untagged;
+        GpuMemoryType m_Type = GpuMemoryType::Texture;
+    };
+
+    /** @} */
+
+}
+
+#define COFFEE_MEMORY_TAG_CONCAT_IMPL(a, b) a##b
+#define COFFEE_MEMORY_TAG_CONCAT(a, b) COFFEE_MEMORY_TAG_CONCAT_IMPL(a, b)
+
+/**
+ * @brief Attributes the allocations made until the end of the scope to a subsystem.
+ * @param tag A MemoryTag value, for example Renderer.
+ */
+#define COFFEE_MEMORY_TAG(tag) ::Coffee::MemoryTagScope COFFEE_MEMORY_TAG_CONCAT(coffeeMemoryTag, __LINE__)(::Coffee::MemoryTag::tag)
@@ -0,0 +1,287 @@
+#include "Metrics.h"
+
+#include "CoffeeEngine/Core/Log.h"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    static std::mutex s_MetricsMutex;
+    static std::vector<std::unique_ptr<Metric>> s_Metrics;
+    static std::unordered_map<std::string, Metric*> s_MetricsByName;
+
+    static uint64_t s_FrameCount = 0;
+    static uint64_t s_HitchCount = 0;
+    static uint64_t s_LastHitchFrame = 0;
+    static float s_LastHitchTime = 0.0f;
+
+    static void CollectSamples(const Metric& metric, std::vector<float>& samples)
+    {
+        uint32_t count = metric.GetSampleCount();
+        samples.resize(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            samples[i] = metric.GetSample(i);
+        }
+    }
+
+    Metric::Metric(const std::string& name, MetricType type)
+        : m_Name(name), m_Type(type)
+    {
+    }
+
+    float Metric::GetLast() const
+    {
+        uint64_t total = m_SampleTotal.load(std::memory_order_acquire);
+        return total > 0 ? m_History[(total - 1) & (HistorySize - 1)].load(std::memory_order_relaxed) : 0.0f;
+    }
+
+    uint32_t Metric::GetSampleCount() const
+    {
+        return (uint32_t)std::min<uint64_t>(m_SampleTotal.load(std::memory_order_acquire), HistorySize);
+    }
+
+    float Metric::GetSample(uint32_t index) const
+    {
+        uint64_t total = m_SampleTotal.load(std::memory_order_acquire);
+        uint64_t count = std::min<uint64_t>(total, HistorySize);
+        return m_History[(total - count + index) & (HistorySize - 1)].load(std::memory_order_relaxed);
+    }
+
+    MetricSummary Metric::Summarize() const
+    {
+        std::vector<float> samples;
+        CollectSamples(*this, samples);
+
+        MetricSummary summary;
+        if (samples.empty())
+            return summary;
+
+        std::sort(samples.begin(), samples.end());
+
+        auto percentile = [&samples](float fraction) {
+            size_t index = (size_t)(fraction * (samples.size() - 1) + 0.5f);
+            return samples[std::min(index, samples.size() - 1)];
+        };
+
+        double sum = 0.0;
+        for (float sample : samples)
+            sum += sample;
+
+        summary.Min = samples.front();
+        summary.Max = samples.back();
+        summary.Mean = (float)(sum / samples.size());
+        summary.P50 = percentile(0.50f);
+        summary.P95 = percentile(0.95f);
+        summary.P99 = percentile(0.99f);
+        summary.SampleCount = (uint32_t)samples.size();
+        return summary;
+    }
+
+    void Metric::Sample()
+    {
+        double value = m_Type == MetricType::Counter ? m_Current.exchange(0.0, std::memory_order_relaxed)
+                                                     : m_Current.load(std::memory_order_relaxed);
+
+        uint64_t total = m_SampleTotal.load(std::memory_order_relaxed);
+        m_History[total & (HistorySize - 1)].store((float)value, std::memory_order_relaxed);
+        m_SampleTotal.store(total + 1, std::memory_order_release);
+    }
+
+    Metric& Metrics::GetOrCreate(const std::string& name, MetricType type)
+    {
+        std::lock_guard<std::mutex> lock(s_MetricsMutex);
+
+        auto it = s_MetricsByName.find(name);
+        if (it != s_MetricsByName.end())
+        {
+            COFFEE_CORE_ASSERT(it->second->GetType() == type, "Metrics: A metric with this name already exists with another type");
+            return *it->second;
+        }
+
+        s_Metrics.push_back(std::make_unique<Metric>(name, type));
+        Metric* metric = s_Metrics.back().get();
+        s_MetricsByName[name] = metric;
+        return *metric;
+    }
+
+    Metric& Metrics::Counter(const std::string& name)
+    {
+        return GetOrCreate(name, MetricType::Counter);
+    }
+
+    Metric& Metrics::Gauge(const std::string& name)
+    {
+        return GetOrCreate(name, MetricType::Gauge);
+    }
+
+    Metric* Metrics::Find(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(s_MetricsMutex);
+
+        auto it = s_MetricsByName.find(name);
+        return it != s_MetricsByName.end() ? it->second : nullptr;
+    }
+
+    std::vector<Metric*> Metrics::GetAll()
+    {
+        std::lock_guard<std::mutex> lock(s_MetricsMutex);
+
+        std::vector<Metric*> metrics;
+        metrics.reserve(s_Metrics.size());
+        for (const auto& metric : s_Metrics)
+        {
+            metrics.push_back(metric.get());
+        }
+        return metrics;
+    }
+
+    void Metrics::EndFrame(float frameTime)
+    {
+        ZoneScoped;
+
+        static Metric& frameTimeMetric = Gauge("Frame Time");
+        static std::vector<float> scratch;
+
+        // Compared against the median of the frames before this one
+        CollectSamples(frameTimeMetric, scratch);
+        if (scratch.size() >= 30)
+        {
+            auto middle = scratch.begin() + scratch.size() / 2;
+            std::nth_element(scratch.begin(), middle, scratch.end());
+
+            if (frameTime > *middle * HitchFactor)
+            {
+                s_HitchCount++;
+                s_LastHitchFrame = s_FrameCount;
+                s_LastHitchTime = frameTime;
+            }
+        }
+
+        frameTimeMetric.Set(frameTime);
+
+        {
+            std::lock_guard<std::mutex> lock(s_MetricsMutex);
+
+            for (const auto& metric : s_Metrics)
+            {
+                metric->Sample();
+            }
+        }
+
+        s_FrameCount++;
+    }
+
+    FrameTimeStats Metrics::GetFrameTimeStats()
+    {
+        FrameTimeStats stats;
+
+        if (Metric* frameTime = Find("Frame Time"))
+            stats.FrameTime = frameTime->Summarize();
+
+        stats.HitchCount = s_HitchCount;
+        stats.LastHitchFrame = s_LastHitchFrame;
+        stats.LastHitchTime = s_LastHitchTime;
+        return stats;
+    }
+
+    bool Metrics::ExportCSV(const std::filesystem::path& path)
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            COFFEE_CORE_ERROR("Metrics: Could not open {0} for writing", path.string());
+            return false;
+        }
+
+        std::vector<Metric*> metrics = GetAll();
+
+        uint32_t rows = 0;
+        file << "Frame";
+        for (Metric* metric : metrics)
+        {
+            file << ',' << metric->GetName();
+            rows = std::max(rows, metric->GetSampleCount());
+        }
+        file << '\n';
+
+        // The newest samples of every metric belong to the same frame, younger metrics are padded at the start
+        uint64_t firstFrame = s_FrameCount - rows;
+        for (uint32_t row = 0; row < rows; row++)
+        {
+            file << firstFrame + row;
+            for (Metric* metric : metrics)
+            {
+                file << ',';
+
+                uint32_t count = metric->GetSampleCount();
+                if (row >= rows - count)
+                    file << metric->GetSample(row - (rows - count));
+            }
+            file << '\n';
+        }
+
+        COFFEE_CORE_INFO("Metrics: Exported {0} frames to {1}", rows, path.string());
+        return true;
+    }
+
+    bool Metrics::ExportJSON(const std::filesystem::path& path)
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            COFFEE_CORE_ERROR("Metrics: Could not open {0} for writing", path.string());
+            return false;
+        }
+
+        auto writeString = [&file](const std::string& value) {
+            file << '"';
+            for (char c : value)
+            {
+                if (c == '"' || c == '\\')
+                    file << '\\';
+                file << c;
+            }
+            file << '"';
+        };
+
+        FrameTimeStats frameStats = GetFrameTimeStats();
+
+        file << "{\n";
+        file << "  \"frames\": " << s_FrameCount << ",\n";
+        file << "  \"frameTime\": { \"p50\": " << frameStats.FrameTime.P50 << ", \"p95\": " << frameStats.FrameTime.P95
+             << ", \"p99\": " << frameStats.FrameTime.P99 << ", \"max\": " << frameStats.FrameTime.Max
+             << ", \"hitches\": " << frameStats.HitchCount << " },\n";
+        file << "  \"metrics\": [\n";
+
+        std::vector<Metric*> metrics = GetAll();
+        for (size_t i = 0; i < metrics.size(); i++)
+        {
+            const Metric& metric = *metrics[i];
+            MetricSummary summary = metric.Summarize();
+
+            file << "    { \"name\": ";
+            writeString(metric.GetName());
+            file << ", \"type\": \"" << (metric.GetType() == MetricType::Counter ? "counter" : "gauge") << "\"";
+            file << ", \"min\": " << summary.Min << ", \"max\": " << summary.Max << ", \"mean\": " << summary.Mean;
+            file << ", \"p50\": " << summary.P50 << ", \"p95\": " << summary.P95 << ", \"p99\": " << summary.P99;
+            file << ", \"samples\": [";
+            for (uint32_t sample = 0; sample < summary.SampleCount; sample++)
+            {
+                file << (sample > 0 ? ", " : "") << metric.GetSample(sample);
+            }
+            file << "] }" << (i + 1 < metrics.size() ? "," : "") << '\n';
+        }
+
+        file << "  ]\n}\n";
+
+        COFFEE_CORE_INFO("Metrics: Exported {0} metrics to {1}", metrics.size(), path.string());
+        return true;
+    }
+
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup core Core
+     * @{
+     */
+
+    /**
+     * @brief How the value of a metric is produced.
+     */
+    enum class MetricType
+    {
+        Counter, ///< Accumulated with Add() during the frame, reset every frame.
+        Gauge ///< Set to the latest value with Set(), kept until it is set again.
+    };
+
+    /**
+     * @brief Summary of the samples in the history of a metric.
+     */
+    struct MetricSummary
+    {
+        float Min = 0.0f; ///< Smallest sample.
+        float Max = 0.0f; ///< Largest sample.
+        float Mean = 0.0f; ///< Average of the samples.
+        float P50 = 0.0f; ///< Median.
+        float P95 = 0.0f; ///< 95th percentile.
+        float P99 = 0.0f; ///< 99th percentile.
+        uint32_t SampleCount = 0; ///< Number of samples summarized.
+    };
+
+    /**
+     * @brief A named value sampled once per frame into a ring of HistorySize samples.
+     *
+     * Add() and Set() can be called from any thread. The history is only written by Metrics::EndFrame()
+     * on the main thread and can be read from any thread without locking; a reader racing the writer
+     * may see one sample of the next frame.
+     */
+    class Metric
+    {
+    public:
+        static constexpr uint32_t HistorySize = 1024; ///< Samples kept, a power of two.
+
+        Metric(const std::string& name, MetricType type);
+
+        /**
+         * @brief Adds to the value of the current frame.
+         * @param value The amount to add.
+         */
+        void Add(double value = 1.0) { m_Current.fetch_add(value, std::memory_order_relaxed); }
+
+        /**
+         * @brief Sets the current value.
+         * @param value The value.
+         */
+        void Set(double value) { m_Current.store(value, std::memory_order_relaxed); }
+
+        /**
+         * @brief Gets the current value, not sampled yet.
+         * @return The value.
+         */
+        double GetCurrent() const { return m_Current.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Gets the last sampled value.
+         * @return The value, 0 if there are no samples.
+         */
+        float GetLast() const;
+
+        /**
+         * @brief Gets the number of samples in the history.
+         * @return The number of samples, at most HistorySize.
+         */
+        uint32_t GetSampleCount() const;
+
+        /**
+         * @brief Gets a sample of the history.
+         * @param index The index of the sample, 0 is the oldest.
+         * @return The sample.
+         */
+        float GetSample(uint32_t index) const;
+
+        /**
+         * @brief Computes the percentiles of the history.
+         * @return The summary.
+         */
+        MetricSummary Summarize() const;
+
+        const std::string& GetName() const { return m_Name; }
+        MetricType GetType() const { return m_Type; }
+
+    private:
+        friend class Metrics;
+
+        void Sample();
+
+    private:
+        std::string m_Name; ///< Name of the metric.
+        MetricType m_Type; ///< Type of the metric.
+        std::atomic<double> m_Current = 0.0; ///< Value of the current frame.
+        std::array<std::atomic<float>, HistorySize> m_History = {}; ///< Ring of samples.
+        std::atomic<uint64_t> m_SampleTotal = 0; ///< Samples ever taken, the next one goes to m_SampleTotal % HistorySize.
+    };
+
+    /**
+     * @brief Frame time percentiles and hitches over the history of the "Frame Time" metric.
+     */
+    struct FrameTimeStats
+    {
+        MetricSummary FrameTime; ///< Summary of the frame time in milliseconds.
+        uint64_t HitchCount = 0; ///< Frames since startup that took more than HitchFactor times the median.
+        uint64_t LastHitchFrame = 0; ///< Frame number of the last hitch.
+        float LastHitchTime = 0.0f; ///< Duration of the last hitch in milliseconds.
+    };
+
+    /**
+     * @brief Registry of the performance metrics of the engine.
+     *
+     * Metrics are created on first use and live until the end of the program, so the references
+     * returned can be cached. Every frame EndFrame() samples all of them into their histories.
+     */
+    class Metrics
+    {
+    public:
+        static constexpr float HitchFactor = 2.0f; ///< A frame slower than the median by this factor is a hitch.
+
+        /**
+         * @brief Gets a counter, creating it if it does not exist.
+         * @param name The name of the counter.
+         * @return The counter.
+         */
+        static Metric& Counter(const std::string& name);
+
+        /**
+         * @brief Gets a gauge, creating it if it does not exist.
+         * @param name The name of the gauge.
+         * @return The gauge.
+         */
+        static Metric& Gauge(const std::string& name);
+
+        /**
+         * @brief Finds a metric.
+         * @param name The name of the metric.
+         * @return The metric, nullptr if it does not exist.
+         */
+        static Metric* Find(const std::string& name);
+
+        /**
+         * @brief Gets every metric, in creation order.
+         * @return The metrics.
+         */
+        static std::vector<Metric*> GetAll();
+
+        /**
+         * @brief Records the frame time, samples every metric and resets the counters. Main thread only.
+         * @param frameTime The duration of the frame in milliseconds.
+         */
+        static void EndFrame(float frameTime);
+
+        /**
+         * @brief Gets the frame time percentiles and hitches.
+         * @return The stats.
+         */
+        static FrameTimeStats GetFrameTimeStats();
+
+        /**
+         * @brief Writes the history of every metric as CSV, one row per frame and one column per metric.
+         * @param path The file to write.
+         * @return True if the file was written.
+         */
+        static bool ExportCSV(const std::filesystem::path& path);
+
+        /**
+         * @brief Writes the history and summary of every metric as JSON.
+         * @param path The file to write.
+         * @return True if the file was written.
+         */
+        static bool ExportJSON(const std::filesystem::path& path);
+
+    private:
+        static Metric& GetOrCreate(const std::string& name, MetricType type);
+    };
+
+    /** @} */
+}
@@ -29,11 +29,20 @@ struct VertexData
 
 layout (location = 2) out VertexData Output;
 
+#ifdef INSTANCED
+layout (location = 5) in mat4 aInstanceModel;
+#else
 uniform mat4 model;
 uniform mat3 normalMatrix;
+#endif
 
 void main()
 {
+#ifdef INSTANCED
+    mat4 model = aInstanceModel;
+    mat3 normalMatrix = transpose(inverse(mat3(model)));
+#endif
+
     Output.WorldPos = vec3(model * vec4(aPosition, 1.0));
     Output.Normal = normalMatrix * aNormals;
     Output.camPos = cameraPos;
@@ -57,6 +66,9 @@ void main()
 #[fragment]
 
 #version 450 core
+#ifdef BINDLESS
+#extension GL_ARB_bindless_texture : require
+#endif
 layout(location = 0) out vec4 FragColor;
 layout(location = 1) out vec4 EntityID;
 
@@ -78,29 +90,47 @@ layout (location = 2) in VertexData VertexInput;
 */
 struct Material
 {
-    sampler2D albedoMap;
-    sampler2D normalMap;
-    sampler2D metallicMap;
-    sampler2D roughnessMap;
-    sampler2D aoMap;
-    sampler2D emissiveMap;
-
     vec4 color;
     float metallic;
     float roughness;
     float ao;
     vec3 emissive;
-
-    int hasAlbedo;
-    int hasNormal;
-    int hasMetallic;
-    int hasRoughness;
-    int hasAO;
-    int hasEmissive;
 };
 
 uniform Material material;
 
+// Texture maps are only declared in the permutations that use them (see ShaderVariantCache).
+// BINDLESS samples GL_ARB_bindless_texture handles, TEXTURE_ARRAYS samples a layer of a shared texture array.
+#if defined(BINDLESS)
+#define MATERIAL_SAMPLER(unit, name, layer) layout(bindless_sampler) uniform sampler2D name
+#define SAMPLE_MATERIAL(name, layer, uv) texture(name, uv)
+#elif defined(TEXTURE_ARRAYS)
+#define MATERIAL_SAMPLER(unit, name, layer) layout(binding = unit) uniform sampler2DArray name; uniform int layer
+#define SAMPLE_MATERIAL(name, layer, uv) texture(name, vec3(uv, layer))
+#else
+#define MATERIAL_SAMPLER(unit, name, layer) layout(binding = unit) uniform sampler2D name
+#define SAMPLE_MATERIAL(name, layer, uv) texture(name, uv)
+#endif
+
+#ifdef HAS_ALBEDO_MAP
+MATERIAL_SAMPLER(0, albedoMap, albedoMapLayer);
+#endif
+#ifdef HAS_NORMAL_MAP
+MATERIAL_SAMPLER(1, normalMap, normalMapLayer);
+#endif
+#ifdef HAS_METALLIC_MAP
+MATERIAL_SAMPLER(2, metallicMap, metallicMapLayer);
+#endif
+#ifdef HAS_ROUGHNESS_MAP
+MATERIAL_SAMPLER(3, roughnessMap, roughnessMapLayer);
+#endif
+#ifdef HAS_AO_MAP
+MATERIAL_SAMPLER(4, aoMap, aoMapLayer);
+#endif
+#ifdef HAS_EMISSIVE_MAP
+MATERIAL_SAMPLER(5, emissiveMap, emissiveMapLayer);
+#endif
+
 #define MAX_LIGHTS 32
 
 struct Light
@@ -169,21 +199,48 @@ float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness)
 }
 
 
+#ifdef DEPTH_ONLY
 void main()
 {
-    vec3 albedo = material.hasAlbedo * (texture(material.albedoMap, VertexInput.TexCoords).rgb * material.color.rgb) + (1 - material.hasAlbedo) * material.color.rgb;
-
-    // Revise this type of conditional assignment (the commented one) because i think can lead to some undefined behavior in the shader!!!!!
-    vec3 normal/*  = material.hasNormal * (VertexInput.TBN * (texture(material.normalMap, VertexInput.TexCoords).rgb * 2.0 - 1.0)) + (1 - material.hasNormal) * VertexInput.Normal */;
-    if (material.hasNormal == 1) {
-        normal = VertexInput.TBN * (texture(material.normalMap, VertexInput.TexCoords).rgb * 2.0 - 1.0);
-    } else {
-        normal = VertexInput.Normal;
-    }
-    float metallic = material.hasMetallic * (texture(material.metallicMap, VertexInput.TexCoords).b * material.metallic) + (1 - material.hasMetallic) * material.metallic;
-    float roughness = material.hasRoughness * (texture(material.roughnessMap, VertexInput.TexCoords).g * material.roughness) + (1 - material.hasRoughness) * material.roughness;
-    float ao = material.hasAO * (texture(material.aoMap, VertexInput.TexCoords).r * material.ao) + (1 - material.hasAO) * material.ao;
-    vec3 emissive = material.hasEmissive * (texture(material.emissiveMap, VertexInput.TexCoords).rgb * material.emissive) + (1 - material.hasEmissive) * material.emissive;
+}
+#else
+void main()
+{
+#ifdef HAS_ALBEDO_MAP
+    vec3 albedo = SAMPLE_MATERIAL(albedoMap, albedoMapLayer, VertexInput.TexCoords).rgb * material.color.rgb;
+#else
+    vec3 albedo = material.color.rgb;
+#endif
+
+#ifdef HAS_NORMAL_MAP
+    vec3 normal = VertexInput.TBN * (SAMPLE_MATERIAL(normalMap, normalMapLayer, VertexInput.TexCoords).rgb * 2.0 - 1.0);
+#else
+    vec3 normal = VertexInput.Normal;
+#endif
+
+#ifdef HAS_METALLIC_MAP
+    float metallic = SAMPLE_MATERIAL(metallicMap, metallicMapLayer, VertexInput.TexCoords).b * material.metallic;
+#else
+    float metallic = material.metallic;
+#endif
+
+#ifdef HAS_ROUGHNESS_MAP
+    float roughness = SAMPLE_MATERIAL(roughnessMap, roughnessMapLayer, VertexInput.TexCoords).g * material.roughness;
+#else
+    float roughness = material.roughness;
+#endif
+
+#ifdef HAS_AO_MAP
+    float ao = SAMPLE_MATERIAL(aoMap, aoMapLayer, VertexInput.TexCoords).r * material.ao;
+#else
+    float ao = material.ao;
+#endif
+
+#ifdef HAS_EMISSIVE_MAP
+    vec3 emissive = SAMPLE_MATERIAL(emissiveMap, emissiveMapLayer, VertexInput.TexCoords).rgb * material.emissive;
+#else
+    vec3 emissive = material.emissive;
+#endif
 
     vec3 N = normalize(normal);
     vec3 V = normalize(VertexInput.camPos - VertexInput.WorldPos);
@@ -251,4 +308,5 @@ void main()
         return;
     }
 }
+#endif
 )"";
\ No newline at end of file
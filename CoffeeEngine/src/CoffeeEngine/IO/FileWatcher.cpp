@@ -0,0 +1,251 @@
+#include "FileWatcher.h"
+#include "CoffeeEngine/Core/Log.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <tracy/Tracy.hpp>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace Coffee {
+
+    struct WatchEntry
+    {
+        std::filesystem::path path; ///< The absolute and normalized path of the watched file.
+        FileWatcher::Callback callback; ///< The function called when the file changes.
+        std::filesystem::file_time_type lastWriteTime; ///< Used by the polling fallback.
+    };
+
+    struct FileWatcherData
+    {
+        std::mutex mutex;
+        std::unordered_map<FileWatcher::WatchID, WatchEntry> watches;
+        std::unordered_set<std::string> pendingChanges; ///< Paths that changed since the last Update().
+        FileWatcher::WatchID nextID = 1;
+
+        std::thread thread;
+        std::atomic<bool> running = false;
+
+#ifdef __linux__
+        int inotifyFD = -1;
+        std::unordered_map<int, std::filesystem::path> directories; ///< inotify watch descriptor -> directory.
+#endif
+    };
+
+    static FileWatcherData s_FileWatcherData;
+
+    static std::filesystem::path NormalizePath(const std::filesystem::path& path)
+    {
+        std::error_code ec;
+        std::filesystem::path absolutePath = std::filesystem::absolute(path, ec);
+        return (ec ? path : absolutePath).lexically_normal();
+    }
+
+    static void QueueChange(const std::filesystem::path& path)
+    {
+        for (const auto& [id, entry] : s_FileWatcherData.watches)
+        {
+            if (entry.path == path)
+            {
+                s_FileWatcherData.pendingChanges.insert(path.string());
+                return;
+            }
+        }
+    }
+
+#ifdef __linux__
+
+    // Editors usually save by writing a temporary file and renaming it, so the directory is
+    // watched instead of the file itself to keep receiving events after the file is replaced.
+    static void AddDirectoryWatch(const std::filesystem::path& directory)
+    {
+        if (s_FileWatcherData.inotifyFD < 0)
+            return;
+
+        int wd = inotify_add_watch(s_FileWatcherData.inotifyFD, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (wd < 0)
+        {
+            COFFEE_CORE_ERROR("FileWatcher: Failed to watch directory {0}", directory.string());
+            return;
+        }
+
+        s_FileWatcherData.directories[wd] = directory;
+    }
+
+    static void WatchThread()
+    {
+        alignas(inotify_event) char buffer[4096];
+
+        pollfd pfd = { s_FileWatcherData.inotifyFD, POLLIN, 0 };
+
+        while (s_FileWatcherData.running)
+        {
+            // Wake up periodically to check if the watcher has been stopped
+            if (poll(&pfd, 1, 100) <= 0)
+                continue;
+
+            ssize_t length = read(s_FileWatcherData.inotifyFD, buffer, sizeof(buffer));
+            if (length <= 0)
+                continue;
+
+            std::lock_guard<std::mutex> lock(s_FileWatcherData.mutex);
+
+            for (char* ptr = buffer; ptr < buffer + length;)
+            {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                if (event->len == 0)
+                    continue;
+
+                auto it = s_FileWatcherData.directories.find(event->wd);
+                if (it == s_FileWatcherData.directories.end())
+                    continue;
+
+                QueueChange(it->second / event->name);
+            }
+        }
+    }
+
+#else
+
+    static void WatchThread()
+    {
+        while (s_FileWatcherData.running)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+            std::lock_guard<std::mutex> lock(s_FileWatcherData.mutex);
+
+            for (auto& [id, entry] : s_FileWatcherData.watches)
+            {
+                std::error_code ec;
+                auto writeTime = std::filesystem::last_write_time(entry.path, ec);
+
+                if (!ec && writeTime != entry.lastWriteTime)
+                {
+                    entry.lastWriteTime = writeTime;
+                    s_FileWatcherData.pendingChanges.insert(entry.path.string());
+                }
+            }
+        }
+    }
+
+#endif
+
+    void FileWatcher::Init()
+    {
+        ZoneScoped;
+
+        if (s_FileWatcherData.running)
+            return;
+
+#ifdef __linux__
+        s_FileWatcherData.inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (s_FileWatcherData.inotifyFD < 0)
+        {
+            COFFEE_CORE_ERROR("FileWatcher: Failed to initialize inotify!");
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(s_FileWatcherData.mutex);
+        for (const auto& [id, entry] : s_FileWatcherData.watches)
+        {
+            AddDirectoryWatch(entry.path.parent_path());
+        }
+#endif
+
+        s_FileWatcherData.running = true;
+        s_FileWatcherData.thread = std::thread(WatchThread);
+    }
+
+    void FileWatcher::Shutdown()
+    {
+        ZoneScoped;
+
+        s_FileWatcherData.running = false;
+
+        if (s_FileWatcherData.thread.joinable())
+            s_FileWatcherData.thread.join();
+
+#ifdef __linux__
+        if (s_FileWatcherData.inotifyFD >= 0)
+        {
+            close(s_FileWatcherData.inotifyFD);
+            s_FileWatcherData.inotifyFD = -1;
+        }
+        s_FileWatcherData.directories.clear();
+#endif
+
+        s_FileWatcherData.watches.clear();
+        s_FileWatcherData.pendingChanges.clear();
+    }
+
+    FileWatcher::WatchID FileWatcher::Watch(const std::filesystem::path& path, const Callback& callback)
+    {
+        ZoneScoped;
+
+        WatchEntry entry;
+        entry.path = NormalizePath(path);
+        entry.callback = callback;
+
+        std::error_code ec;
+        entry.lastWriteTime = std::filesystem::last_write_time(entry.path, ec);
+
+        std::lock_guard<std::mutex> lock(s_FileWatcherData.mutex);
+
+#ifdef __linux__
+        AddDirectoryWatch(entry.path.parent_path());
+#endif
+
+        WatchID id = s_FileWatcherData.nextID++;
+        s_FileWatcherData.watches[id] = std::move(entry);
+        return id;
+    }
+
+    void FileWatcher::Unwatch(WatchID id)
+    {
+        std::lock_guard<std::mutex> lock(s_FileWatcherData.mutex);
+        s_FileWatcherData.watches.erase(id);
+    }
+
+    void FileWatcher::Update()
+    {
+        ZoneScoped;
+
+        std::vector<std::pair<std::filesystem::path, Callback>> callbacks;
+
+        {
+            std::lock_guard<std::mutex> lock(s_FileWatcherData.mutex);
+
+            if (s_FileWatcherData.pendingChanges.empty())
+                return;
+
+            for (const auto& [id, entry] : s_FileWatcherData.watches)
+            {
+                if (s_FileWatcherData.pendingChanges.count(entry.path.string()))
+                    callbacks.emplace_back(entry.path, entry.callback);
+            }
+
+            s_FileWatcherData.pendingChanges.clear();
+        }
+
+        // The callbacks are called without the lock held so they can add or remove watches
+        for (const auto& [path, callback] : callbacks)
+        {
+            COFFEE_CORE_INFO("FileWatcher: {0} changed", path.string());
+            callback(path);
+        }
+    }
+
+}
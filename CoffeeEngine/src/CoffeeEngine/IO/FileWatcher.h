@@ -0,0 +1,61 @@
+/**
+ * @defgroup io IO
+ * @brief IO components of the CoffeeEngine.
+ * @{
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+
+namespace Coffee {
+
+    /**
+     * @class FileWatcher
+     * @brief Watches files on disk and notifies when they change so resources can be hot-reloaded.
+     *
+     * Changes are detected on a background thread (inotify on Linux, timestamp polling elsewhere)
+     * and queued. The callbacks are dispatched from Update() on the calling thread, so they can
+     * safely touch GPU resources when Update() is called from the render thread.
+     */
+    class FileWatcher
+    {
+    public:
+        using WatchID = uint32_t;
+        using Callback = std::function<void(const std::filesystem::path&)>;
+
+        /**
+         * @brief Starts the background watcher thread.
+         */
+        static void Init();
+
+        /**
+         * @brief Stops the background watcher thread and removes all the watches.
+         */
+        static void Shutdown();
+
+        /**
+         * @brief Watches a file for changes.
+         * @param path The path of the file to watch.
+         * @param callback The function called from Update() when the file changes.
+         * @return The ID of the watch, used to remove it.
+         */
+        static WatchID Watch(const std::filesystem::path& path, const Callback& callback);
+
+        /**
+         * @brief Stops watching a file.
+         * @param id The ID returned by Watch().
+         */
+        static void Unwatch(WatchID id);
+
+        /**
+         * @brief Dispatches the callbacks of the files that changed since the last call.
+         */
+        static void Update();
+    };
+
+}
+
+/** @} */
@@ -221,7 +221,7 @@ namespace Coffee {
 
     Ref<Resource> ResourceImporter::LoadFromCache(const std::filesystem::path& path, ResourceFormat format)
         {
-            COFFEE_INFO("Loading resource from cache: {0}", path.string());
+            COFFEE_CORE_TRACE("Loading resource from cache: {0}", path.string());
             switch (format)
             {
                 case ResourceFormat::Binary:
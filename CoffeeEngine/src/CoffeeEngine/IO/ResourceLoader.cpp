@@ -1,7 +1,9 @@
 #include "ResourceLoader.h"
 #include "CoffeeEngine/Core/Base.h"
 #include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/Core/MemoryProfiler.h"
 #include "CoffeeEngine/IO/CacheManager.h"
+#include "CoffeeEngine/IO/FileWatcher.h"
 #include "CoffeeEngine/IO/Resource.h"
 #include "CoffeeEngine/Renderer/Material.h"
 #include "CoffeeEngine/Renderer/Model.h"
@@ -13,14 +15,29 @@
 #include <filesystem>
 #include <fstream>
 #include <string>
+#include <unordered_map>
 
 namespace Coffee {
 
     std::filesystem::path ResourceLoader::s_WorkingDirectory = std::filesystem::current_path();
     ResourceImporter ResourceLoader::s_Importer = ResourceImporter();
 
+    static std::unordered_map<UUID, FileWatcher::WatchID> s_ShaderWatches; ///< One hot-reload watch per shader file.
+
+    static void UnwatchShader(UUID uuid)
+    {
+        auto it = s_ShaderWatches.find(uuid);
+        if(it == s_ShaderWatches.end())
+            return;
+
+        FileWatcher::Unwatch(it->second);
+        s_ShaderWatches.erase(it);
+    }
+
     void ResourceLoader::LoadFile(const std::filesystem::path& path)
     {
+        COFFEE_MEMORY_TAG(Resources);
+
         if (!is_regular_file(path))
         {
             COFFEE_CORE_ERROR("ResourceLoader::LoadResources: {0} is not a file!", path.string());
@@ -80,6 +97,8 @@ namespace Coffee {
 
     void ResourceLoader::LoadDirectory(const std::filesystem::path& directory)
     {
+        COFFEE_MEMORY_TAG(Resources);
+
         for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
         {
             // This two if statements are duplicated in LoadFile but are necessary to suppress errors
@@ -100,6 +119,8 @@ namespace Coffee {
 
     Ref<Texture2D> ResourceLoader::LoadTexture2D(const std::filesystem::path& path, bool srgb, bool cache)
     {
+        COFFEE_MEMORY_TAG(Resources);
+
         if(GetResourceTypeFromExtension(path) != ResourceType::Texture2D)
         {
             COFFEE_CORE_ERROR("ResourceLoader::Load<Texture2D>: Resource is not a texture!");
@@ -122,6 +143,8 @@ namespace Coffee {
 
     Ref<Texture2D> ResourceLoader::LoadTexture2D(UUID uuid)
     {
+        COFFEE_MEMORY_TAG(Resources);
+
         if(uuid == UUID::null)
             return nullptr;
 
@@ -138,6 +161,8 @@ namespace Coffee {
 
     Ref<Cubemap> ResourceLoader::LoadCubemap(const std::filesystem::path& path)
     {
+        COFFEE_MEMORY_TAG(Resources);
+
         if(GetResourceTypeFromExtension(path) != ResourceType::Cubemap)
         {
             COFFEE_CORE_ERROR("ResourceLoader::Load<Cubemap>: Resource is not a cubemap!");
@@ -165,6 +190,8 @@ namespace Coffee {
 
     Ref<Model> ResourceLoader::LoadModel(const std::filesystem::path& path, bool cache)
     {
+        COFFEE_MEMORY_TAG(Resources);
+
         if(GetResourceTypeFromExtension(path) != ResourceType::Model)
         {
             COFFEE_CORE_ERROR("ResourceLoader::Load<Model>: Resource is not a model!");
@@ -187,6 +214,8 @@ namespace Coffee {
 
     Ref<Mesh> ResourceLoader::LoadMesh(const std::string& name, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, Ref<Material>& material, const AABB& aabb)
     {
+        COFFEE_MEMORY_TAG(Resources);
+
         if(ResourceRegistry::Exists(name))
         {
             return ResourceRegistry::Get<Mesh>(name);
@@ -203,6 +232,8 @@ namespace Coffee {
 
     Ref<Mesh> ResourceLoader::LoadMesh(UUID uuid)
     {
+        COFFEE_MEMORY_TAG(Resources);
+
         if(ResourceRegistry::Exists(uuid))
         {
             return ResourceRegistry::Get<Mesh>(uuid);
@@ -216,6 +247,8 @@ namespace Coffee {
 
     Ref<Shader> ResourceLoader::LoadShader(const std::filesystem::path& shaderPath)
     {
+        COFFEE_MEMORY_TAG(Resources);
+
         if(GetResourceTypeFromExtension(shaderPath) != ResourceType::Shader)
         {
             COFFEE_CORE_ERROR("ResourceLoader::Load<Shader>: Resource is not a shader!");
@@ -234,11 +267,23 @@ namespace Coffee {
 
         ResourceRegistry::Add(uuid, shader);
 
+        // Hot-reload the shader when the file changes. The watch outlives the shader when it is unloaded and
+        // loaded again, so it looks the shader up by UUID instead of holding it
+        if(s_ShaderWatches.find(uuid) == s_ShaderWatches.end())
+        {
+            s_ShaderWatches[uuid] = FileWatcher::Watch(shaderPath, [uuid](const std::filesystem::path&) {
+                if(ResourceRegistry::Exists(uuid))
+                    ResourceRegistry::Get<Shader>(uuid)->Reload();
+            });
+        }
+
         return shader;
     }
 
     Ref<Material> ResourceLoader::LoadMaterial(const std::string& name)
     {
+        COFFEE_MEMORY_TAG(Resources);
+
         std::string materialName = name;
 
         UUID uuid;
@@ -262,6 +307,8 @@ namespace Coffee {
 
     Ref<Material> ResourceLoader::LoadMaterial(const std::string& name, MaterialTextures& materialTextures)
     {
+        COFFEE_MEMORY_TAG(Resources);
+
         std::string materialName = name;
 
         UUID uuid;
@@ -284,6 +331,8 @@ namespace Coffee {
     
     Ref<Material> ResourceLoader::LoadMaterial(UUID uuid)
     {
+        COFFEE_MEMORY_TAG(Resources);
+
         if(ResourceRegistry::Exists(uuid))
         {
             return ResourceRegistry::Get<Material>(uuid);
@@ -310,6 +359,8 @@ namespace Coffee {
             std::filesystem::remove(cacheFilePath);
         }
 
+        UnwatchShader(uuid);
+
         const Ref<Resource>& resource = ResourceRegistry::Get<Resource>(uuid);
 
         const std::filesystem::path& resourcePath = resource->GetPath();
@@ -340,6 +391,8 @@ namespace Coffee {
             std::filesystem::remove(cacheFilePath);
         }
 
+        UnwatchShader(uuid);
+
         const Ref<Resource>& resource = ResourceRegistry::Get<Resource>(uuid);
 
         const std::filesystem::path& resourcePath = resource->GetPath();
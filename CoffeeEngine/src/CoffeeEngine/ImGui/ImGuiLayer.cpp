@@ -1,6 +1,7 @@
 #include "ImGuiLayer.h"
 
 #include "CoffeeEngine/Core/Application.h"
+#include "CoffeeEngine/Core/MemoryProfiler.h"
 #include "CoffeeEngine/Core/Window.h"
 #include "SDL3/SDL_video.h"
 
@@ -32,6 +33,15 @@ namespace Coffee {
         ZoneScoped;
 
         IMGUI_CHECKVERSION();
+
+        // ImGui allocates with malloc by default, route it through operator new so it is counted under its tag
+        if (MemoryProfiler::IsCpuTrackingEnabled())
+        {
+            ImGui::SetAllocatorFunctions(
+                [](size_t size, void*) -> void* { COFFEE_MEMORY_TAG(ImGui); return ::operator new(size, std::nothrow); },
+                [](void* ptr, void*) { ::operator delete(ptr); });
+        }
+
         ImGui::CreateContext();
         ImGui::StyleColorsDark();
 
@@ -0,0 +1,76 @@
+#include "CoffeeEngine/Renderer/BindlessTexture.h"
+#include "CoffeeEngine/Core/Log.h"
+
+#include <SDL3/SDL_video.h>
+#include <glad/glad.h>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    typedef GLuint64 (APIENTRYP PFNGLGETTEXTUREHANDLEARBPROC)(GLuint texture);
+    typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)(GLuint64 handle);
+    typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)(GLuint64 handle);
+    typedef void (APIENTRYP PFNGLUNIFORMHANDLEUI64ARBPROC)(GLint location, GLuint64 value);
+
+    static PFNGLGETTEXTUREHANDLEARBPROC s_glGetTextureHandleARB = nullptr;
+    static PFNGLMAKETEXTUREHANDLERESIDENTARBPROC s_glMakeTextureHandleResidentARB = nullptr;
+    static PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC s_glMakeTextureHandleNonResidentARB = nullptr;
+    static PFNGLUNIFORMHANDLEUI64ARBPROC s_glUniformHandleui64ARB = nullptr;
+
+    bool BindlessTexture::s_Supported = false;
+
+    void BindlessTexture::Init()
+    {
+        ZoneScoped;
+
+        s_Supported = false;
+
+        if(!SDL_GL_ExtensionSupported("GL_ARB_bindless_texture"))
+        {
+            COFFEE_CORE_INFO("BindlessTexture: GL_ARB_bindless_texture not supported, using texture arrays");
+            return;
+        }
+
+        s_glGetTextureHandleARB = (PFNGLGETTEXTUREHANDLEARBPROC)SDL_GL_GetProcAddress("glGetTextureHandleARB");
+        s_glMakeTextureHandleResidentARB = (PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)SDL_GL_GetProcAddress("glMakeTextureHandleResidentARB");
+        s_glMakeTextureHandleNonResidentARB = (PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)SDL_GL_GetProcAddress("glMakeTextureHandleNonResidentARB");
+        s_glUniformHandleui64ARB = (PFNGLUNIFORMHANDLEUI64ARBPROC)SDL_GL_GetProcAddress("glUniformHandleui64ARB");
+
+        s_Supported = s_glGetTextureHandleARB && s_glMakeTextureHandleResidentARB &&
+                      s_glMakeTextureHandleNonResidentARB && s_glUniformHandleui64ARB;
+
+        if(s_Supported)
+            COFFEE_CORE_INFO("BindlessTexture: GL_ARB_bindless_texture enabled");
+        else
+            COFFEE_CORE_ERROR("BindlessTexture: Failed to load the GL_ARB_bindless_texture entry points!");
+    }
+
+    uint64_t BindlessTexture::CreateHandle(uint32_t textureID)
+    {
+        ZoneScoped;
+
+        if(!s_Supported || textureID == 0)
+            return 0;
+
+        GLuint64 handle = s_glGetTextureHandleARB(textureID);
+        s_glMakeTextureHandleResidentARB(handle);
+        return handle;
+    }
+
+    void BindlessTexture::ReleaseHandle(uint64_t handle)
+    {
+        if(!s_Supported || handle == 0)
+            return;
+
+        s_glMakeTextureHandleNonResidentARB(handle);
+    }
+
+    void BindlessTexture::SetUniformHandle(int location, uint64_t handle)
+    {
+        if(!s_Supported)
+            return;
+
+        s_glUniformHandleui64ARB(location, handle);
+    }
+
+}
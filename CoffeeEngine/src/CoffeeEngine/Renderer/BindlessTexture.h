@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Coffee {
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    /**
+     * @brief Wrapper over the GL_ARB_bindless_texture extension.
+     *
+     * The vendored GLAD is generated without extensions, so the entry points are loaded
+     * manually through SDL when the driver exposes the extension.
+     */
+    class BindlessTexture
+    {
+    public:
+        /**
+         * @brief Checks if the extension is available and loads its entry points.
+         * @note Must be called with a current OpenGL context.
+         */
+        static void Init();
+
+        /**
+         * @brief Checks if bindless textures are supported by the driver.
+         * @return True if bindless textures are supported.
+         */
+        static bool IsSupported() { return s_Supported; }
+
+        /**
+         * @brief Gets the bindless handle of a texture and makes it resident.
+         * @param textureID The OpenGL texture ID.
+         * @return The resident handle, or 0 if bindless textures are not supported.
+         * @note Once a handle is created the sampling state of the texture can no longer change.
+         */
+        static uint64_t CreateHandle(uint32_t textureID);
+
+        /**
+         * @brief Makes a handle non resident. Must be called before deleting the texture.
+         * @param handle The handle returned by CreateHandle.
+         */
+        static void ReleaseHandle(uint64_t handle);
+
+        /**
+         * @brief Sets a bindless sampler uniform of the currently bound program.
+         * @param location The location of the uniform.
+         * @param handle The resident handle.
+         */
+        static void SetUniformHandle(int location, uint64_t handle);
+
+    private:
+        static bool s_Supported; ///< Whether GL_ARB_bindless_texture is available.
+    };
+
+    /** @} */
+}
@@ -12,6 +12,7 @@ namespace Coffee {
         glGenBuffers(1, &m_vboID);
         glBindBuffer(GL_ARRAY_BUFFER, m_vboID);
         glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+        m_GpuMemory.Track(GpuMemoryType::Buffer, this, size);
     }
 
     VertexBuffer::VertexBuffer(float* vertices, uint32_t size)
@@ -21,6 +22,7 @@ namespace Coffee {
         glGenBuffers(1, &m_vboID);
         glBindBuffer(GL_ARRAY_BUFFER, m_vboID);
         glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+        m_GpuMemory.Track(GpuMemoryType::Buffer, this, size);
     }
 
     VertexBuffer::~VertexBuffer()
@@ -67,6 +69,7 @@ namespace Coffee {
         glGenBuffers(1, &m_eboID);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_eboID);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(uint32_t), indices, GL_STATIC_DRAW);
+        m_GpuMemory.Track(GpuMemoryType::Buffer, this, count * sizeof(uint32_t));
     }
 
     IndexBuffer::~IndexBuffer()
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Core/MemoryProfiler.h"
 #include <cstdint>
 
 namespace Coffee {
@@ -242,6 +243,7 @@ namespace Coffee {
 
     private:
         uint32_t m_vboID; ///< The ID of the vertex buffer object.
+        GpuMemoryAllocation m_GpuMemory; ///< The GPU memory of the buffer.
         BufferLayout m_Layout; ///< The layout of the vertex buffer.
     };
 
@@ -290,6 +292,7 @@ namespace Coffee {
     private:
         uint32_t m_eboID; ///< The ID of the element buffer object.
         uint32_t m_Count; ///< The number of indices in the buffer.
+        GpuMemoryAllocation m_GpuMemory; ///< The GPU memory of the buffer.
     };
 
     /** @} */
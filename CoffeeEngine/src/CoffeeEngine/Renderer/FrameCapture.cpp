@@ -0,0 +1,215 @@
+#include "CoffeeEngine/Renderer/FrameCapture.h"
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/IO/ResourceLoader.h"
+#include "CoffeeEngine/Renderer/FramePacket.h"
+
+#include <cereal/archives/binary.hpp>
+#include <fstream>
+#include <tracy/Tracy.hpp>
+#include <unordered_map>
+
+namespace Coffee {
+
+    bool FrameCapture::s_Capturing = false;
+    std::filesystem::path FrameCapture::s_RequestedPath;
+    FrameCaptureData FrameCapture::s_Capture;
+
+    void FrameCapture::RequestCapture(const std::filesystem::path& path)
+    {
+        s_RequestedPath = path;
+    }
+
+    void FrameCapture::BeginFrame(const FramePacket& packet)
+    {
+        if(s_RequestedPath.empty())
+            return;
+
+        ZoneScoped;
+
+        s_Capturing = true;
+        s_Capture = FrameCaptureData();
+
+        s_Capture.ViewportWidth = packet.ViewportWidth;
+        s_Capture.ViewportHeight = packet.ViewportHeight;
+
+        s_Capture.Projection = packet.Camera.projection;
+        s_Capture.View = packet.Camera.view;
+        s_Capture.CameraPosition = packet.Camera.position;
+
+        s_Capture.Lights.assign(packet.Lights.lights, packet.Lights.lights + packet.Lights.lightCount);
+
+        s_Capture.PostProcessing = packet.Settings.PostProcessing;
+        s_Capture.Exposure = packet.Settings.Exposure;
+        s_Capture.BindlessTextures = packet.Settings.BindlessTextures;
+        s_Capture.TextureArrays = packet.Settings.TextureArrays;
+
+        s_Capture.Draws.reserve(packet.Commands.size());
+    }
+
+    void FrameCapture::RecordDraw(const RenderCommand& command, uint32_t shaderFeatures)
+    {
+        if(!s_Capturing)
+            return;
+
+        FrameCaptureDraw draw;
+        draw.Transform = command.transform;
+        draw.MeshUUID = command.mesh->GetUUID();
+        draw.MaterialUUID = command.material ? command.material->GetUUID() : UUID::null;
+        draw.EntityID = command.entityID;
+        draw.VertexCount = command.mesh->GetVertices().size();
+        draw.IndexCount = command.mesh->GetIndices().size();
+        draw.ShaderFeatures = shaderFeatures;
+
+        s_Capture.Draws.push_back(draw);
+    }
+
+    void FrameCapture::RecordEvent(FrameCaptureEvent::Type type, uint32_t count, const glm::vec4& value)
+    {
+        if(!s_Capturing)
+            return;
+
+        s_Capture.Events.push_back({ type, count, value });
+    }
+
+    void FrameCapture::EndFrame()
+    {
+        if(!s_Capturing)
+            return;
+
+        ZoneScoped;
+
+        s_Capturing = false;
+
+        if(Save(s_RequestedPath, s_Capture))
+        {
+            COFFEE_CORE_INFO("FrameCapture: Captured {0} draws and {1} calls to {2}", s_Capture.Draws.size(), s_Capture.Events.size(), s_RequestedPath.string());
+        }
+
+        s_RequestedPath.clear();
+        s_Capture = FrameCaptureData();
+    }
+
+    bool FrameCapture::Save(const std::filesystem::path& path, const FrameCaptureData& capture)
+    {
+        ZoneScoped;
+
+        std::ofstream file{path, std::ios::binary};
+
+        if(!file)
+        {
+            COFFEE_CORE_ERROR("FrameCapture::Save: Could not open {0} for writing", path.string());
+            return false;
+        }
+
+        cereal::BinaryOutputArchive archive(file);
+        archive(capture);
+
+        return true;
+    }
+
+    bool FrameCapture::Load(const std::filesystem::path& path, FrameCaptureData& capture)
+    {
+        ZoneScoped;
+
+        std::ifstream file{path, std::ios::binary};
+
+        if(!file)
+        {
+            COFFEE_CORE_ERROR("FrameCapture::Load: Could not open {0}", path.string());
+            return false;
+        }
+
+        // The version is the first field, check it before reading a layout we don't know
+        uint32_t version = 0;
+        file.read(reinterpret_cast<char*>(&version), sizeof(version));
+
+        if(version != FrameCaptureData::CurrentVersion)
+        {
+            COFFEE_CORE_ERROR("FrameCapture::Load: {0} has version {1}, expected {2}", path.string(), version, FrameCaptureData::CurrentVersion);
+            return false;
+        }
+
+        file.seekg(0);
+
+        cereal::BinaryInputArchive archive(file);
+        archive(capture);
+
+        return true;
+    }
+
+    std::vector<RenderCommand> FrameCapture::BuildRenderQueue(const FrameCaptureData& capture)
+    {
+        ZoneScoped;
+
+        std::unordered_map<UUID, Ref<Mesh>> meshes;
+        std::unordered_map<UUID, Ref<Material>> materials;
+        uint32_t missingMeshes = 0;
+
+        std::vector<RenderCommand> renderQueue;
+        renderQueue.reserve(capture.Draws.size());
+
+        for(const FrameCaptureDraw& draw : capture.Draws)
+        {
+            auto meshIt = meshes.find(draw.MeshUUID);
+            if(meshIt == meshes.end())
+            {
+                Ref<Mesh> mesh = ResourceLoader::LoadMesh(draw.MeshUUID);
+
+                // Keep the submission cost of the frame even without the original geometry
+                if(!mesh)
+                {
+                    mesh = CreateRef<Mesh>(std::vector<Vertex>(draw.VertexCount), std::vector<uint32_t>(draw.IndexCount, 0));
+                    missingMeshes++;
+                }
+
+                meshIt = meshes.emplace(draw.MeshUUID, mesh).first;
+            }
+
+            Ref<Material> material;
+            if(draw.MaterialUUID != UUID::null)
+            {
+                auto materialIt = materials.find(draw.MaterialUUID);
+                if(materialIt == materials.end())
+                {
+                    materialIt = materials.emplace(draw.MaterialUUID, ResourceLoader::LoadMaterial(draw.MaterialUUID)).first;
+                }
+                material = materialIt->second;
+            }
+
+            renderQueue.push_back({ draw.Transform, meshIt->second, material, draw.EntityID });
+        }
+
+        if(missingMeshes > 0)
+        {
+            COFFEE_CORE_WARN("FrameCapture::BuildRenderQueue: {0} meshes were not found in the cache, replaced by empty meshes", missingMeshes);
+        }
+
+        return renderQueue;
+    }
+
+    void FrameCapture::Replay(const FrameCaptureData& capture, const std::vector<RenderCommand>& renderQueue)
+    {
+        ZoneScoped;
+
+        RenderSettings& settings = Renderer::GetRenderSettings();
+        settings.PostProcessing = capture.PostProcessing;
+        settings.Exposure = capture.Exposure;
+        settings.BindlessTextures = capture.BindlessTextures;
+        settings.TextureArrays = capture.TextureArrays;
+
+        Renderer::BeginScene(capture.View, capture.Projection, capture.CameraPosition);
+
+        for(const LightComponent& light : capture.Lights)
+        {
+            Renderer::Submit(light);
+        }
+
+        for(const RenderCommand& command : renderQueue)
+        {
+            Renderer::Submit(command);
+        }
+
+        Renderer::EndScene();
+    }
+
+}
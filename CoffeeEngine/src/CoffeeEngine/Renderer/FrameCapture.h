@@ -0,0 +1,190 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Core/UUID.h"
+#include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
+#include "CoffeeEngine/Renderer/Renderer.h"
+
+#include <cereal/types/vector.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    /**
+     * @brief A draw of the render queue as it was submitted in the captured frame.
+     */
+    struct FrameCaptureDraw
+    {
+        glm::mat4 Transform = glm::mat4(1.0f); ///< The model matrix uploaded for the draw.
+        UUID MeshUUID = UUID::null; ///< The mesh resource.
+        UUID MaterialUUID = UUID::null; ///< The material resource, null if the default material was used.
+        uint32_t EntityID = 4294967295; ///< The entity ID written to the entity ID buffer.
+        uint32_t VertexCount = 0; ///< Number of vertices of the mesh.
+        uint32_t IndexCount = 0; ///< Number of indices drawn.
+        uint32_t ShaderFeatures = 0; ///< The ShaderFeature mask of the permutation used.
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(Transform, MeshUUID, MaterialUUID, EntityID, VertexCount, IndexCount, ShaderFeatures);
+        }
+    };
+
+    /**
+     * @brief A state change, uniform upload or draw call made while the frame was captured.
+     */
+    struct FrameCaptureEvent
+    {
+        enum class Type : uint8_t
+        {
+            SetClearColor, ///< Value holds the clear color.
+            Clear,
+            SetDepthMask, ///< Count is 1 if the depth mask was enabled.
+            UniformBufferUpload, ///< Count is the size in bytes, Value.x the binding.
+            DrawIndexed, ///< Count is the index count.
+            DrawLines ///< Count is the vertex count, Value.x the line width.
+        };
+
+        Type EventType = Type::Clear; ///< The recorded call.
+        uint32_t Count = 0; ///< Call dependent count.
+        glm::vec4 Value = glm::vec4(0.0f); ///< Call dependent value.
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(EventType, Count, Value);
+        }
+    };
+
+    /**
+     * @brief Everything Renderer::EndScene needs to reproduce a frame.
+     */
+    struct FrameCaptureData
+    {
+        static constexpr uint32_t CurrentVersion = 1; ///< Bumped every time the layout changes.
+
+        uint32_t Version = CurrentVersion; ///< The version of the capture file.
+
+        uint32_t ViewportWidth = 0; ///< Width of the viewport when the frame was captured.
+        uint32_t ViewportHeight = 0; ///< Height of the viewport when the frame was captured.
+
+        glm::mat4 Projection = glm::mat4(1.0f); ///< The camera projection matrix.
+        glm::mat4 View = glm::mat4(1.0f); ///< The camera view matrix.
+        glm::vec3 CameraPosition = glm::vec3(0.0f); ///< The camera position.
+
+        std::vector<LightComponent> Lights; ///< The submitted lights.
+
+        bool PostProcessing = true; ///< RenderSettings::PostProcessing.
+        float Exposure = 1.0f; ///< RenderSettings::Exposure.
+        bool BindlessTextures = true; ///< RenderSettings::BindlessTextures.
+        bool TextureArrays = true; ///< RenderSettings::TextureArrays.
+
+        std::vector<FrameCaptureDraw> Draws; ///< The render queue in the order it was drawn.
+        std::vector<FrameCaptureEvent> Events; ///< The Renderer API calls in call order.
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(Version, ViewportWidth, ViewportHeight, Projection, View, CameraPosition, Lights,
+                    PostProcessing, Exposure, BindlessTextures, TextureArrays, Draws, Events);
+        }
+    };
+
+    /**
+     * @brief Captures what Renderer::EndScene did in a frame and replays it.
+     *
+     * A capture stores the render queue, the camera, the lights, the render settings and every
+     * Renderer API call of one frame in a compact binary file. Meshes and materials are referenced
+     * by UUID, so replaying against the original project cache reproduces the frame; meshes that
+     * can't be found are replaced by empty meshes with the same vertex and index counts.
+     */
+    class FrameCapture
+    {
+    public:
+        /**
+         * @brief Requests the next frame rendered by Renderer::EndScene to be captured.
+         * @param path The file the capture is written to.
+         */
+        static void RequestCapture(const std::filesystem::path& path);
+
+        /**
+         * @brief Checks if the current frame is being captured.
+         * @return True while Renderer::EndScene runs for a requested capture.
+         */
+        static bool IsCapturing() { return s_Capturing; }
+
+        /**
+         * @brief Starts capturing the frame if a capture was requested. Called when a frame packet is rendered.
+         * @param packet The frame packet being rendered.
+         */
+        static void BeginFrame(const FramePacket& packet);
+
+        /**
+         * @brief Records a draw of the render queue of the frame being captured.
+         * @param command The render command drawn.
+         * @param shaderFeatures The ShaderFeature mask of the permutation used.
+         */
+        static void RecordDraw(const RenderCommand& command, uint32_t shaderFeatures);
+
+        /**
+         * @brief Records a Renderer API call of the frame being captured.
+         * @param type The recorded call.
+         * @param count Call dependent count.
+         * @param value Call dependent value.
+         */
+        static void RecordEvent(FrameCaptureEvent::Type type, uint32_t count = 0, const glm::vec4& value = glm::vec4(0.0f));
+
+        /**
+         * @brief Writes the capture to disk if the frame was being captured. Called by Renderer::EndScene.
+         */
+        static void EndFrame();
+
+        /**
+         * @brief Writes a capture to a binary file.
+         * @param path The file to write.
+         * @param capture The capture to write.
+         * @return True if the file was written.
+         */
+        static bool Save(const std::filesystem::path& path, const FrameCaptureData& capture);
+
+        /**
+         * @brief Reads a capture from a binary file.
+         * @param path The file to read.
+         * @param capture The capture read from the file.
+         * @return True if the file was read and its version is supported.
+         */
+        static bool Load(const std::filesystem::path& path, FrameCaptureData& capture);
+
+        /**
+         * @brief Resolves the meshes and materials of a capture into a render queue.
+         *
+         * Done once before replaying so the resource loading is not measured with the submission.
+         * @param capture The capture.
+         * @return The render queue to pass to Replay().
+         */
+        static std::vector<RenderCommand> BuildRenderQueue(const FrameCaptureData& capture);
+
+        /**
+         * @brief Renders a captured frame through Renderer::BeginScene, Submit and EndScene.
+         * @param capture The capture.
+         * @param renderQueue The render queue built by BuildRenderQueue().
+         */
+        static void Replay(const FrameCaptureData& capture, const std::vector<RenderCommand>& renderQueue);
+
+    private:
+        static bool s_Capturing; ///< Whether the current frame is being captured.
+        static std::filesystem::path s_RequestedPath; ///< Where the requested capture is written, empty if none.
+        static FrameCaptureData s_Capture; ///< The capture being recorded.
+    };
+
+    /** @} */
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "CoffeeEngine/Core/FrameAllocator.h"
+#include "CoffeeEngine/Renderer/Renderer.h"
+
+#include <cstdint>
+
+namespace Coffee {
+
+    /**
+     * @defgroup renderer Renderer
+     * @{
+     */
+
+    /**
+     * @brief Everything needed to render one frame, extracted from the scene at Renderer::EndScene().
+     *
+     * The packet holds copies of the camera, the lights and the render settings, and takes over the
+     * render queue, so rendering and frame capture read one consistent snapshot of the frame. It is
+     * rendered in the frame that built it and its queue lives in the FrameAllocator arena of that frame.
+     */
+    struct FramePacket
+    {
+        RendererData::CameraData Camera; ///< The camera of the frame.
+        RendererData::RenderData Lights; ///< The lights of the frame.
+        FrameVector<RenderCommand> Commands; ///< The render queue of the frame.
+        RenderSettings Settings; ///< The render settings when the frame was built.
+        uint32_t ViewportWidth = 0; ///< Width of the viewport, 0 if it was never set.
+        uint32_t ViewportHeight = 0; ///< Height of the viewport, 0 if it was never set.
+    };
+
+    /** @} */
+}
@@ -1,5 +1,6 @@
 #include "Framebuffer.h"
 #include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Core/MemoryProfiler.h"
 #include "CoffeeEngine/Renderer/Texture.h"
 
 #include <cstdint>
@@ -53,6 +54,7 @@ namespace Coffee {
     void Framebuffer::Invalidate()
     {
         ZoneScoped;
+        COFFEE_MEMORY_TAG(Renderer);
 
         if(m_fboID)
         {
@@ -0,0 +1,214 @@
+#include "GpuProfiler.h"
+
+#include "CoffeeEngine/Core/Metrics.h"
+#include "CoffeeEngine/Renderer/RendererAPI.h"
+
+#include <glad/glad.h>
+#include <iterator>
+#include <optional>
+#include <tracy/Tracy.hpp>
+#include <tracy/TracyOpenGL.hpp>
+
+namespace Coffee {
+
+    static constexpr size_t PassCount = (size_t)GpuPass::Count;
+
+    struct QueryFrame
+    {
+        std::array<GLuint, PassCount> Queries = {};
+        std::array<bool, PassCount> Issued = {}; // Passes that ran this frame
+        uint64_t FrameIndex = 0;
+        bool Pending = false; // The results were not read yet
+    };
+
+    static std::array<QueryFrame, GpuProfiler::QueryFrames> s_Frames;
+    static uint32_t s_CurrentFrame = 0;
+    static uint64_t s_FrameCounter = 0;
+    static bool s_Enabled = false;
+    static bool s_InFrame = false;
+
+    static GpuPassTimings s_LastTimings;
+    static std::array<Metric*, PassCount> s_PassMetrics = {};
+    static Metric* s_FrameMetric = nullptr;
+
+    static constexpr const char* s_PassNames[] = { "Geometry", "Skybox", "Tone Mapping", "Final Pass", "Debug" };
+    static_assert(std::size(s_PassNames) == PassCount, "Every GpuPass needs a name");
+
+#ifdef TRACY_ENABLE
+    static constexpr tracy::SourceLocationData s_TracyLocations[] = {
+        { "Geometry", "Renderer::RenderPacket", __FILE__, (uint32_t)__LINE__, 0 },
+        { "Skybox", "Renderer::RenderPacket", __FILE__, (uint32_t)__LINE__, 0 },
+        { "Tone Mapping", "Renderer::RenderPacket", __FILE__, (uint32_t)__LINE__, 0 },
+        { "Final Pass", "Renderer::RenderPacket", __FILE__, (uint32_t)__LINE__, 0 },
+        { "Debug", "Renderer::RenderPacket", __FILE__, (uint32_t)__LINE__, 0 },
+    };
+    static_assert(std::size(s_TracyLocations) == PassCount, "Every GpuPass needs a Tracy source location");
+
+    static std::array<std::optional<tracy::GpuCtxScope>, PassCount> s_TracyZones;
+#endif
+
+    // Reads the frames whose results are ready, oldest first. Never waits for the GPU.
+    static void ReadResults()
+    {
+        for (uint32_t i = 1; i <= GpuProfiler::QueryFrames; i++)
+        {
+            QueryFrame& frame = s_Frames[(s_CurrentFrame + i) % GpuProfiler::QueryFrames];
+            if (!frame.Pending)
+                continue;
+
+            for (size_t pass = 0; pass < PassCount; pass++)
+            {
+                if (!frame.Issued[pass])
+                    continue;
+
+                GLint available = 0;
+                glGetQueryObjectiv(frame.Queries[pass], GL_QUERY_RESULT_AVAILABLE, &available);
+
+                // The GPU finishes the frames in order, the newer ones are not ready either
+                if (!available)
+                    return;
+            }
+
+            GpuPassTimings timings;
+            timings.FrameIndex = frame.FrameIndex;
+
+            for (size_t pass = 0; pass < PassCount; pass++)
+            {
+                if (!frame.Issued[pass])
+                    continue;
+
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(frame.Queries[pass], GL_QUERY_RESULT, &elapsed);
+
+                timings.PassTimes[pass] = (float)(elapsed / 1000000.0);
+                timings.FrameTime += timings.PassTimes[pass];
+            }
+
+            frame.Pending = false;
+            s_LastTimings = timings;
+
+            for (size_t pass = 0; pass < PassCount; pass++)
+            {
+                s_PassMetrics[pass]->Set(timings.PassTimes[pass]);
+            }
+            s_FrameMetric->Set(timings.FrameTime);
+        }
+    }
+
+    void GpuProfiler::Init()
+    {
+        ZoneScoped;
+
+        if (s_Enabled || RendererAPI::GetAPI() != RendererAPI::API::OpenGL)
+            return;
+
+        for (QueryFrame& frame : s_Frames)
+        {
+            glGenQueries((GLsizei)PassCount, frame.Queries.data());
+            frame.Pending = false;
+        }
+
+        for (size_t pass = 0; pass < PassCount; pass++)
+        {
+            s_PassMetrics[pass] = &Metrics::Gauge(std::string("GPU ") + s_PassNames[pass]);
+        }
+        s_FrameMetric = &Metrics::Gauge("GPU Frame Time");
+
+        TracyGpuContext;
+
+        s_Enabled = true;
+    }
+
+    void GpuProfiler::Shutdown()
+    {
+        if (!s_Enabled)
+            return;
+
+        for (QueryFrame& frame : s_Frames)
+        {
+            glDeleteQueries((GLsizei)PassCount, frame.Queries.data());
+            frame.Queries = {};
+            frame.Pending = false;
+        }
+
+        s_Enabled = false;
+    }
+
+    bool GpuProfiler::IsEnabled()
+    {
+        return s_Enabled;
+    }
+
+    void GpuProfiler::BeginFrame()
+    {
+        if (!s_Enabled)
+            return;
+
+        ZoneScoped;
+
+        ReadResults();
+
+        s_CurrentFrame = (s_CurrentFrame + 1) % QueryFrames;
+
+        // Results still missing after QueryFrames frames are dropped, the queries are reused
+        QueryFrame& frame = s_Frames[s_CurrentFrame];
+        frame.Issued = {};
+        frame.Pending = false;
+        frame.FrameIndex = s_FrameCounter++;
+
+        s_InFrame = true;
+    }
+
+    void GpuProfiler::EndFrame()
+    {
+        if (!s_Enabled)
+            return;
+
+        QueryFrame& frame = s_Frames[s_CurrentFrame];
+        for (bool issued : frame.Issued)
+        {
+            frame.Pending |= issued;
+        }
+
+        s_InFrame = false;
+
+        TracyGpuCollect;
+    }
+
+    void GpuProfiler::BeginPass(GpuPass pass)
+    {
+        if (!s_InFrame)
+            return;
+
+        QueryFrame& frame = s_Frames[s_CurrentFrame];
+        glBeginQuery(GL_TIME_ELAPSED, frame.Queries[(size_t)pass]);
+        frame.Issued[(size_t)pass] = true;
+
+#ifdef TRACY_ENABLE
+        s_TracyZones[(size_t)pass].emplace(&s_TracyLocations[(size_t)pass], true);
+#endif
+    }
+
+    void GpuProfiler::EndPass(GpuPass pass)
+    {
+        if (!s_InFrame)
+            return;
+
+#ifdef TRACY_ENABLE
+        s_TracyZones[(size_t)pass].reset();
+#endif
+
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+
+    const GpuPassTimings& GpuProfiler::GetLastTimings()
+    {
+        return s_LastTimings;
+    }
+
+    const char* GpuProfiler::GetPassName(GpuPass pass)
+    {
+        return pass < GpuPass::Count ? s_PassNames[(size_t)pass] : "Unknown";
+    }
+
+}
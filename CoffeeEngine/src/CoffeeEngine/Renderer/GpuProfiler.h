@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace Coffee {
+
+    /**
+     * @defgroup renderer Renderer
+     * @{
+     */
+
+    /**
+     * @brief The passes of a frame timed on the GPU.
+     */
+    enum class GpuPass : uint8_t
+    {
+        Geometry,
+        Skybox,
+        ToneMapping,
+        FinalPass,
+        Debug,
+        Count
+    };
+
+    /**
+     * @brief GPU time of each pass of a frame, in milliseconds.
+     */
+    struct GpuPassTimings
+    {
+        std::array<float, (size_t)GpuPass::Count> PassTimes = {}; ///< Time of each pass, 0 if it did not run.
+        float FrameTime = 0.0f; ///< Sum of the pass times.
+        uint64_t FrameIndex = 0; ///< Number of the frame the timings belong to.
+    };
+
+    /**
+     * @brief Times the render passes on the GPU with GL_TIME_ELAPSED queries.
+     *
+     * Every frame uses its own set of queries from a ring of QueryFrames frames, and the results of
+     * a frame are only read once the GPU reports them available, so the CPU never waits for the
+     * GPU. The timings are therefore a few frames old. They are published to the "GPU Frame Time"
+     * and "GPU <pass>" gauges of Metrics, and the passes are sent to Tracy as GPU zones. Disabled
+     * with the Null backend.
+     */
+    class GpuProfiler
+    {
+    public:
+        static constexpr uint32_t QueryFrames = 5; ///< Frames of queries in flight.
+
+        /**
+         * @brief Creates the queries and the Tracy GPU context. Needs a current OpenGL context.
+         */
+        static void Init();
+
+        /**
+         * @brief Deletes the queries.
+         */
+        static void Shutdown();
+
+        /**
+         * @brief Whether the passes are being timed.
+         * @return True if the GPU profiler was initialized with the OpenGL backend.
+         */
+        static bool IsEnabled();
+
+        /**
+         * @brief Reads the results that are ready and starts a new frame of queries.
+         */
+        static void BeginFrame();
+
+        /**
+         * @brief Ends the frame of queries and collects the Tracy GPU zones.
+         */
+        static void EndFrame();
+
+        /**
+         * @brief Starts timing a pass. Passes can not be nested.
+         * @param pass The pass.
+         */
+        static void BeginPass(GpuPass pass);
+
+        /**
+         * @brief Stops timing a pass.
+         * @param pass The pass.
+         */
+        static void EndPass(GpuPass pass);
+
+        /**
+         * @brief Gets the timings of the last frame whose results were read.
+         * @return The timings.
+         */
+        static const GpuPassTimings& GetLastTimings();
+
+        /**
+         * @brief Gets the name of a pass.
+         * @param pass The pass.
+         * @return The name.
+         */
+        static const char* GetPassName(GpuPass pass);
+    };
+
+    /**
+     * @brief Times a pass on the GPU for its lifetime.
+     */
+    class GpuPassScope
+    {
+    public:
+        GpuPassScope(GpuPass pass) : m_Pass(pass) { GpuProfiler::BeginPass(m_Pass); }
+        ~GpuPassScope() { GpuProfiler::EndPass(m_Pass); }
+
+        GpuPassScope(const GpuPassScope&) = delete;
+        GpuPassScope& operator=(const GpuPassScope&) = delete;
+
+    private:
+        GpuPass m_Pass;
+    };
+
+    /** @} */
+}
@@ -3,7 +3,11 @@
 #include "CoffeeEngine/IO/Resource.h"
 #include "CoffeeEngine/IO/ResourceLoader.h"
 #include "CoffeeEngine/IO/ResourceRegistry.h"
+#include "CoffeeEngine/Renderer/BindlessTexture.h"
+#include "CoffeeEngine/Renderer/Renderer.h"
+#include "CoffeeEngine/Renderer/ShaderVariantCache.h"
 #include "CoffeeEngine/Renderer/Texture.h"
+#include "CoffeeEngine/Renderer/TextureArrayPool.h"
 #include "CoffeeEngine/Embedded/StandardShader.inl"
 #include <cstdint>
 #include <glm/fwd.hpp>
@@ -35,11 +39,6 @@ namespace Coffee {
         m_MaterialTextureFlags.hasAlbedo = true;
 
         m_Shader = s_StandardShader;
-
-        m_Shader->Bind();
-        m_MaterialTextures.albedo->Bind(0);
-        m_Shader->setInt("material.albedoMap", 0);
-        m_Shader->Unbind();
     }
 
     Material::Material(const std::string& name, Ref<Shader> shader) : m_Shader(shader), Resource(ResourceType::Material) {}
@@ -71,15 +70,6 @@ namespace Coffee {
         if(m_MaterialTextureFlags.hasEmissive)m_MaterialProperties.emissive = glm::vec3(1.0f);
 
         m_Shader = s_StandardShader;
-
-        m_Shader->Bind();
-        m_Shader->setInt("material.albedoMap", 0);
-        m_Shader->setInt("material.normalMap", 1);
-        m_Shader->setInt("material.metallicMap", 2);
-        m_Shader->setInt("material.roughnessMap", 3);
-        m_Shader->setInt("material.aoMap", 4);
-        m_Shader->setInt("material.emissiveMap", 5);
-        m_Shader->Unbind();
     }
 
     void Material::Use()
@@ -94,30 +84,58 @@ namespace Coffee {
         m_MaterialTextureFlags.hasAO = (m_MaterialTextures.ao != nullptr);
         m_MaterialTextureFlags.hasEmissive = (m_MaterialTextures.emissive != nullptr);
 
-        m_Shader->Bind();
+        uint32_t features = m_MaterialTextureFlags.GetShaderFeatures();
+
+        // Only the standard shader implements the bindless and texture array paths
+        if(m_Shader == s_StandardShader)
+        {
+            const RenderSettings& settings = Renderer::GetRenderSettings();
+
+            if(settings.BindlessTextures && BindlessTexture::IsSupported())
+                features |= ShaderFeatureBindless;
+            else if(settings.TextureArrays)
+                features |= ShaderFeatureTextureArray;
+        }
+
+        // Select the shader permutation that matches the bound textures
+        m_ShaderVariant = ShaderVariantCache::Get(m_Shader, features);
+        m_ShaderFeatures = features;
+
+        m_ShaderVariant->Bind();
 
         // Bind Textures
-        if(m_MaterialTextureFlags.hasAlbedo)m_MaterialTextures.albedo->Bind(0);
-        if(m_MaterialTextureFlags.hasNormal)m_MaterialTextures.normal->Bind(1);
-        if(m_MaterialTextureFlags.hasMetallic)m_MaterialTextures.metallic->Bind(2);
-        if(m_MaterialTextureFlags.hasRoughness)m_MaterialTextures.roughness->Bind(3);
-        if(m_MaterialTextureFlags.hasAO)m_MaterialTextures.ao->Bind(4);
-        if(m_MaterialTextureFlags.hasEmissive)m_MaterialTextures.emissive->Bind(5);
+        if(m_MaterialTextureFlags.hasAlbedo)BindTexture(m_MaterialTextures.albedo, 0, "albedoMap", "albedoMapLayer", features);
+        if(m_MaterialTextureFlags.hasNormal)BindTexture(m_MaterialTextures.normal, 1, "normalMap", "normalMapLayer", features);
+        if(m_MaterialTextureFlags.hasMetallic)BindTexture(m_MaterialTextures.metallic, 2, "metallicMap", "metallicMapLayer", features);
+        if(m_MaterialTextureFlags.hasRoughness)BindTexture(m_MaterialTextures.roughness, 3, "roughnessMap", "roughnessMapLayer", features);
+        if(m_MaterialTextureFlags.hasAO)BindTexture(m_MaterialTextures.ao, 4, "aoMap", "aoMapLayer", features);
+        if(m_MaterialTextureFlags.hasEmissive)BindTexture(m_MaterialTextures.emissive, 5, "emissiveMap", "emissiveMapLayer", features);
 
         // Set Material Properties
-        m_Shader->setVec4("material.color", m_MaterialProperties.color);
-        m_Shader->setFloat("material.metallic", m_MaterialProperties.metallic);
-        m_Shader->setFloat("material.roughness", m_MaterialProperties.roughness);
-        m_Shader->setFloat("material.ao", m_MaterialProperties.ao);
-        m_Shader->setVec3("material.emissive", m_MaterialProperties.emissive);
-
-        // Set Material Texture Flags
-        m_Shader->setInt("material.hasAlbedo", m_MaterialTextureFlags.hasAlbedo);
-        m_Shader->setInt("material.hasNormal", m_MaterialTextureFlags.hasNormal);
-        m_Shader->setInt("material.hasMetallic", m_MaterialTextureFlags.hasMetallic);
-        m_Shader->setInt("material.hasRoughness", m_MaterialTextureFlags.hasRoughness);
-        m_Shader->setInt("material.hasAO", m_MaterialTextureFlags.hasAO);
-        m_Shader->setInt("material.hasEmissive", m_MaterialTextureFlags.hasEmissive);
+        m_ShaderVariant->setVec4("material.color", m_MaterialProperties.color);
+        m_ShaderVariant->setFloat("material.metallic", m_MaterialProperties.metallic);
+        m_ShaderVariant->setFloat("material.roughness", m_MaterialProperties.roughness);
+        m_ShaderVariant->setFloat("material.ao", m_MaterialProperties.ao);
+        m_ShaderVariant->setVec3("material.emissive", m_MaterialProperties.emissive);
+    }
+
+    void Material::BindTexture(const Ref<Texture2D>& texture, uint32_t slot, const char* name, const char* layerName, uint32_t features)
+    {
+        if(features & ShaderFeatureBindless)
+        {
+            // No texture unit is touched, the handle is just a uniform of the program
+            m_ShaderVariant->setTextureHandle(name, texture->GetBindlessHandle());
+        }
+        else if(features & ShaderFeatureTextureArray)
+        {
+            TextureArraySlot arraySlot = TextureArrayPool::Acquire(*texture);
+            TextureArrayPool::Bind(slot, arraySlot.ArrayID);
+            m_ShaderVariant->setInt(layerName, arraySlot.Layer);
+        }
+        else
+        {
+            texture->Bind(slot);
+        }
     }
 
     Ref<Material> Material::Create(const std::string& name, MaterialTextures* materialTextures)
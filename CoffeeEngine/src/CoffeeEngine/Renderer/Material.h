@@ -110,6 +110,22 @@ namespace Coffee {
         bool hasAO = false; ///< Whether the material has an ambient occlusion texture.
         bool hasEmissive = false; ///< Whether the material has an emissive texture.
 
+        /**
+         * @brief Converts the texture flags into a ShaderFeature bitmask.
+         * @return The ShaderFeature bitmask used to select the shader permutation.
+         */
+        uint32_t GetShaderFeatures() const
+        {
+            uint32_t features = ShaderFeatureNone;
+            if(hasAlbedo) features |= ShaderFeatureAlbedoMap;
+            if(hasNormal) features |= ShaderFeatureNormalMap;
+            if(hasMetallic) features |= ShaderFeatureMetallicMap;
+            if(hasRoughness) features |= ShaderFeatureRoughnessMap;
+            if(hasAO) features |= ShaderFeatureAOMap;
+            if(hasEmissive) features |= ShaderFeatureEmissiveMap;
+            return features;
+        }
+
         private:
             friend class cereal::access;
 
@@ -168,6 +184,18 @@ namespace Coffee {
          */
         Ref<Shader> GetShader() { return m_Shader; }
 
+        /**
+         * @brief Gets the shader permutation selected by the last call to Use().
+         * @return A reference to the shader permutation.
+         */
+        const Ref<Shader>& GetShaderVariant() { return m_ShaderVariant ? m_ShaderVariant : m_Shader; }
+
+        /**
+         * @brief Gets the ShaderFeature bitmask of the permutation selected by the last call to Use().
+         * @return The ShaderFeature bitmask.
+         */
+        uint32_t GetShaderFeatures() const { return m_ShaderFeatures; }
+
         MaterialTextures& GetMaterialTextures() { return m_MaterialTextures; }
         MaterialProperties& GetMaterialProperties() { return m_MaterialProperties; }
 
@@ -175,7 +203,17 @@ namespace Coffee {
         static Ref<Material> Create(const std::string& name = "", MaterialTextures* materialTextures = nullptr);
 
         private:
-        
+
+        /**
+         * @brief Binds a material texture using the path selected by the shader features.
+         * @param texture The texture to bind.
+         * @param slot The texture unit used by the non bindless paths.
+         * @param name The name of the sampler uniform.
+         * @param layerName The name of the layer uniform used by the texture array path.
+         * @param features The ShaderFeature bitmask of the bound permutation.
+         */
+        void BindTexture(const Ref<Texture2D>& texture, uint32_t slot, const char* name, const char* layerName, uint32_t features);
+
         friend class cereal::access;
 
         template<class Archive>
@@ -217,6 +255,8 @@ namespace Coffee {
         MaterialProperties m_MaterialProperties; ///< The properties of the material.
         MaterialRenderSettings m_MaterialRenderSettings; ///< The render settings of the material.
         Ref<Shader> m_Shader; ///< The shader used with the material.
+        Ref<Shader> m_ShaderVariant; ///< The permutation of the shader matching the material textures.
+        uint32_t m_ShaderFeatures = 0; ///< The ShaderFeature bitmask of m_ShaderVariant.
         static Ref<Texture2D> s_MissingTexture; ///< The texture to use when a texture is missing.
         static Ref<Shader> s_StandardShader; ///< The standard shader to use with the material. (When the material be a base class of PBRMaterial and ShaderMaterial this should be moved to PBRMaterial)
     };
@@ -0,0 +1,407 @@
+#include "OcclusionCuller.h"
+
+#include "CoffeeEngine/Core/JobSystem.h"
+#include "CoffeeEngine/Core/Metrics.h"
+#include "CoffeeEngine/Math/Frustum.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <tracy/Tracy.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define COFFEE_OCCLUSION_SSE 1
+    #include <emmintrin.h>
+#else
+    #define COFFEE_OCCLUSION_SSE 0
+#endif
+
+namespace Coffee {
+
+    static_assert(OcclusionCuller::Width % 4 == 0, "The rasterizer writes four pixels at a time");
+    static_assert(OcclusionCuller::Height % OcclusionCuller::BandHeight == 0, "The bands have to cover the depth buffer");
+    static_assert((OcclusionCuller::Width & (OcclusionCuller::Width - 1)) == 0 && (OcclusionCuller::Height & (OcclusionCuller::Height - 1)) == 0,
+                  "Every level of the pyramid halves the previous one");
+
+    static constexpr float MinClipW = 1e-6f; // Points closer to the camera plane are not projected
+
+    static bool s_Enabled = true;
+
+    OcclusionCuller::OcclusionCuller()
+    {
+        uint32_t width = Width, height = Height;
+        while(true)
+        {
+            DepthLevel& level = m_Levels.emplace_back();
+            level.Width = width;
+            level.Height = height;
+            level.Max.assign((size_t)width * height, 1.0f);
+            if(m_Levels.size() > 1)
+                level.Min.assign((size_t)width * height, 1.0f);
+
+            if(width == 1 || height == 1)
+                break;
+
+            width /= 2;
+            height /= 2;
+        }
+    }
+
+    void OcclusionCuller::AddOccluder(const Ref<Mesh>& mesh, const glm::mat4& transform)
+    {
+        if(!mesh || mesh->GetIndices().empty())
+            return;
+
+        Occluder& occluder = m_Occluders.emplace_back();
+
+        occluder.Vertices.reserve(mesh->GetVertices().size());
+        for(const Vertex& vertex : mesh->GetVertices())
+        {
+            occluder.Vertices.push_back(glm::vec3(transform * glm::vec4(vertex.Position, 1.0f)));
+        }
+
+        occluder.Indices = mesh->GetIndices();
+        occluder.Bounds = mesh->GetAABB().CalculateTransformedAABB(transform);
+    }
+
+    void OcclusionCuller::ClearOccluders()
+    {
+        m_Occluders.clear();
+        m_Triangles.clear();
+        m_HasDepth = false;
+    }
+
+    void OcclusionCuller::SetupTriangles(const Occluder& occluder, std::vector<ScreenTriangle>& triangles) const
+    {
+        triangles.clear();
+
+        // x and y in pixels, z the normalized device depth, w 0 for the vertices behind the camera
+        std::vector<glm::vec4> screen(occluder.Vertices.size());
+        for(size_t i = 0; i < occluder.Vertices.size(); i++)
+        {
+            glm::vec4 clip = m_ViewProjection * glm::vec4(occluder.Vertices[i], 1.0f);
+            if(clip.w <= MinClipW)
+            {
+                screen[i] = glm::vec4(0.0f);
+                continue;
+            }
+
+            glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            screen[i] = glm::vec4((ndc.x * 0.5f + 0.5f) * Width, (ndc.y * 0.5f + 0.5f) * Height, ndc.z, 1.0f);
+        }
+
+        for(size_t i = 0; i + 2 < occluder.Indices.size(); i += 3)
+        {
+            glm::vec4 a = screen[occluder.Indices[i]];
+            glm::vec4 b = screen[occluder.Indices[i + 1]];
+            glm::vec4 c = screen[occluder.Indices[i + 2]];
+
+            // Triangles crossing the camera plane are not clipped, only skipped, which hides less
+            if(a.w == 0.0f || b.w == 0.0f || c.w == 0.0f)
+                continue;
+
+            float area = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+            if(std::abs(area) < 1e-8f)
+                continue;
+
+            // Both faces are rasterized, the nearest depth wins anyway
+            if(area < 0.0f)
+            {
+                std::swap(b, c);
+                area = -area;
+            }
+
+            ScreenTriangle triangle;
+            triangle.MinX = std::max(0, (int)std::floor(std::min({ a.x, b.x, c.x })));
+            triangle.MinY = std::max(0, (int)std::floor(std::min({ a.y, b.y, c.y })));
+            triangle.MaxX = std::min((int)Width - 1, (int)std::ceil(std::max({ a.x, b.x, c.x })));
+            triangle.MaxY = std::min((int)Height - 1, (int)std::ceil(std::max({ a.y, b.y, c.y })));
+
+            if(triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+                continue;
+
+            auto edge = [](const glm::vec4& from, const glm::vec4& to) {
+                float edgeA = from.y - to.y;
+                float edgeB = to.x - from.x;
+                return glm::vec3(edgeA, edgeB, -(edgeA * from.x + edgeB * from.y));
+            };
+
+            triangle.Edges[0] = edge(a, b);
+            triangle.Edges[1] = edge(b, c);
+            triangle.Edges[2] = edge(c, a);
+
+            float dzdx = ((b.z - a.z) * (c.y - a.y) - (c.z - a.z) * (b.y - a.y)) / area;
+            float dzdy = ((c.z - a.z) * (b.x - a.x) - (b.z - a.z) * (c.x - a.x)) / area;
+            triangle.Depth = glm::vec3(a.z - dzdx * a.x - dzdy * a.y, dzdx, dzdy);
+
+            triangles.push_back(triangle);
+        }
+    }
+
+    void OcclusionCuller::RasterizeBand(uint32_t firstRow, uint32_t endRow)
+    {
+        float* depth = m_Levels[0].Max.data();
+
+        for(const std::vector<ScreenTriangle>& triangles : m_Triangles)
+        {
+            for(const ScreenTriangle& triangle : triangles)
+            {
+                int minY = std::max(triangle.MinY, (int)firstRow);
+                int maxY = std::min(triangle.MaxY, (int)endRow - 1);
+
+#if COFFEE_OCCLUSION_SSE
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+                const __m128 edgeA0 = _mm_set1_ps(triangle.Edges[0].x);
+                const __m128 edgeA1 = _mm_set1_ps(triangle.Edges[1].x);
+                const __m128 edgeA2 = _mm_set1_ps(triangle.Edges[2].x);
+                const __m128 depthX = _mm_set1_ps(triangle.Depth.y);
+                const int startX = triangle.MinX & ~3;
+#endif
+
+                for(int y = minY; y <= maxY; y++)
+                {
+                    const float pixelY = (float)y + 0.5f;
+                    float* row = depth + (size_t)y * Width;
+
+#if COFFEE_OCCLUSION_SSE
+                    // The terms that only depend on the row
+                    const __m128 edgeRow0 = _mm_set1_ps(triangle.Edges[0].y * pixelY + triangle.Edges[0].z);
+                    const __m128 edgeRow1 = _mm_set1_ps(triangle.Edges[1].y * pixelY + triangle.Edges[1].z);
+                    const __m128 edgeRow2 = _mm_set1_ps(triangle.Edges[2].y * pixelY + triangle.Edges[2].z);
+                    const __m128 depthRow = _mm_set1_ps(triangle.Depth.x + triangle.Depth.z * pixelY);
+
+                    for(int x = startX; x <= triangle.MaxX; x += 4)
+                    {
+                        __m128 pixelX = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+
+                        __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA0, pixelX), edgeRow0), zero);
+                        inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA1, pixelX), edgeRow1), zero));
+                        inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA2, pixelX), edgeRow2), zero));
+
+                        if(_mm_movemask_ps(inside) == 0)
+                            continue;
+
+                        __m128 current = _mm_loadu_ps(row + x);
+                        __m128 nearest = _mm_min_ps(current, _mm_add_ps(_mm_mul_ps(depthX, pixelX), depthRow));
+                        _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+                    }
+#else
+                    for(int x = triangle.MinX; x <= triangle.MaxX; x++)
+                    {
+                        const float pixelX = (float)x + 0.5f;
+
+                        bool inside = true;
+                        for(const glm::vec3& edge : triangle.Edges)
+                        {
+                            inside &= edge.x * pixelX + edge.y * pixelY + edge.z >= 0.0f;
+                        }
+
+                        if(inside)
+                            row[x] = std::min(row[x], triangle.Depth.x + triangle.Depth.y * pixelX + triangle.Depth.z * pixelY);
+                    }
+#endif
+                }
+            }
+        }
+    }
+
+    void OcclusionCuller::BuildPyramid()
+    {
+        ZoneScoped;
+
+        for(size_t i = 1; i < m_Levels.size(); i++)
+        {
+            const DepthLevel& source = m_Levels[i - 1];
+            const std::vector<float>& sourceMin = i == 1 ? source.Max : source.Min;
+            DepthLevel& level = m_Levels[i];
+
+            for(uint32_t y = 0; y < level.Height; y++)
+            {
+                const size_t top = (size_t)(y * 2) * source.Width;
+                const size_t bottom = top + source.Width;
+
+                for(uint32_t x = 0; x < level.Width; x++)
+                {
+                    const size_t left = x * 2;
+
+                    level.Min[(size_t)y * level.Width + x] = std::min({ sourceMin[top + left], sourceMin[top + left + 1], sourceMin[bottom + left], sourceMin[bottom + left + 1] });
+                    level.Max[(size_t)y * level.Width + x] = std::max({ source.Max[top + left], source.Max[top + left + 1], source.Max[bottom + left], source.Max[bottom + left + 1] });
+                }
+            }
+        }
+    }
+
+    void OcclusionCuller::Rasterize(const glm::mat4& viewProjection)
+    {
+        ZoneScoped;
+
+        static Metric& trianglesMetric = Metrics::Gauge("Occluder Triangles");
+
+        m_ViewProjection = viewProjection;
+        m_HasDepth = false;
+
+        if(!s_Enabled || m_Occluders.empty())
+        {
+            trianglesMetric.Set(0.0);
+            return;
+        }
+
+        // The occluders outside the frustum are not set up
+        Frustum frustum(viewProjection);
+        m_Triangles.resize(m_Occluders.size());
+        JobSystem::ParallelFor("OcclusionCuller::Setup", m_Occluders.size(), 8, [this, &frustum](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+            {
+                if(frustum.Contains(m_Occluders[i].Bounds))
+                    SetupTriangles(m_Occluders[i], m_Triangles[i]);
+                else
+                    m_Triangles[i].clear();
+            }
+        });
+
+        size_t triangleCount = 0;
+        for(const std::vector<ScreenTriangle>& triangles : m_Triangles)
+        {
+            triangleCount += triangles.size();
+        }
+        trianglesMetric.Set((double)triangleCount);
+
+        if(triangleCount == 0)
+            return;
+
+        std::fill(m_Levels[0].Max.begin(), m_Levels[0].Max.end(), 1.0f);
+
+        // Every band owns its rows of the depth buffer, so the bands need no synchronization
+        JobSystem::ParallelFor("OcclusionCuller::Rasterize", Height / BandHeight, 1, [this](size_t begin, size_t end) {
+            for(size_t band = begin; band < end; band++)
+            {
+                RasterizeBand((uint32_t)band * BandHeight, (uint32_t)(band + 1) * BandHeight);
+            }
+        });
+
+        BuildPyramid();
+
+        m_HasDepth = true;
+    }
+
+    bool OcclusionCuller::IsVisible(const AABB& aabb) const
+    {
+        if(!m_HasDepth)
+            return true;
+
+        glm::vec2 screenMin(std::numeric_limits<float>::max());
+        glm::vec2 screenMax(std::numeric_limits<float>::lowest());
+        float nearestDepth = std::numeric_limits<float>::max();
+
+        for(int i = 0; i < 8; i++)
+        {
+            glm::vec3 corner((i & 1) ? aabb.max.x : aabb.min.x, (i & 2) ? aabb.max.y : aabb.min.y, (i & 4) ? aabb.max.z : aabb.min.z);
+            glm::vec4 clip = m_ViewProjection * glm::vec4(corner, 1.0f);
+
+            // The box reaches the camera, nothing can be in front of it
+            if(clip.w <= MinClipW)
+                return true;
+
+            glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            glm::vec2 pixel((ndc.x * 0.5f + 0.5f) * Width, (ndc.y * 0.5f + 0.5f) * Height);
+
+            screenMin = glm::min(screenMin, pixel);
+            screenMax = glm::max(screenMax, pixel);
+            nearestDepth = std::min(nearestDepth, ndc.z);
+        }
+
+        // Only the part on the screen can be seen, the rest is left to the frustum culling
+        int minX = std::max(0, (int)std::floor(screenMin.x));
+        int minY = std::max(0, (int)std::floor(screenMin.y));
+        int maxX = std::min((int)Width - 1, (int)std::floor(screenMax.x));
+        int maxY = std::min((int)Height - 1, (int)std::floor(screenMax.y));
+
+        if(minX > maxX || minY > maxY)
+            return true;
+
+        // Start at the finest level where the box spans at most two texels on each axis
+        size_t level = 0;
+        while(level + 1 < m_Levels.size() && ((maxX >> level) - (minX >> level) > 1 || (maxY >> level) - (minY >> level) > 1))
+        {
+            level++;
+        }
+
+        while(true)
+        {
+            const DepthLevel& depth = m_Levels[level];
+            const std::vector<float>& minDepths = level == 0 ? depth.Max : depth.Min;
+
+            int texelMinX = minX >> level, texelMaxX = maxX >> level;
+            int texelMinY = minY >> level, texelMaxY = maxY >> level;
+
+            if((uint32_t)((texelMaxX - texelMinX + 1) * (texelMaxY - texelMinY + 1)) > MaxTestedTexels)
+                return true;
+
+            float farthestOccluder = std::numeric_limits<float>::lowest();
+            float nearestOccluder = std::numeric_limits<float>::max();
+            for(int y = texelMinY; y <= texelMaxY; y++)
+            {
+                for(int x = texelMinX; x <= texelMaxX; x++)
+                {
+                    size_t index = (size_t)y * depth.Width + x;
+                    farthestOccluder = std::max(farthestOccluder, depth.Max[index]);
+                    nearestOccluder = std::min(nearestOccluder, minDepths[index]);
+                }
+            }
+
+            if(nearestDepth > farthestOccluder)
+                return false;
+
+            // In front of every occluder of the region, or there is no finer level to look at
+            if(nearestDepth <= nearestOccluder || level == 0)
+                return true;
+
+            level--;
+        }
+    }
+
+    void OcclusionCuller::TestVisibility(const AABB* bounds, size_t count, uint8_t* visible)
+    {
+        ZoneScoped;
+
+        static Metric& testedMetric = Metrics::Counter("Occlusion Tested");
+        static Metric& occludedMetric = Metrics::Counter("Occlusion Culled");
+
+        std::atomic<uint32_t> occluded = 0;
+
+        if(m_HasDepth)
+        {
+            JobSystem::ParallelFor("OcclusionCuller::Test", count, 256, [this, bounds, visible, &occluded](size_t begin, size_t end) {
+                uint32_t batchOccluded = 0;
+                for(size_t i = begin; i < end; i++)
+                {
+                    visible[i] = IsVisible(bounds[i]) ? 1 : 0;
+                    batchOccluded += visible[i] ? 0 : 1;
+                }
+                occluded.fetch_add(batchOccluded, std::memory_order_relaxed);
+            });
+        }
+        else
+        {
+            std::fill(visible, visible + count, (uint8_t)1);
+        }
+
+        m_OccludedCount = occluded.load();
+
+        testedMetric.Add((double)count);
+        occludedMetric.Add((double)m_OccludedCount);
+    }
+
+    void OcclusionCuller::SetEnabled(bool enabled)
+    {
+        s_Enabled = enabled;
+    }
+
+    bool OcclusionCuller::IsEnabled()
+    {
+        return s_Enabled;
+    }
+
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Math/BoundingBox.h"
+#include "CoffeeEngine/Renderer/Mesh.h"
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    /**
+     * @brief Software occlusion culling against a hierarchical depth buffer, on the CPU.
+     *
+     * The occluder meshes are rasterized into a low resolution depth buffer, in horizontal bands on the
+     * workers, four pixels at a time with SSE when available. A pyramid keeping the minimum and maximum
+     * depth of every 2x2 block is built from it. A box is occluded when its nearest point is behind the
+     * farthest occluder depth of the pyramid texels it covers.
+     *
+     * Nothing here touches the GPU, so the culler works with any renderer backend. The test is
+     * conservative except along the occluder edges, where the depth is sampled at the pixel centers.
+     */
+    class OcclusionCuller
+    {
+    public:
+        static constexpr uint32_t Width = 256; ///< Width of the depth buffer, a multiple of 4.
+        static constexpr uint32_t Height = 128; ///< Height of the depth buffer, a multiple of the band height.
+        static constexpr uint32_t BandHeight = 16; ///< Rows rasterized by each job.
+        static constexpr uint32_t MaxTestedTexels = 64; ///< Texels a box is tested against before it is considered visible.
+
+        /**
+         * @brief Constructor for OcclusionCuller, allocates the depth pyramid.
+         */
+        OcclusionCuller();
+
+        /**
+         * @brief Adds an occluder. Its vertices are transformed to world space once, it must not move.
+         * @param mesh The mesh.
+         * @param transform The world transform of the mesh.
+         */
+        void AddOccluder(const Ref<Mesh>& mesh, const glm::mat4& transform);
+
+        /**
+         * @brief Removes every occluder.
+         */
+        void ClearOccluders();
+
+        /**
+         * @brief Rasterizes the occluders seen from a camera and builds the depth pyramid.
+         * @param viewProjection The projection matrix times the view matrix of the camera.
+         */
+        void Rasterize(const glm::mat4& viewProjection);
+
+        /**
+         * @brief Tests a box against the depth pyramid of the last Rasterize.
+         * @param aabb The box, in world space.
+         * @return False if the box is hidden behind the occluders.
+         */
+        bool IsVisible(const AABB& aabb) const;
+
+        /**
+         * @brief Tests boxes against the depth pyramid on the workers, and counts the occluded ones.
+         * @param bounds The boxes, in world space.
+         * @param count The number of boxes.
+         * @param visible Set to 1 for the visible boxes and 0 for the occluded ones.
+         */
+        void TestVisibility(const AABB* bounds, size_t count, uint8_t* visible);
+
+        /**
+         * @brief Gets the depth buffer of the last Rasterize, for debugging.
+         * @return Width * Height depths, rows from the bottom of the screen, 1 where there is no occluder.
+         */
+        const std::vector<float>& GetDepthBuffer() const { return m_Levels[0].Max; }
+
+        /**
+         * @brief Gets the number of boxes occluded by the last TestVisibility.
+         * @return The number of occluded boxes.
+         */
+        uint32_t GetOccludedCount() const { return m_OccludedCount; }
+
+        /**
+         * @brief Gets the number of occluders.
+         * @return The number of occluders.
+         */
+        size_t GetOccluderCount() const { return m_Occluders.size(); }
+
+        /**
+         * @brief Enables or disables the occlusion culling of every scene.
+         * @param enabled False to consider every box visible.
+         */
+        static void SetEnabled(bool enabled);
+
+        /**
+         * @brief Checks if the occlusion culling is enabled.
+         * @return True if the occlusion culling is enabled.
+         */
+        static bool IsEnabled();
+
+    private:
+        struct Occluder
+        {
+            std::vector<glm::vec3> Vertices; ///< The vertices, in world space.
+            std::vector<uint32_t> Indices;
+            AABB Bounds; ///< The bounds, in world space.
+        };
+
+        // A triangle in screen space, set up for the rasterizer
+        struct ScreenTriangle
+        {
+            glm::vec3 Edges[3]; ///< Edge functions (A, B, C), A * x + B * y + C is positive inside.
+            glm::vec3 Depth; ///< Depth plane, z = Depth.x + Depth.y * x + Depth.z * y.
+            int MinX, MinY, MaxX, MaxY; ///< Pixels covered by the triangle bounds.
+        };
+
+        struct DepthLevel
+        {
+            uint32_t Width = 0;
+            uint32_t Height = 0;
+            std::vector<float> Min; ///< Nearest depth of the texels of the level below. Empty on level 0, where both are the depth.
+            std::vector<float> Max; ///< Farthest depth of the texels of the level below.
+        };
+
+        void SetupTriangles(const Occluder& occluder, std::vector<ScreenTriangle>& triangles) const;
+        void RasterizeBand(uint32_t firstRow, uint32_t endRow);
+        void BuildPyramid();
+
+    private:
+        std::vector<Occluder> m_Occluders;
+        std::vector<std::vector<ScreenTriangle>> m_Triangles; ///< The triangles of every occluder, for the current frame.
+        std::vector<DepthLevel> m_Levels; ///< The depth pyramid, level 0 is the depth buffer.
+        glm::mat4 m_ViewProjection = glm::mat4(1.0f);
+        bool m_HasDepth = false; ///< At least one occluder was rasterized.
+        uint32_t m_OccludedCount = 0;
+    };
+
+    /** @} */
+}
@@ -1,28 +1,37 @@
 #include "Renderer.h"
+#include "CoffeeEngine/Core/MemoryProfiler.h"
+#include "CoffeeEngine/Core/Metrics.h"
 #include "CoffeeEngine/Renderer/Material.h"
 #include "CoffeeEngine/Scene/PrimitiveMesh.h"
 #include "CoffeeEngine/Renderer/DebugRenderer.h"
 #include "CoffeeEngine/Renderer/EditorCamera.h"
+#include "CoffeeEngine/Renderer/FrameCapture.h"
 #include "CoffeeEngine/Renderer/Framebuffer.h"
+#include "CoffeeEngine/Renderer/FramePacket.h"
 #include "CoffeeEngine/Renderer/Mesh.h"
 #include "CoffeeEngine/Renderer/RendererAPI.h"
 #include "CoffeeEngine/Renderer/Shader.h"
 #include "CoffeeEngine/Renderer/Texture.h"
+#include "CoffeeEngine/Renderer/TextureArrayPool.h"
 #include "CoffeeEngine/Renderer/UniformBuffer.h"
 
 #include "CoffeeEngine/Embedded/ToneMappingShader.inl"
 #include "CoffeeEngine/Embedded/FinalPassShader.inl"
 #include "CoffeeEngine/Embedded/MissingShader.inl"
 
+#include <algorithm>
 #include <cstdint>
 #include <glm/fwd.hpp>
 #include <glm/matrix.hpp>
+#include <numeric>
 #include <tracy/Tracy.hpp>
 
 namespace Coffee {
 
-    static bool s_viewportResized = false;
     static uint32_t s_viewportWidth = 0, s_viewportHeight = 0;
+    static uint32_t s_FramebufferWidth = 1280, s_FramebufferHeight = 720;
+    static size_t s_LastQueueSize = 0;
+    static FramePacket s_FramePacket; // Reused every frame so building the packet does not allocate
 
     RendererData Renderer::s_RendererData;
     RendererStats Renderer::s_Stats;
@@ -46,6 +55,8 @@ namespace Coffee {
 
     void Renderer::Init()
     {
+        COFFEE_MEMORY_TAG(Renderer);
+
         /*std::vector<std::filesystem::path> paths = {
             "assets/textures/skybox/right.jpg",
             "assets/textures/skybox/left.jpg",
@@ -65,6 +76,7 @@ namespace Coffee {
         ZoneScoped;
 
         RendererAPI::Init();
+        GpuProfiler::Init();
         DebugRenderer::Init();
 
         s_RendererData.CameraUniformBuffer = UniformBuffer::Create(sizeof(RendererData::CameraData), 0);
@@ -90,48 +102,93 @@ namespace Coffee {
 
     void Renderer::Shutdown()
     {
+        GpuProfiler::Shutdown();
+
+        // The queue lives in the frame arenas, which are freed after the renderer
+        s_RendererData.renderQueue = FrameVector<RenderCommand>();
     }
 
     void Renderer::BeginScene(EditorCamera& camera)
     {
-        s_Stats.DrawCalls = 0;
-        s_Stats.VertexCount = 0;
-        s_Stats.IndexCount = 0;
+        BeginSceneCamera(camera.GetViewMatrix(), camera.GetProjection(), camera.GetPosition());
+    }
 
-        //I think if a render queue is implemented this is not necessary. The OnResize would work.
-        if(s_viewportResized)
-        {
-            ResizeFramebuffers();
-            s_viewportResized = false;
-        }
+    void Renderer::BeginScene(Camera& camera, const glm::mat4& transform)
+    {
+        // This resize the camera to the viewport size. Think how to manage this in a better way :p
+        camera.SetViewportSize(s_viewportWidth, s_viewportHeight);
 
-        s_RendererData.cameraData.view = camera.GetViewMatrix();
-        s_RendererData.cameraData.projection = camera.GetProjection();
-        s_RendererData.cameraData.position = camera.GetPosition();
-        s_RendererData.CameraUniformBuffer->SetData(&s_RendererData.cameraData, sizeof(RendererData::CameraData));
+        BeginSceneCamera(glm::inverse(transform), camera.GetProjection(), transform[3]);
+    }
 
+    void Renderer::BeginScene(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position)
+    {
+        BeginSceneCamera(view, projection, position);
+    }
+
+    // The camera is uploaded when the frame packet is rendered, BeginScene only records it
+    void Renderer::BeginSceneCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position)
+    {
+        s_RendererData.cameraData.view = view;
+        s_RendererData.cameraData.projection = projection;
+        s_RendererData.cameraData.position = position;
+
+        ResetFrameData();
+    }
+
+    void Renderer::ResetFrameData()
+    {
         s_RendererData.renderData.lightCount = 0;
+
+        // The queue of the last scene points into an older frame arena, start from fresh storage
+        s_RendererData.renderQueue = FrameVector<RenderCommand>();
+        s_RendererData.renderQueue.reserve(s_LastQueueSize);
     }
 
-    void Renderer::BeginScene(Camera& camera, const glm::mat4& transform)
+    void Renderer::EndScene()
     {
+        ZoneScoped;
+        COFFEE_MEMORY_TAG(Renderer);
+
+        FramePacket& packet = s_FramePacket;
+        packet.Camera = s_RendererData.cameraData;
+        packet.Lights = s_RendererData.renderData;
+        packet.Settings = s_RenderSettings;
+        packet.ViewportWidth = s_viewportWidth;
+        packet.ViewportHeight = s_viewportHeight;
+
+        // The next scene reserves the same capacity
+        s_LastQueueSize = s_RendererData.renderQueue.size();
+        packet.Commands = std::move(s_RendererData.renderQueue);
+        s_RendererData.renderQueue = FrameVector<RenderCommand>();
+
+        RenderPacket(packet);
+
+        // The queue points into a frame arena that will be reused, the references to the meshes and materials are released
+        packet.Commands = FrameVector<RenderCommand>();
+    }
+
+    void Renderer::RenderPacket(const FramePacket& packet)
+    {
+        ZoneScoped;
+        COFFEE_MEMORY_TAG(Renderer);
+
         s_Stats.DrawCalls = 0;
         s_Stats.VertexCount = 0;
         s_Stats.IndexCount = 0;
 
-        // This resize the camera to the viewport size. Think how to manage this in a better way :p
-        camera.SetViewportSize(s_viewportWidth, s_viewportHeight);
+        if(packet.ViewportWidth > 0 && packet.ViewportHeight > 0 &&
+           (packet.ViewportWidth != s_FramebufferWidth || packet.ViewportHeight != s_FramebufferHeight))
+        {
+            ResizeFramebuffers(packet.ViewportWidth, packet.ViewportHeight);
+        }
 
-        s_RendererData.cameraData.view = glm::inverse(transform);
-        s_RendererData.cameraData.projection = camera.GetProjection();
-        s_RendererData.cameraData.position = transform[3];
-        s_RendererData.CameraUniformBuffer->SetData(&s_RendererData.cameraData, sizeof(RendererData::CameraData));
+        FrameCapture::BeginFrame(packet);
+        GpuProfiler::BeginFrame();
+        s_Stats.GpuTimings = GpuProfiler::GetLastTimings();
 
-        s_RendererData.renderData.lightCount = 0;
-    }
+        s_RendererData.CameraUniformBuffer->SetData(&packet.Camera, sizeof(RendererData::CameraData));
 
-    void Renderer::EndScene()
-    {
         s_MainFramebuffer->Bind();
         s_MainFramebuffer->SetDrawBuffers({0, 1});
 
@@ -141,12 +198,24 @@ namespace Coffee {
         // Currently this is done also in the runtime, this should be done only in editor mode
         s_EntityIDTexture->Clear({-1.0f,0.0f,0.0f,0.0f});
 
-        s_RendererData.RenderDataUniformBuffer->SetData(&s_RendererData.renderData, sizeof(RendererData::RenderData));
+        s_RendererData.RenderDataUniformBuffer->SetData(&packet.Lights, sizeof(RendererData::RenderData));
+        FrameCapture::RecordEvent(FrameCaptureEvent::Type::UniformBufferUpload, sizeof(RendererData::RenderData), glm::vec4(1.0f, 0.0f, 0.0f, 0.0f));
 
-        // Sort the render queue to minimize state changes
+        // The post-processing and skybox passes of the last frame bound their own textures
+        TextureArrayPool::ResetBindings();
 
-        for(const auto& command : s_RendererData.renderQueue)
+        GpuProfiler::BeginPass(GpuPass::Geometry);
+
+        // Grouping the draws by material saves shader and texture binds
+        FrameVector<uint32_t> drawOrder(packet.Commands.size());
+        std::iota(drawOrder.begin(), drawOrder.end(), 0);
+        std::stable_sort(drawOrder.begin(), drawOrder.end(), [&packet](uint32_t a, uint32_t b) {
+            return packet.Commands[a].material.get() < packet.Commands[b].material.get();
+        });
+
+        for(uint32_t index : drawOrder)
         {
+            const RenderCommand& command = packet.Commands[index];
             Material* material = command.material.get();
 
             if(material == nullptr)
@@ -156,14 +225,14 @@ namespace Coffee {
             
             material->Use();
 
-            const Ref<Shader>& shader = material->GetShader();
+            const Ref<Shader>& shader = material->GetShaderVariant();
 
             shader->Bind();
             shader->setMat4("model", command.transform);
             shader->setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(command.transform))));
 
             //REMOVE: This is for the first release of the engine it should be handled differently
-            shader->setBool("showNormals", s_RenderSettings.showNormals);
+            shader->setBool("showNormals", packet.Settings.showNormals);
 
             // Convert entityID to vec3
             uint32_t r = (command.entityID & 0x000000FF) >> 0;
@@ -173,6 +242,8 @@ namespace Coffee {
 
             shader->setVec3("entityID", entityIDVec3);
 
+            FrameCapture::RecordDraw(command, material->GetShaderFeatures());
+
             RendererAPI::DrawIndexed(command.mesh->GetVertexArray());
 
             s_Stats.DrawCalls++;
@@ -181,32 +252,44 @@ namespace Coffee {
             s_Stats.IndexCount += command.mesh->GetIndices().size();
         }
 
+        GpuProfiler::EndPass(GpuPass::Geometry);
+
         // Test drawing the skybox
-        RendererAPI::SetDepthMask(false);
-        s_SkyboxShader->Bind();
-        RendererAPI::DrawIndexed(s_SkyboxMesh->GetVertexArray());
-        RendererAPI::SetDepthMask(true);
+        {
+            GpuPassScope skyboxPass(GpuPass::Skybox);
+
+            RendererAPI::SetDepthMask(false);
+            s_SkyboxShader->Bind();
+            RendererAPI::DrawIndexed(s_SkyboxMesh->GetVertexArray());
+            RendererAPI::SetDepthMask(true);
+        }
 
-        if(s_RenderSettings.PostProcessing)
+        if(packet.Settings.PostProcessing)
         {
             //Render All the fancy effects :D
 
             //ToneMapping
+            GpuProfiler::BeginPass(GpuPass::ToneMapping);
+
             s_PostProcessingFramebuffer->Bind();
 
             s_ToneMappingShader->Bind();
             s_ToneMappingShader->setInt("screenTexture", 0);
-            s_ToneMappingShader->setFloat("exposure", s_RenderSettings.Exposure);
+            s_ToneMappingShader->setFloat("exposure", packet.Settings.Exposure);
             s_MainRenderTexture->Bind(0);
 
             RendererAPI::DrawIndexed(s_ScreenQuad->GetVertexArray());
 
             s_ToneMappingShader->Unbind();
 
+            GpuProfiler::EndPass(GpuPass::ToneMapping);
+
             //This has to be set because the s_ScreenQuad overwrites the depth buffer
             RendererAPI::SetDepthMask(false);
 
             //Final Pass
+            GpuProfiler::BeginPass(GpuPass::FinalPass);
+
             s_MainFramebuffer->Bind();
             s_MainFramebuffer->SetDrawBuffers({0});
             
@@ -218,17 +301,30 @@ namespace Coffee {
 
             s_FinalPassShader->Unbind();
 
+            GpuProfiler::EndPass(GpuPass::FinalPass);
+
             RendererAPI::SetDepthMask(true);
         }
 
-        DebugRenderer::Flush();
+        {
+            GpuPassScope debugPass(GpuPass::Debug);
+            DebugRenderer::Flush();
+        }
 
         //Final Pass
         s_RendererData.RenderTexture = s_MainRenderTexture;
 
         s_MainFramebuffer->UnBind();
 
-        s_RendererData.renderQueue.clear();
+        GpuProfiler::EndFrame();
+        FrameCapture::EndFrame();
+
+        static Metric& drawCallsMetric = Metrics::Gauge("Draw Calls");
+        static Metric& vertexCountMetric = Metrics::Gauge("Vertices");
+        static Metric& indexCountMetric = Metrics::Gauge("Indices");
+        drawCallsMetric.Set(s_Stats.DrawCalls);
+        vertexCountMetric.Set(s_Stats.VertexCount);
+        indexCountMetric.Set(s_Stats.IndexCount);
     }
 
     //TEMPORAL
@@ -258,6 +354,11 @@ namespace Coffee {
         s_RendererData.renderQueue.push_back(command);
     }
 
+    void Renderer::Submit(RenderCommand&& command)
+    {
+        s_RendererData.renderQueue.push_back(std::move(command));
+    }
+
     // Temporal, this should be removed because this is rendering immediately.
     void Renderer::Submit(const Ref<Shader>& shader, const Ref<VertexArray>& vertexArray, const glm::mat4& transform, uint32_t entityID)
     {
@@ -285,13 +386,14 @@ namespace Coffee {
     {
         s_viewportWidth = width;
         s_viewportHeight = height;
-
-        s_viewportResized = true;
     }
 
-    void Renderer::ResizeFramebuffers()
+    void Renderer::ResizeFramebuffers(uint32_t width, uint32_t height)
     {
-        s_MainFramebuffer->Resize(s_viewportWidth, s_viewportHeight);
-        s_PostProcessingFramebuffer->Resize(s_viewportWidth, s_viewportHeight);
+        s_MainFramebuffer->Resize(width, height);
+        s_PostProcessingFramebuffer->Resize(width, height);
+
+        s_FramebufferWidth = width;
+        s_FramebufferHeight = height;
     }
 }
\ No newline at end of file
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Core/FrameAllocator.h"
 #include "CoffeeEngine/Renderer/EditorCamera.h"
 #include "CoffeeEngine/Renderer/Framebuffer.h"
+#include "CoffeeEngine/Renderer/GpuProfiler.h"
 #include "CoffeeEngine/Renderer/Material.h"
 #include "CoffeeEngine/Renderer/Mesh.h"
 #include "CoffeeEngine/Renderer/Shader.h"
@@ -14,6 +16,8 @@
 
 namespace Coffee {
 
+    struct FramePacket;
+
     /**
      * @defgroup renderer Renderer
      * @brief Renderer components of the CoffeeEngine.
@@ -62,7 +66,7 @@ namespace Coffee {
 
         Ref<Texture2D> RenderTexture; ///< Render texture.
 
-        std::vector<RenderCommand> renderQueue; ///< Render queue.
+        FrameVector<RenderCommand> renderQueue; ///< Render queue, its storage is reset every BeginScene.
     };
 
     /**
@@ -73,6 +77,7 @@ namespace Coffee {
         uint32_t DrawCalls = 0; ///< Number of draw calls.
         uint32_t VertexCount = 0; ///< Number of vertices.
         uint32_t IndexCount = 0; ///< Number of indices.
+        GpuPassTimings GpuTimings; ///< GPU time of each pass, from a frame a few frames old.
     };
 
     /**
@@ -85,6 +90,8 @@ namespace Coffee {
         bool Bloom = false; ///< Enable or disable bloom.
         bool FXAA = false; ///< Enable or disable FXAA.
         float Exposure = 1.0f; ///< Exposure value.
+        bool BindlessTextures = true; ///< Use bindless material textures when GL_ARB_bindless_texture is available.
+        bool TextureArrays = true; ///< Group material textures into texture arrays when bindless is not used.
 
         // REMOVE: This is for the first release of the engine it should be handled differently
         bool showNormals = false;
@@ -120,7 +127,15 @@ namespace Coffee {
         static void BeginScene(Camera& camera, const glm::mat4& transform);
 
         /**
-         * @brief Ends the current scene.
+         * @brief Begins a new scene with the specified camera matrices. Used to replay captured frames.
+         * @param view The view matrix.
+         * @param projection The projection matrix.
+         * @param position The position of the camera.
+         */
+        static void BeginScene(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position);
+
+        /**
+         * @brief Ends the current scene, seals its frame packet and renders it.
          */
         static void EndScene();
 
@@ -137,6 +152,12 @@ namespace Coffee {
 
         static void Submit(const RenderCommand& command);
 
+        /**
+         * @brief Submits a render command, moving its mesh and material references into the queue.
+         * @param command The render command.
+         */
+        static void Submit(RenderCommand&& command);
+
         static void Submit(const Ref<Shader>& shader, const Ref<VertexArray>& vertexArray, const glm::mat4& transform = glm::mat4(1.0f), uint32_t entityID = 4294967295);
 
         /**
@@ -192,8 +213,22 @@ namespace Coffee {
         static RenderSettings& GetRenderSettings() { return s_RenderSettings; }
 
     private:
+        /**
+         * @brief Issues the draw calls of a frame packet.
+         * @param packet The packet to render.
+         */
+        static void RenderPacket(const FramePacket& packet);
 
-        static void ResizeFramebuffers();
+        static void ResizeFramebuffers(uint32_t width, uint32_t height);
+        static void ResetFrameData();
+
+        /**
+         * @brief Records the camera of the scene and starts a new render queue. Shared by every BeginScene.
+         * @param view The view matrix.
+         * @param projection The projection matrix.
+         * @param position The camera position, in world space.
+         */
+        static void BeginSceneCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position);
 
     private:
         static RendererData s_RendererData; ///< Renderer data.
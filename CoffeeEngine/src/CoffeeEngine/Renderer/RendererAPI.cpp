@@ -1,100 +1,74 @@
 #include "CoffeeEngine/Renderer/RendererAPI.h"
+#include "CoffeeEngine/Renderer/FrameCapture.h"
+
+#include "Platform/Null/NullRendererAPI.h"
+#include "Platform/OpenGL/OpenGLRendererAPI.h"
 
-#include <glad/glad.h>
 #include <tracy/Tracy.hpp>
 
 namespace Coffee {
 
-	Scope<RendererAPI> RendererAPI::s_RendererAPI = RendererAPI::Create();
-
-    void OpenGLMessageCallback(
-		unsigned source,
-		unsigned type,
-		unsigned id,
-		unsigned severity,
-		int length,
-		const char* message,
-		const void* userParam)
-	{
-		switch (severity)
-		{
-			case GL_DEBUG_SEVERITY_HIGH:         COFFEE_CORE_ERROR(message); return;
-			case GL_DEBUG_SEVERITY_MEDIUM:       COFFEE_CORE_ERROR(message); return;
-			case GL_DEBUG_SEVERITY_LOW:          COFFEE_CORE_WARN(message); return;
-			case GL_DEBUG_SEVERITY_NOTIFICATION: COFFEE_CORE_TRACE(message); return;
-		}
-
-		COFFEE_CORE_ASSERT(false, "Unknown severity level!");
-	}
+    RendererAPI::API RendererAPI::s_API = RendererAPI::API::OpenGL;
+    Scope<RendererAPI> RendererAPI::s_RendererAPI = RendererAPI::Create();
 
     void RendererAPI::Init()
     {
         ZoneScoped;
 
-	#ifdef COFFEE_DEBUG
-			glEnable(GL_DEBUG_OUTPUT);
-			glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);//can slow down the program
-			glDebugMessageCallback(OpenGLMessageCallback, nullptr);
-
-			glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, NULL, GL_FALSE);
-	#endif
-
-        glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-		glEnable(GL_DEPTH_TEST);
-		glEnable(GL_LINE_SMOOTH);
-
-		glEnable(GL_CULL_FACE);
-		glCullFace(GL_BACK);
-
-		glDepthFunc(GL_LEQUAL);
+        s_RendererAPI->InitImpl();
     }
 
-	void RendererAPI::SetClearColor(const glm::vec4& color)
-	{
-	    ZoneScoped;
-
-		glClearColor(color.r, color.g, color.b, color.a);
-	}
-
-	void RendererAPI::Clear()
-	{
-	    ZoneScoped;
-
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	}
+    void RendererAPI::SetClearColor(const glm::vec4& color)
+    {
+        FrameCapture::RecordEvent(FrameCaptureEvent::Type::SetClearColor, 0, color);
+        s_RendererAPI->SetClearColorImpl(color);
+    }
 
-	void RendererAPI::SetDepthMask(bool enabled)
-	{
-		ZoneScoped;
+    void RendererAPI::Clear()
+    {
+        FrameCapture::RecordEvent(FrameCaptureEvent::Type::Clear);
+        s_RendererAPI->ClearImpl();
+    }
 
-		glDepthMask(enabled);
-	}
+    void RendererAPI::SetDepthMask(bool enabled)
+    {
+        FrameCapture::RecordEvent(FrameCaptureEvent::Type::SetDepthMask, enabled ? 1 : 0);
+        s_RendererAPI->SetDepthMaskImpl(enabled);
+    }
 
     void RendererAPI::DrawIndexed(const Ref<VertexArray>& vertexArray)
     {
-        ZoneScoped;
+        if(FrameCapture::IsCapturing())
+            FrameCapture::RecordEvent(FrameCaptureEvent::Type::DrawIndexed, vertexArray->GetIndexBuffer()->GetCount());
 
-        vertexArray->Bind();
-		vertexArray->GetVertexBuffers()[0]->Bind();
-		vertexArray->GetIndexBuffer()->Bind();
-        uint32_t count = vertexArray->GetIndexBuffer()->GetCount();
-        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
+        s_RendererAPI->DrawIndexedImpl(vertexArray);
     }
 
-	void RendererAPI::DrawLines(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, float lineWidth)
-	{
-		ZoneScoped;
+    void RendererAPI::DrawLines(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, float lineWidth)
+    {
+        FrameCapture::RecordEvent(FrameCaptureEvent::Type::DrawLines, vertexCount, glm::vec4(lineWidth, 0.0f, 0.0f, 0.0f));
+        s_RendererAPI->DrawLinesImpl(vertexArray, vertexCount, lineWidth);
+    }
 
-		vertexArray->Bind();
-		glLineWidth(lineWidth);
-		glDrawArrays(GL_LINES, 0, vertexCount);
-	}
+    void RendererAPI::SetAPI(API api)
+    {
+        if(s_API == api)
+            return;
+
+        s_API = api;
+        s_RendererAPI = Create();
+    }
 
     Scope<RendererAPI> RendererAPI::Create()
     {
-        return CreateScope<RendererAPI>();
+        switch (s_API)
+        {
+            case API::None: return CreateScope<NullRendererAPI>();
+            case API::OpenGL: return CreateScope<OpenGLRendererAPI>();
+        }
+
+        COFFEE_CORE_ASSERT(false, "Unknown RendererAPI!");
+        return nullptr;
     }
 
 }
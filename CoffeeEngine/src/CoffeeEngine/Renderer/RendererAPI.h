@@ -15,9 +15,29 @@ namespace Coffee {
 
     /**
      * @brief Class representing the Renderer API.
+     *
+     * The static methods delegate to the instance of the selected backend.
      */
     class RendererAPI {
     public:
+        /**
+         * @brief The backends the Renderer API can run on.
+         */
+        enum class API
+        {
+            None = 0, ///< Null backend, records the commands without a GPU or window (CI, servers, benchmarks).
+            OpenGL = 1 ///< OpenGL 4.5 backend.
+        };
+
+        virtual ~RendererAPI() = default;
+
+        virtual void InitImpl() = 0;
+        virtual void SetClearColorImpl(const glm::vec4& color) = 0;
+        virtual void ClearImpl() = 0;
+        virtual void SetDepthMaskImpl(bool enabled) = 0;
+        virtual void DrawIndexedImpl(const Ref<VertexArray>& vertexArray) = 0;
+        virtual void DrawLinesImpl(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, float lineWidth) = 0;
+
         /**
          * @brief Initializes the Renderer API.
          */
@@ -55,14 +75,33 @@ namespace Coffee {
         static void DrawLines(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, float lineWidth = 1.0f);
 
         /**
-         * @brief Creates a new Renderer API instance.
+         * @brief Gets the selected backend.
+         * @return The selected backend.
+         */
+        static API GetAPI() { return s_API; }
+
+        /**
+         * @brief Selects the backend. Must be called before creating any GPU resource.
+         * @param api The backend to use.
+         */
+        static void SetAPI(API api);
+
+        /**
+         * @brief Gets the instance of the selected backend.
+         * @return The backend instance.
+         */
+        static RendererAPI* Get() { return s_RendererAPI.get(); }
+
+        /**
+         * @brief Creates a new Renderer API instance for the selected backend.
          * @return A scope pointer to the created Renderer API instance.
          */
         static Scope<RendererAPI> Create();
 
     private:
+        static API s_API; ///< The selected backend.
         static Scope<RendererAPI> s_RendererAPI; ///< The Renderer API instance.
     };
 
     /** @} */
-}
\ No newline at end of file
+}
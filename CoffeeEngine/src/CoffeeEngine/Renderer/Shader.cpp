@@ -1,6 +1,8 @@
 #include "CoffeeEngine/Renderer/Shader.h"
 #include "CoffeeEngine/IO/ResourceLoader.h"
 #include "CoffeeEngine/IO/ResourceRegistry.h"
+#include "CoffeeEngine/Renderer/BindlessTexture.h"
+#include "CoffeeEngine/Renderer/ShaderVariantCache.h"
 
 #include <fstream>
 #include <sstream>
@@ -9,13 +11,8 @@
 
 namespace Coffee {
 
-    Shader::Shader(const std::filesystem::path& shaderPath)
+    static bool ReadShaderFile(const std::filesystem::path& shaderPath, std::string& shaderCode)
     {
-        ZoneScoped;
-
-        m_Name = shaderPath.filename().string();
-
-        std::string shaderCode;
         std::ifstream shaderFile;
 
         shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
@@ -31,16 +28,43 @@ namespace Coffee {
         catch (std::ifstream::failure e)
         {
             COFFEE_CORE_ERROR(std::string("ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: ") + e.what());
+            return false;
         }
 
-        CompileShader(shaderCode);
+        return true;
+    }
+
+    Shader::Shader(const std::filesystem::path& shaderPath)
+    {
+        ZoneScoped;
+
+        m_Name = shaderPath.filename().string();
+        m_FilePath = shaderPath;
+
+        std::string shaderCode;
+        ReadShaderFile(shaderPath, shaderCode);
+
+        m_Source = shaderCode;
+
+        m_ShaderID = CompileShader(shaderCode);
     }
 
     Shader::Shader(const std::string& name, const std::string& shaderSource)
     {
         m_Name = name;
+        m_Source = shaderSource;
+
+        m_ShaderID = CompileShader(shaderSource);
+    }
+
+    Shader::Shader(const std::string& name, const std::string& shaderSource, const std::vector<std::string>& defines)
+    {
+        ZoneScoped;
+
+        m_Name = name;
+        m_Source = shaderSource;
 
-        CompileShader(shaderSource);
+        m_ShaderID = CompileShader(shaderSource, defines);
     }
 
     Shader::~Shader()
@@ -48,6 +72,42 @@ namespace Coffee {
         ZoneScoped;
 
         glDeleteProgram(m_ShaderID);
+
+        // A shader allocated later at the same address must not get these permutations
+        ShaderVariantCache::Invalidate(this);
+    }
+
+    bool Shader::Reload()
+    {
+        ZoneScoped;
+
+        if(m_FilePath.empty())
+        {
+            COFFEE_CORE_ERROR("Shader::Reload: {0} was not loaded from a file!", m_Name);
+            return false;
+        }
+
+        std::string shaderCode;
+        if(!ReadShaderFile(m_FilePath, shaderCode))
+            return false;
+
+        GLuint program = CompileShader(shaderCode);
+        if(program == 0)
+        {
+            COFFEE_CORE_ERROR("Shader::Reload: Failed to recompile {0}, keeping the previous program", m_Name);
+            return false;
+        }
+
+        // Swap the program in place so every Ref<Shader> holder picks up the new one on the next Bind()
+        glDeleteProgram(m_ShaderID);
+        m_ShaderID = program;
+        m_Source = shaderCode;
+
+        // The permutations were compiled from the old source
+        ShaderVariantCache::Invalidate(this);
+
+        COFFEE_CORE_INFO("Shader::Reload: Reloaded {0}", m_Name);
+        return true;
     }
 
     void Shader::Bind()
@@ -64,78 +124,86 @@ namespace Coffee {
         glUseProgram(0);
     }
 
-    void Shader::setBool(const std::string& name, bool value) const
+    void Shader::setBool(const char* name, bool value) const
     {
         ZoneScoped;
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+        GLint location = glGetUniformLocation(m_ShaderID, name);
         glUniform1i(location, (int)value);
     }
 
-    void Shader::setInt(const std::string& name, int value) const
+    void Shader::setInt(const char* name, int value) const
     {
         ZoneScoped;
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+        GLint location = glGetUniformLocation(m_ShaderID, name);
         glUniform1i(location, value);
     }
 
-    void Shader::setFloat(const std::string& name, float value) const
+    void Shader::setFloat(const char* name, float value) const
     {
         ZoneScoped;
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+        GLint location = glGetUniformLocation(m_ShaderID, name);
         glUniform1f(location, value);
     }
 
-    void Shader::setVec2(const std::string& name, const glm::vec2& value) const
+    void Shader::setVec2(const char* name, const glm::vec2& value) const
     {
         ZoneScoped;
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+        GLint location = glGetUniformLocation(m_ShaderID, name);
         glUniform2fv(location, 1, &value[0]);
     }
 
-    void Shader::setVec3(const std::string& name, const glm::vec3& value) const
+    void Shader::setVec3(const char* name, const glm::vec3& value) const
     {
         ZoneScoped;
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+        GLint location = glGetUniformLocation(m_ShaderID, name);
         glUniform3fv(location, 1, &value[0]);
     }
 
-    void Shader::setVec4(const std::string& name, const glm::vec4& value) const
+    void Shader::setVec4(const char* name, const glm::vec4& value) const
     {
         ZoneScoped;
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+        GLint location = glGetUniformLocation(m_ShaderID, name);
         glUniform4fv(location, 1, &value[0]);
     }
 
-    void Shader::setMat2(const std::string& name, const glm::mat2& mat) const
+    void Shader::setMat2(const char* name, const glm::mat2& mat) const
     {
         ZoneScoped;
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+        GLint location = glGetUniformLocation(m_ShaderID, name);
         glUniformMatrix2fv(location, 1, GL_FALSE, &mat[0][0]);
     }
 
-    void Shader::setMat3(const std::string& name, const glm::mat3& mat) const
+    void Shader::setMat3(const char* name, const glm::mat3& mat) const
     {
         ZoneScoped;
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+        GLint location = glGetUniformLocation(m_ShaderID, name);
         glUniformMatrix3fv(location, 1, GL_FALSE, &mat[0][0]);
     }
 
-    void Shader::setMat4(const std::string& name, const glm::mat4& mat) const
+    void Shader::setMat4(const char* name, const glm::mat4& mat) const
     {
         ZoneScoped;
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+        GLint location = glGetUniformLocation(m_ShaderID, name);
         glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
     }
 
+    void Shader::setTextureHandle(const char* name, uint64_t handle) const
+    {
+        ZoneScoped;
+
+        GLint location = glGetUniformLocation(m_ShaderID, name);
+        BindlessTexture::SetUniformHandle(location, handle);
+    }
+
     Ref<Shader> Shader::Create(const std::filesystem::path& shaderPath)
     {
         ZoneScoped;
@@ -148,7 +216,7 @@ namespace Coffee {
         return ResourceLoader::LoadShader(shaderSource);
     }*/
 
-    void Shader::checkCompileErrors(GLuint shader, std::string type)
+    bool Shader::checkCompileErrors(GLuint shader, std::string type)
     {
         GLint success;
         GLchar infoLog[1024];
@@ -172,9 +240,34 @@ namespace Coffee {
                 COFFEE_CORE_ERROR("ERROR::PROGRAM_LINKING_ERROR of type: {0}\n{1}\n", type, infoLog);
             }
         }
+        return success;
+    }
+
+    // The defines have to go after the #version directive, which must be the first statement of a stage
+    static void InjectDefines(std::string& stageCode, const std::vector<std::string>& defines)
+    {
+        if(defines.empty())
+            return;
+
+        std::string defineBlock;
+        for(const std::string& define : defines)
+        {
+            defineBlock += "#define " + define + "\n";
+        }
+
+        size_t versionPos = stageCode.find("#version");
+        size_t insertPos = 0;
+
+        if(versionPos != std::string::npos)
+        {
+            insertPos = stageCode.find('\n', versionPos);
+            insertPos = (insertPos == std::string::npos) ? stageCode.length() : insertPos + 1;
+        }
+
+        stageCode.insert(insertPos, defineBlock);
     }
 
-    void Shader::CompileShader(const std::string& shaderSource)
+    GLuint Shader::CompileShader(const std::string& shaderSource, const std::vector<std::string>& defines)
     {
         const std::string vertexDelimiter = "#[vertex]";
         const std::string fragmentDelimiter = "#[fragment]";
@@ -185,12 +278,15 @@ namespace Coffee {
         if(vertexPos == std::string::npos || fragmentPos == std::string::npos)
         {
             COFFEE_CORE_ERROR("ERROR::SHADER::DELIMITER_NOT_FOUND: Delimiter not found in shader file!");
-            return;
+            return 0;
         }
 
         std::string vertexCode = shaderSource.substr(vertexPos + vertexDelimiter.length(), fragmentPos - vertexPos - vertexDelimiter.length());
         std::string fragmentCode = shaderSource.substr(fragmentPos + fragmentDelimiter.length(), shaderSource.length() - fragmentPos - fragmentDelimiter.length());
 
+        InjectDefines(vertexCode, defines);
+        InjectDefines(fragmentCode, defines);
+
         const char* vShaderCode = vertexCode.c_str();
         const char * fShaderCode = fragmentCode.c_str();
         // 2. compile shaders
@@ -199,21 +295,29 @@ namespace Coffee {
         vertex = glCreateShader(GL_VERTEX_SHADER);
         glShaderSource(vertex, 1, &vShaderCode, NULL);
         glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
+        bool success = checkCompileErrors(vertex, "VERTEX");
         // fragment Shader
         fragment = glCreateShader(GL_FRAGMENT_SHADER);
         glShaderSource(fragment, 1, &fShaderCode, NULL);
         glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
+        success &= checkCompileErrors(fragment, "FRAGMENT");
         // shader Program
-        m_ShaderID = glCreateProgram();
-        glAttachShader(m_ShaderID, vertex);
-        glAttachShader(m_ShaderID, fragment);
-        glLinkProgram(m_ShaderID);
-        checkCompileErrors(m_ShaderID, "PROGRAM");
+        GLuint program = glCreateProgram();
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
+        glLinkProgram(program);
+        success &= checkCompileErrors(program, "PROGRAM");
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
+
+        if(!success)
+        {
+            glDeleteProgram(program);
+            return 0;
+        }
+
+        return program;
     }
 
 }
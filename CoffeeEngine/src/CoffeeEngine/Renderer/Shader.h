@@ -8,6 +8,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace Coffee {
 
@@ -17,6 +18,27 @@ namespace Coffee {
      * @{
      */
 
+    /**
+     * @brief Enum representing the features that select a shader permutation.
+     *
+     * Each feature maps to a preprocessor define injected after the #version line
+     * of every stage (see ShaderVariantCache::GetDefines).
+     */
+    enum ShaderFeature : uint32_t
+    {
+        ShaderFeatureNone         = 0,
+        ShaderFeatureAlbedoMap    = BIT(0), ///< HAS_ALBEDO_MAP
+        ShaderFeatureNormalMap    = BIT(1), ///< HAS_NORMAL_MAP
+        ShaderFeatureMetallicMap  = BIT(2), ///< HAS_METALLIC_MAP
+        ShaderFeatureRoughnessMap = BIT(3), ///< HAS_ROUGHNESS_MAP
+        ShaderFeatureAOMap        = BIT(4), ///< HAS_AO_MAP
+        ShaderFeatureEmissiveMap  = BIT(5), ///< HAS_EMISSIVE_MAP
+        ShaderFeatureInstanced    = BIT(6), ///< INSTANCED
+        ShaderFeatureDepthOnly    = BIT(7), ///< DEPTH_ONLY
+        ShaderFeatureBindless     = BIT(8), ///< BINDLESS
+        ShaderFeatureTextureArray = BIT(9)  ///< TEXTURE_ARRAYS
+    };
+
     /**
      * @brief Class representing a shader program.
      */
@@ -31,11 +53,28 @@ namespace Coffee {
         Shader(const std::filesystem::path& shaderPath);
         Shader(const std::string& name, const std::string& shaderSource);
 
+        /**
+         * @brief Constructs a Shader permutation from the source and a list of preprocessor defines.
+         * @param name The name of the shader.
+         * @param shaderSource The source of the shader containing the #[vertex] and #[fragment] delimiters.
+         * @param defines The defines injected after the #version line of each stage.
+         */
+        Shader(const std::string& name, const std::string& shaderSource, const std::vector<std::string>& defines);
+
         /**
          * @brief Destructor for the Shader class.
          */
         virtual ~Shader();
 
+        /**
+         * @brief Recompiles the shader from its file on disk.
+         *
+         * The program is only replaced if the new source compiles and links, otherwise the
+         * previous program is kept. Cached permutations of the shader are invalidated.
+         * @return True if the shader was reloaded, false otherwise.
+         */
+        bool Reload();
+
         /**
          * @brief Binds the shader program for use.
          */
@@ -51,63 +90,88 @@ namespace Coffee {
          * @param name The name of the uniform.
          * @param value The boolean value to set.
          */
-        void setBool(const std::string& name, bool value) const;
+        void setBool(const char* name, bool value) const;
 
         /**
          * @brief Sets an integer uniform in the shader.
          * @param name The name of the uniform.
          * @param value The integer value to set.
          */
-        void setInt(const std::string& name, int value) const;
+        void setInt(const char* name, int value) const;
 
         /**
          * @brief Sets a float uniform in the shader.
          * @param name The name of the uniform.
          * @param value The float value to set.
          */
-        void setFloat(const std::string& name, float value) const;
+        void setFloat(const char* name, float value) const;
 
         /**
          * @brief Sets a vec2 uniform in the shader.
          * @param name The name of the uniform.
          * @param value The vec2 value to set.
          */
-        void setVec2(const std::string& name, const glm::vec2& value) const;
+        void setVec2(const char* name, const glm::vec2& value) const;
 
         /**
          * @brief Sets a vec3 uniform in the shader.
          * @param name The name of the uniform.
          * @param value The vec3 value to set.
          */
-        void setVec3(const std::string& name, const glm::vec3& value) const;
+        void setVec3(const char* name, const glm::vec3& value) const;
 
         /**
          * @brief Sets a vec4 uniform in the shader.
          * @param name The name of the uniform.
          * @param value The vec4 value to set.
          */
-        void setVec4(const std::string& name, const glm::vec4& value) const;
+        void setVec4(const char* name, const glm::vec4& value) const;
 
         /**
          * @brief Sets a mat2 uniform in the shader.
          * @param name The name of the uniform.
          * @param mat The mat2 value to set.
          */
-        void setMat2(const std::string& name, const glm::mat2& mat) const;
+        void setMat2(const char* name, const glm::mat2& mat) const;
 
         /**
          * @brief Sets a mat3 uniform in the shader.
          * @param name The name of the uniform.
          * @param mat The mat3 value to set.
          */
-        void setMat3(const std::string& name, const glm::mat3& mat) const;
+        void setMat3(const char* name, const glm::mat3& mat) const;
 
         /**
          * @brief Sets a mat4 uniform in the shader.
          * @param name The name of the uniform.
          * @param mat The mat4 value to set.
          */
-        void setMat4(const std::string& name, const glm::mat4& mat) const;
+        void setMat4(const char* name, const glm::mat4& mat) const;
+
+        /**
+         * @brief Sets a bindless sampler uniform in the shader.
+         * @param name The name of the uniform.
+         * @param handle The resident bindless texture handle.
+         */
+        void setTextureHandle(const char* name, uint64_t handle) const;
+
+        // Overloads for uniform names built at runtime, literals use the const char* versions without allocating
+        void setBool(const std::string& name, bool value) const { setBool(name.c_str(), value); }
+        void setInt(const std::string& name, int value) const { setInt(name.c_str(), value); }
+        void setFloat(const std::string& name, float value) const { setFloat(name.c_str(), value); }
+        void setVec2(const std::string& name, const glm::vec2& value) const { setVec2(name.c_str(), value); }
+        void setVec3(const std::string& name, const glm::vec3& value) const { setVec3(name.c_str(), value); }
+        void setVec4(const std::string& name, const glm::vec4& value) const { setVec4(name.c_str(), value); }
+        void setMat2(const std::string& name, const glm::mat2& mat) const { setMat2(name.c_str(), mat); }
+        void setMat3(const std::string& name, const glm::mat3& mat) const { setMat3(name.c_str(), mat); }
+        void setMat4(const std::string& name, const glm::mat4& mat) const { setMat4(name.c_str(), mat); }
+        void setTextureHandle(const std::string& name, uint64_t handle) const { setTextureHandle(name.c_str(), handle); }
+
+        /**
+         * @brief Gets the unprocessed source of the shader.
+         * @return The source of the shader.
+         */
+        const std::string& GetSource() const { return m_Source; }
 
         /**
          * @brief Creates a shader from the specified vertex and fragment shader paths.
@@ -122,14 +186,16 @@ namespace Coffee {
          * @brief Checks for compile errors in the shader.
          * @param shader The shader ID.
          * @param type The type of the shader.
+         * @return True if the shader compiled or the program linked successfully.
          */
-        void checkCompileErrors(GLuint shader, std::string type);
+        bool checkCompileErrors(GLuint shader, std::string type);
 
     private:
-        void CompileShader(const std::string& shaderSource);
+        GLuint CompileShader(const std::string& shaderSource, const std::vector<std::string>& defines = {});
 
     private:
-        unsigned int m_ShaderID; ///< The ID of the shader program.
+        unsigned int m_ShaderID = 0; ///< The ID of the shader program.
+        std::string m_Source; ///< The unprocessed source, kept to compile permutations.
     };
 
     /** @} */
@@ -0,0 +1,85 @@
+#include "ShaderVariantCache.h"
+#include "CoffeeEngine/Core/Log.h"
+
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    ShaderVariantCache::VariantMap& ShaderVariantCache::GetVariants()
+    {
+        static VariantMap* variants = new VariantMap();
+        return *variants;
+    }
+
+    const Ref<Shader>& ShaderVariantCache::Get(const Ref<Shader>& shader, uint32_t features)
+    {
+        if(features == ShaderFeatureNone)
+            return shader;
+
+        VariantKey key = {shader.get(), features};
+
+        VariantMap& variants = GetVariants();
+        auto it = variants.find(key);
+        if(it != variants.end())
+            return it->second;
+
+        ZoneScopedN("ShaderVariantCache::Compile");
+
+        std::string variantName = shader->GetName() + "[" + std::to_string(features) + "]";
+        COFFEE_CORE_TRACE("ShaderVariantCache: Compiling {0}", variantName);
+
+        Ref<Shader> variant = CreateRef<Shader>(variantName, shader->GetSource(), GetDefines(features));
+
+        return variants.emplace(key, variant).first->second;
+    }
+
+    void ShaderVariantCache::Invalidate(const Shader* shader)
+    {
+        VariantMap& variants = GetVariants();
+
+        // Released after the loop, the destructor of each permutation calls Invalidate again
+        std::vector<Ref<Shader>> released;
+        for(auto it = variants.begin(); it != variants.end();)
+        {
+            if(it->first.shader == shader)
+            {
+                released.push_back(std::move(it->second));
+                it = variants.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void ShaderVariantCache::Clear()
+    {
+        VariantMap released = std::move(GetVariants());
+        GetVariants().clear();
+    }
+
+    size_t ShaderVariantCache::GetVariantCount()
+    {
+        return GetVariants().size();
+    }
+
+    std::vector<std::string> ShaderVariantCache::GetDefines(uint32_t features)
+    {
+        std::vector<std::string> defines;
+
+        if(features & ShaderFeatureAlbedoMap) defines.push_back("HAS_ALBEDO_MAP");
+        if(features & ShaderFeatureNormalMap) defines.push_back("HAS_NORMAL_MAP");
+        if(features & ShaderFeatureMetallicMap) defines.push_back("HAS_METALLIC_MAP");
+        if(features & ShaderFeatureRoughnessMap) defines.push_back("HAS_ROUGHNESS_MAP");
+        if(features & ShaderFeatureAOMap) defines.push_back("HAS_AO_MAP");
+        if(features & ShaderFeatureEmissiveMap) defines.push_back("HAS_EMISSIVE_MAP");
+        if(features & ShaderFeatureInstanced) defines.push_back("INSTANCED");
+        if(features & ShaderFeatureDepthOnly) defines.push_back("DEPTH_ONLY");
+        if(features & ShaderFeatureBindless) defines.push_back("BINDLESS");
+        if(features & ShaderFeatureTextureArray) defines.push_back("TEXTURE_ARRAYS");
+
+        return defines;
+    }
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Renderer/Shader.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    /**
+     * @brief Cache of shader permutations keyed by (shader, feature mask).
+     *
+     * Permutations are compiled lazily the first time they are requested, so only the
+     * combinations actually used by the materials in the scene are ever compiled.
+     */
+    class ShaderVariantCache
+    {
+    public:
+        /**
+         * @brief Gets the permutation of a shader for the given features, compiling it if needed.
+         * @param shader The base shader.
+         * @param features The ShaderFeature bitmask.
+         * @return The shader permutation. If features is ShaderFeatureNone the base shader is returned.
+         */
+        static const Ref<Shader>& Get(const Ref<Shader>& shader, uint32_t features);
+
+        /**
+         * @brief Removes all the cached permutations of a shader.
+         * @param shader The base shader.
+         */
+        static void Invalidate(const Shader* shader);
+
+        /**
+         * @brief Removes all the cached permutations.
+         */
+        static void Clear();
+
+        /**
+         * @brief Converts a ShaderFeature bitmask into the list of preprocessor defines.
+         * @param features The ShaderFeature bitmask.
+         * @return The list of defines.
+         */
+        static std::vector<std::string> GetDefines(uint32_t features);
+
+        /**
+         * @brief Gets the number of compiled permutations.
+         * @return The number of compiled permutations.
+         */
+        static size_t GetVariantCount();
+
+    private:
+        struct VariantKey
+        {
+            const Shader* shader;
+            uint32_t features;
+
+            bool operator==(const VariantKey& other) const { return shader == other.shader && features == other.features; }
+        };
+
+        struct VariantKeyHash
+        {
+            size_t operator()(const VariantKey& key) const
+            {
+                return std::hash<const Shader*>()(key.shader) ^ (std::hash<uint32_t>()(key.features) << 1);
+            }
+        };
+
+        using VariantMap = std::unordered_map<VariantKey, Ref<Shader>, VariantKeyHash>;
+
+        /**
+         * @brief Gets the compiled permutations.
+         *
+         * The map is never destroyed, so shaders released during static destruction can still invalidate their permutations.
+         * @return The permutations by (shader, feature mask).
+         */
+        static VariantMap& GetVariants();
+    };
+
+    /** @} */
+}
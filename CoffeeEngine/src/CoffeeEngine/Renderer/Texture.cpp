@@ -3,6 +3,8 @@
 #include "CoffeeEngine/Core/Log.h"
 #include "CoffeeEngine/IO/Resource.h"
 #include "CoffeeEngine/IO/ResourceLoader.h"
+#include "CoffeeEngine/Renderer/BindlessTexture.h"
+#include "CoffeeEngine/Renderer/TextureArrayPool.h"
 
 #include <cereal/archives/binary.hpp>
 #include <cereal/types/vector.hpp>
@@ -69,6 +71,36 @@ namespace Coffee {
         }
     }
 
+    // Bytes per texel as stored by the driver, three channel formats are padded to four
+    static size_t ImageFormatToTexelSize(ImageFormat format)
+    {
+        switch(format)
+        {
+            case ImageFormat::R8: return 1;
+            case ImageFormat::RG8: return 2;
+            case ImageFormat::RGB8:
+            case ImageFormat::SRGB8:
+            case ImageFormat::RGBA8:
+            case ImageFormat::SRGBA8: return 4;
+            case ImageFormat::R32F: return 4;
+            case ImageFormat::RGB32F:
+            case ImageFormat::RGBA32F: return 16;
+            case ImageFormat::DEPTH24STENCIL8: return 4;
+        }
+        return 4;
+    }
+
+    size_t Texture2D::CalculateMemory(ImageFormat format, uint32_t width, uint32_t height, int mipLevels)
+    {
+        size_t texelSize = ImageFormatToTexelSize(format);
+        size_t bytes = 0;
+        for(int level = 0; level < mipLevels; level++)
+        {
+            bytes += (size_t)std::max(width >> level, 1u) * std::max(height >> level, 1u) * texelSize;
+        }
+        return bytes;
+    }
+
     Texture2D::Texture2D(const TextureProperties& properties)
         : m_Properties(properties), m_Width(properties.Width), m_Height(properties.Height)
     {
@@ -89,6 +121,7 @@ namespace Coffee {
 
         glCreateTextures(GL_TEXTURE_2D, 1, &m_textureID);
         glTextureStorage2D(m_textureID, mipLevels, internalFormat, m_Width, m_Height);
+        m_GpuMemory.Track(GpuMemoryType::Texture, this, CalculateMemory(m_Properties.Format, m_Width, m_Height, mipLevels));
 
         glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -141,6 +174,7 @@ namespace Coffee {
 
             glCreateTextures(GL_TEXTURE_2D, 1, &m_textureID);
             glTextureStorage2D(m_textureID, mipLevels, internalFormat, m_Width, m_Height);
+            m_GpuMemory.Track(GpuMemoryType::Texture, this, CalculateMemory(m_Properties.Format, m_Width, m_Height, mipLevels));
 
             glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_S, GL_REPEAT);
             glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -166,6 +200,9 @@ namespace Coffee {
     {
         ZoneScoped;
 
+        BindlessTexture::ReleaseHandle(m_BindlessHandle);
+        TextureArrayPool::Release(m_textureID);
+
         glDeleteTextures(1, &m_textureID);
 
         if(m_Data.size() > 0)
@@ -181,6 +218,16 @@ namespace Coffee {
         glBindTextureUnit(slot, m_textureID);
     }
 
+    uint64_t Texture2D::GetBindlessHandle()
+    {
+        if(m_BindlessHandle == 0)
+        {
+            m_BindlessHandle = BindlessTexture::CreateHandle(m_textureID);
+        }
+
+        return m_BindlessHandle;
+    }
+
     void Texture2D::Resize(uint32_t width, uint32_t height)
     {
         ZoneScoped;
@@ -188,6 +235,10 @@ namespace Coffee {
         m_Width = width;
         m_Height = height;
 
+        BindlessTexture::ReleaseHandle(m_BindlessHandle);
+        m_BindlessHandle = 0;
+        TextureArrayPool::Release(m_textureID);
+
         glDeleteTextures(1, &m_textureID);
 
         int mipLevels = 1 + floor(log2(std::max(m_Width, m_Height)));
@@ -197,6 +248,7 @@ namespace Coffee {
 
         glCreateTextures(GL_TEXTURE_2D, 1, &m_textureID);
         glTextureStorage2D(m_textureID, mipLevels, internalFormat, m_Width, m_Height);
+        m_GpuMemory.Track(GpuMemoryType::Texture, this, CalculateMemory(m_Properties.Format, m_Width, m_Height, mipLevels));
 
         glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -225,11 +277,24 @@ namespace Coffee {
     {
         ZoneScoped;
 
+        // A pooled texture is a view of its array layer, so the data lands in the array directly
         GLenum format = ImageFormatToOpenGLFormat(m_Properties.Format);
         glTextureSubImage2D(m_textureID, 0, 0, 0, m_Width, m_Height, format, GL_UNSIGNED_BYTE, data);
         glGenerateTextureMipmap(m_textureID);
     }
 
+    void Texture2D::ShareStorage(uint32_t viewID)
+    {
+        BindlessTexture::ReleaseHandle(m_BindlessHandle);
+        m_BindlessHandle = 0;
+
+        glDeleteTextures(1, &m_textureID);
+        m_textureID = viewID;
+
+        // The texture array tracks the memory of its layers
+        m_GpuMemory.Release();
+    }
+
     Ref<Texture2D> Texture2D::Load(const std::filesystem::path& path, bool srgb)
     {
         return ResourceLoader::LoadTexture2D(path, srgb);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Core/MemoryProfiler.h"
 #include "CoffeeEngine/IO/Resource.h"
 #include "CoffeeEngine/IO/Serialization/FilesystemPathSerialization.h"
 
@@ -91,14 +92,37 @@ namespace Coffee {
         uint32_t GetID() override { return m_textureID; };
         ImageFormat GetImageFormat() override { return m_Properties.Format; };
 
+        /**
+         * @brief Gets the resident bindless handle of the texture, creating it on first use.
+         * @return The bindless handle, or 0 if bindless textures are not supported.
+         */
+        uint64_t GetBindlessHandle();
+
         void Clear(glm::vec4 color);
         void SetData(void* data, uint32_t size);
 
         static Ref<Texture2D> Load(const std::filesystem::path& path, bool srgb = true);
         static Ref<Texture2D> Create(uint32_t width, uint32_t height, ImageFormat format);
 
+        /**
+         * @brief Computes the GPU memory used by a texture and its mipmaps.
+         * @param format The format of the texture.
+         * @param width The width of the texture.
+         * @param height The height of the texture.
+         * @param mipLevels The number of mipmap levels.
+         * @return The size in bytes.
+         */
+        static size_t CalculateMemory(ImageFormat format, uint32_t width, uint32_t height, int mipLevels);
+
     private:
         friend class cereal::access;
+        friend class TextureArrayPool;
+
+        /**
+         * @brief Replaces the storage of the texture with a view of a texture array layer.
+         * @param viewID The OpenGL ID of the view, owned by the texture from now on.
+         */
+        void ShareStorage(uint32_t viewID);
 
         template<class Archive>
         void save(Archive& archive) const
@@ -128,7 +152,9 @@ namespace Coffee {
         TextureProperties m_Properties;
         std::vector<unsigned char> m_Data;
         uint32_t m_textureID;
+        uint64_t m_BindlessHandle = 0;
         int m_Width, m_Height;
+        GpuMemoryAllocation m_GpuMemory; ///< The GPU memory of the texture and its mipmaps.
     };
 
     class Cubemap : public Texture
@@ -0,0 +1,243 @@
+#include "CoffeeEngine/Renderer/TextureArrayPool.h"
+#include "CoffeeEngine/Core/MemoryProfiler.h"
+#include "CoffeeEngine/Renderer/Texture.h"
+
+#include <algorithm>
+#include <glad/glad.h>
+#include <tracy/Tracy.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace Coffee {
+
+    struct TextureArray
+    {
+        GLuint ID = 0;
+        uint32_t Width = 0, Height = 0;
+        GLint InternalFormat = 0;
+        GLint Levels = 1;
+        int Capacity = 0;
+        int LayerCount = 0;
+        size_t LayerBytes = 0; ///< GPU memory of one layer and its mipmaps.
+        std::vector<int> FreeLayers; ///< Layers released by deleted textures.
+        Scope<GpuMemoryAllocation> GpuMemory = CreateScope<GpuMemoryAllocation>(); ///< The memory of all the layers.
+    };
+
+    struct TextureLocation
+    {
+        size_t ArrayIndex;
+        int Layer;
+        Texture2D* Texture; ///< The texture whose storage is a view of the layer.
+    };
+
+    struct TextureArrayPoolData
+    {
+        std::vector<TextureArray> Arrays; ///< One array per size and format.
+        std::unordered_map<uint32_t, TextureLocation> Locations; ///< Texture ID (the ID of its view) -> location inside the arrays.
+        std::vector<GLuint> BoundArrays; ///< Array bound to each texture unit.
+    };
+
+    static constexpr GLuint s_UnknownBinding = ~0u; ///< The texture bound to the unit is not tracked.
+
+    // Never destroyed so textures released during static destruction don't touch a dead pool
+    static TextureArrayPoolData* s_Data = new TextureArrayPoolData();
+
+    static GLuint CreateLayerView(const TextureArray& array, int layer)
+    {
+        // A view needs a name that was never bound, glCreateTextures would already create the texture object
+        GLuint viewID;
+        glGenTextures(1, &viewID);
+        glTextureView(viewID, GL_TEXTURE_2D, array.ID, array.InternalFormat, 0, array.Levels, layer, 1);
+
+        glTextureParameteri(viewID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTextureParameteri(viewID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTextureParameteri(viewID, GL_TEXTURE_MIN_FILTER, array.Levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTextureParameteri(viewID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameterf(viewID, GL_TEXTURE_MAX_ANISOTROPY, 16.0f);
+
+        return viewID;
+    }
+
+    static void Grow(size_t arrayIndex)
+    {
+        ZoneScoped;
+        COFFEE_MEMORY_TAG(Resources);
+
+        TextureArray& array = s_Data->Arrays[arrayIndex];
+
+        int newCapacity = std::max(4, array.Capacity * 2);
+
+        GLuint newID;
+        glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &newID);
+        glTextureStorage3D(newID, array.Levels, array.InternalFormat, array.Width, array.Height, newCapacity);
+
+        glTextureParameteri(newID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTextureParameteri(newID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTextureParameteri(newID, GL_TEXTURE_MIN_FILTER, array.Levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTextureParameteri(newID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameterf(newID, GL_TEXTURE_MAX_ANISOTROPY, 16.0f);
+
+        if(array.ID != 0)
+        {
+            for(GLint level = 0; level < array.Levels; level++)
+            {
+                GLsizei width = std::max(1u, array.Width >> level);
+                GLsizei height = std::max(1u, array.Height >> level);
+                glCopyImageSubData(array.ID, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                                   newID, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                                   width, height, array.LayerCount);
+            }
+
+            GLuint oldID = array.ID;
+            array.ID = newID;
+
+            // The pooled textures are views of the old storage, it is only freed once they all view the new one
+            std::vector<TextureLocation> moved;
+            for(auto it = s_Data->Locations.begin(); it != s_Data->Locations.end();)
+            {
+                if(it->second.ArrayIndex == arrayIndex)
+                {
+                    moved.push_back(it->second);
+                    it = s_Data->Locations.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            for(const TextureLocation& location : moved)
+            {
+                GLuint viewID = CreateLayerView(array, location.Layer);
+                location.Texture->ShareStorage(viewID);
+                s_Data->Locations[viewID] = location;
+            }
+
+            glDeleteTextures(1, &oldID);
+            std::replace(s_Data->BoundArrays.begin(), s_Data->BoundArrays.end(), oldID, s_UnknownBinding);
+        }
+
+        array.ID = newID;
+        array.Capacity = newCapacity;
+        array.GpuMemory->Track(GpuMemoryType::Texture, array.GpuMemory.get(), array.LayerBytes * newCapacity);
+    }
+
+    TextureArraySlot TextureArrayPool::Acquire(Texture2D& texture)
+    {
+        uint32_t textureID = texture.GetID();
+
+        if(textureID == 0)
+            return {};
+
+        auto it = s_Data->Locations.find(textureID);
+        if(it != s_Data->Locations.end())
+        {
+            return { s_Data->Arrays[it->second.ArrayIndex].ID, it->second.Layer };
+        }
+
+        ZoneScoped;
+
+        GLint internalFormat = 0, levels = 0;
+        glGetTextureLevelParameteriv(textureID, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+        glGetTextureParameteriv(textureID, GL_TEXTURE_IMMUTABLE_LEVELS, &levels);
+        levels = std::max(levels, 1);
+
+        uint32_t width = texture.GetWidth();
+        uint32_t height = texture.GetHeight();
+
+        auto arrayIt = std::find_if(s_Data->Arrays.begin(), s_Data->Arrays.end(), [&](const TextureArray& array) {
+            return array.Width == width && array.Height == height && array.InternalFormat == internalFormat && array.Levels == levels;
+        });
+
+        if(arrayIt == s_Data->Arrays.end())
+        {
+            TextureArray newArray;
+            newArray.Width = width;
+            newArray.Height = height;
+            newArray.InternalFormat = internalFormat;
+            newArray.Levels = levels;
+            newArray.LayerBytes = Texture2D::CalculateMemory(texture.GetImageFormat(), width, height, levels);
+            s_Data->Arrays.push_back(std::move(newArray));
+            arrayIt = s_Data->Arrays.end() - 1;
+        }
+
+        TextureArray& array = *arrayIt;
+        size_t arrayIndex = arrayIt - s_Data->Arrays.begin();
+
+        int layer;
+        if(!array.FreeLayers.empty())
+        {
+            layer = array.FreeLayers.back();
+            array.FreeLayers.pop_back();
+        }
+        else
+        {
+            if(array.LayerCount == array.Capacity)
+                Grow(arrayIndex);
+
+            layer = array.LayerCount++;
+        }
+
+        // GPU side copy, the pixel data doesn't need to be kept on the CPU
+        for(GLint level = 0; level < levels; level++)
+        {
+            GLsizei levelWidth = std::max(1u, width >> level);
+            GLsizei levelHeight = std::max(1u, height >> level);
+            glCopyImageSubData(textureID, GL_TEXTURE_2D, level, 0, 0, 0,
+                               array.ID, GL_TEXTURE_2D_ARRAY, level, 0, 0, layer,
+                               levelWidth, levelHeight, 1);
+        }
+
+        // The texture samples the layer from now on, so its own storage is not kept twice in VRAM
+        GLuint viewID = CreateLayerView(array, layer);
+        texture.ShareStorage(viewID);
+
+        s_Data->Locations[viewID] = { arrayIndex, layer, &texture };
+
+        return { array.ID, layer };
+    }
+
+    void TextureArrayPool::Release(uint32_t textureID)
+    {
+        auto it = s_Data->Locations.find(textureID);
+        if(it == s_Data->Locations.end())
+            return;
+
+        s_Data->Arrays[it->second.ArrayIndex].FreeLayers.push_back(it->second.Layer);
+        s_Data->Locations.erase(it);
+    }
+
+    void TextureArrayPool::Bind(uint32_t unit, uint32_t arrayID)
+    {
+        if(unit >= s_Data->BoundArrays.size())
+            s_Data->BoundArrays.resize(unit + 1, s_UnknownBinding);
+
+        if(s_Data->BoundArrays[unit] == arrayID)
+            return;
+
+        ZoneScoped;
+
+        glBindTextureUnit(unit, arrayID);
+        s_Data->BoundArrays[unit] = arrayID;
+    }
+
+    void TextureArrayPool::ResetBindings()
+    {
+        std::fill(s_Data->BoundArrays.begin(), s_Data->BoundArrays.end(), s_UnknownBinding);
+    }
+
+    void TextureArrayPool::Clear()
+    {
+        ZoneScoped;
+
+        for(TextureArray& array : s_Data->Arrays)
+        {
+            glDeleteTextures(1, &array.ID);
+        }
+
+        s_Data->Arrays.clear();
+        s_Data->Locations.clear();
+        s_Data->BoundArrays.clear();
+    }
+
+}
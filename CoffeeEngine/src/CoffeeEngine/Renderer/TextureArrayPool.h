@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+
+#include <cstdint>
+
+namespace Coffee {
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    class Texture2D;
+
+    /**
+     * @brief Location of a texture inside a texture array.
+     */
+    struct TextureArraySlot
+    {
+        uint32_t ArrayID = 0; ///< The OpenGL ID of the GL_TEXTURE_2D_ARRAY.
+        int Layer = 0; ///< The layer of the texture inside the array.
+    };
+
+    /**
+     * @brief Groups 2D textures of the same size and format into GL_TEXTURE_2D_ARRAY atlases.
+     *
+     * Used as the fallback when bindless textures are not available. Materials whose textures
+     * share size and format end up sampling the same arrays and only differ in the layer
+     * index, so consecutive draws do not need to rebind textures.
+     */
+    class TextureArrayPool
+    {
+    public:
+        /**
+         * @brief Gets the array slot of a texture, copying it into an array on first use.
+         *
+         * The texture then drops its own storage and becomes a view of its layer, so it is not kept
+         * twice in VRAM and can still be bound and displayed through its ID.
+         * @param texture The texture.
+         * @return The slot of the texture.
+         */
+        static TextureArraySlot Acquire(Texture2D& texture);
+
+        /**
+         * @brief Frees the layer used by a texture so it can be reused.
+         * @param textureID The OpenGL ID of the texture.
+         */
+        static void Release(uint32_t textureID);
+
+        /**
+         * @brief Binds an array to a texture unit, skipping the call if it is already bound.
+         * @param unit The texture unit.
+         * @param arrayID The OpenGL ID of the array.
+         */
+        static void Bind(uint32_t unit, uint32_t arrayID);
+
+        /**
+         * @brief Forgets the tracked texture unit bindings.
+         *
+         * Must be called when other code may have bound textures to the units used by materials.
+         */
+        static void ResetBindings();
+
+        /**
+         * @brief Deletes all the texture arrays.
+         *
+         * Textures already pooled keep viewing their layer, its storage is freed with the last of them.
+         */
+        static void Clear();
+    };
+
+    /** @} */
+}
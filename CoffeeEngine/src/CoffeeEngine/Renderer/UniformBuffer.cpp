@@ -11,6 +11,7 @@ namespace Coffee {
         glCreateBuffers(1, &m_uboID);
         glNamedBufferData(m_uboID, size, nullptr, GL_DYNAMIC_DRAW); //or GL_DYNAMIC_DRAW? Search what are the differences
         glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_uboID);
+        m_GpuMemory.Track(GpuMemoryType::Buffer, this, size);
     }
 
     UniformBuffer::~UniformBuffer()
@@ -284,6 +284,39 @@ namespace Coffee {
             archive(cereal::make_nvp("Color", Color), cereal::make_nvp("Direction", Direction), cereal::make_nvp("Position", Position), cereal::make_nvp("Range", Range), cereal::make_nvp("Attenuation", Attenuation), cereal::make_nvp("Intensity", Intensity), cereal::make_nvp("Angle", Angle), cereal::make_nvp("Type", type));
         }
     };
+
+    /**
+     * @brief Component marking an entity that does not move at runtime.
+     *
+     * When the runtime starts, the meshes of the static entities are merged with the other static
+     * meshes that share their material and spatial cell (see StaticBatcher).
+     * @ingroup scene
+     */
+    struct StaticComponent
+    {
+        bool Batched = true; ///< Merge the mesh into the static batches, otherwise it is drawn on its own.
+        bool Occluder = false; ///< Rasterize the mesh into the occlusion depth buffer, for large meshes that hide others.
+
+        StaticComponent() = default;
+        StaticComponent(const StaticComponent&) = default;
+
+        /**
+         * @brief Serializes the StaticComponent.
+         * @tparam Archive The type of the archive.
+         * @param archive The archive to serialize to.
+         * @param version The version of the component in the archive, 0 before the Occluder field.
+         */
+        template<class Archive>
+        void serialize(Archive& archive, std::uint32_t const version)
+        {
+            archive(cereal::make_nvp("Batched", Batched));
+
+            if(version >= 1)
+                archive(cereal::make_nvp("Occluder", Occluder));
+        }
+    };
 }
 
+CEREAL_CLASS_VERSION(Coffee::StaticComponent, 1);
+
 /** @} */
\ No newline at end of file
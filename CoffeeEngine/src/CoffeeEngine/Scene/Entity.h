@@ -67,6 +67,30 @@ namespace Coffee {
             return m_Scene->m_Registry.get<T>(m_EntityHandle);
         }
 
+        /**
+         * @brief Get a component from the entity if it has it.
+         * @tparam T The component type.
+         * @return Pointer to the component, nullptr if the entity does not have it.
+         */
+        template<typename T>
+        T* TryGetComponent()
+        {
+            return m_Scene->m_Registry.try_get<T>(m_EntityHandle);
+        }
+
+        /**
+         * @brief Get a component from the entity if it has it, without creating the storage of the component.
+         *
+         * Only reads the registry, so it can be called from several threads while nothing writes to it.
+         * @tparam T The component type.
+         * @return Pointer to the component, nullptr if the entity does not have it.
+         */
+        template<typename T>
+        const T* TryGetComponent() const
+        {
+            return std::as_const(m_Scene->m_Registry).try_get<T>(m_EntityHandle);
+        }
+
         /**
          * @brief Check if the entity has a component.
          * @tparam T The component type.
@@ -78,6 +102,19 @@ namespace Coffee {
             return m_Scene->m_Registry.all_of<T>(m_EntityHandle);
         }
 
+        /**
+         * @brief Check if the entity has a component, without creating the storage of the component.
+         *
+         * Only reads the registry, so it can be called from several threads while nothing writes to it.
+         * @tparam T The component type.
+         * @return True if the entity has the component, false otherwise.
+         */
+        template<typename T>
+        bool HasComponent() const
+        {
+            return std::as_const(m_Scene->m_Registry).all_of<T>(m_EntityHandle);
+        }
+
         /**
          * @brief Remove a component from the entity.
          * @tparam T The component type.
@@ -125,6 +162,12 @@ namespace Coffee {
          */
         bool operator!=(const Entity& other) const { return !operator==(other); }
 
+        /**
+         * @brief Get the scene the entity belongs to.
+         * @return The scene.
+         */
+        Scene* GetScene() const { return m_Scene; }
+
         /**
          * @brief Set the parent of the entity.
          * @param entity The parent entity.
@@ -0,0 +1,227 @@
+#include "EntityCommandBuffer.h"
+
+#include "CoffeeEngine/Core/Metrics.h"
+#include "CoffeeEngine/Scene/Components.h"
+#include "CoffeeEngine/Scene/Entity.h"
+#include "CoffeeEngine/Scene/Scene.h"
+#include "CoffeeEngine/Scene/SceneTree.h"
+
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    CommandTarget::CommandTarget(const Entity& entity)
+        : Handle((entt::entity)entity)
+    {
+    }
+
+    EntityCommandBuffer::EntityCommandBuffer(Scene* scene)
+        : m_Scene(scene)
+    {
+    }
+
+    PendingEntity EntityCommandBuffer::CreateEntity(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        PendingEntity entity = { m_PendingCount++ };
+        m_Names.push_back(name.empty() ? "Entity" : name);
+        m_Commands.push_back({ CommandType::CreateEntity, entity, {}, nullptr, (uint32_t)m_Names.size() - 1 });
+        return entity;
+    }
+
+    void EntityCommandBuffer::DestroyEntity(CommandTarget entity)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        m_Commands.push_back({ CommandType::DestroyEntity, entity, {}, nullptr, 0 });
+    }
+
+    void EntityCommandBuffer::SetParent(CommandTarget entity, CommandTarget parent)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        m_Commands.push_back({ CommandType::SetParent, entity, parent, nullptr, 0 });
+    }
+
+    size_t EntityCommandBuffer::GetCommandCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        return m_Commands.size();
+    }
+
+    entt::entity EntityCommandBuffer::Resolve(const CommandTarget& target) const
+    {
+        entt::entity entity = target.Pending != UINT32_MAX ? m_Created[target.Pending] : target.Handle;
+        return m_Scene->m_Registry.valid(entity) ? entity : entt::null;
+    }
+
+    void EntityCommandBuffer::Playback()
+    {
+        ZoneScoped;
+
+        static Metric& commandsMetric = Metrics::Counter("Entity Commands");
+
+        // The commands are taken first, the signals fired on playback can record new ones for the next playback
+        std::vector<Command> commands;
+        std::vector<std::string> names;
+        std::unordered_map<entt::id_type, Scope<ComponentValuesBase>> componentValues;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            if (m_Commands.empty())
+                return;
+
+            commands = std::move(m_Commands);
+            names = std::move(m_Names);
+            componentValues = std::move(m_ComponentValues);
+            m_Commands.clear();
+            m_Names.clear();
+            m_ComponentValues.clear();
+
+            m_Created.assign(m_PendingCount, entt::null);
+            m_PendingCount = 0;
+        }
+
+        commandsMetric.Add((double)commands.size());
+
+        entt::registry& registry = m_Scene->m_Registry;
+
+        std::vector<entt::entity> entities;
+        std::vector<uint32_t> values;
+
+        // Runs of consecutive commands of the same kind and component type become one operation
+        size_t runStart = 0;
+        while (runStart < commands.size())
+        {
+            const Command& first = commands[runStart];
+
+            size_t runEnd = runStart + 1;
+            while (runEnd < commands.size() && commands[runEnd].Type == first.Type && commands[runEnd].Component == first.Component)
+                runEnd++;
+
+            entities.clear();
+            values.clear();
+
+            switch (first.Type)
+            {
+                case CommandType::CreateEntity:
+                {
+                    ZoneScopedN("Create Entities");
+
+                    entities.resize(runEnd - runStart);
+                    registry.create(entities.begin(), entities.end());
+
+                    std::vector<TagComponent> tags;
+                    tags.reserve(entities.size());
+                    for (size_t i = runStart; i < runEnd; i++)
+                    {
+                        m_Created[commands[i].Target.Pending] = entities[i - runStart];
+                        tags.emplace_back(names[commands[i].Value]);
+                    }
+
+                    registry.insert<TransformComponent>(entities.begin(), entities.end());
+                    registry.insert<TagComponent>(entities.begin(), entities.end(), tags.begin());
+                    registry.insert<HierarchyComponent>(entities.begin(), entities.end());
+                    break;
+                }
+                case CommandType::DestroyEntity:
+                {
+                    ZoneScopedN("Destroy Entities");
+
+                    for (size_t i = runStart; i < runEnd; i++)
+                    {
+                        entt::entity entity = Resolve(commands[i].Target);
+                        if (entity != entt::null)
+                            HierarchyComponent::CollectSubtree(registry, entity, entities);
+                    }
+
+                    // An entity can be destroyed twice, directly and with its parent
+                    std::sort(entities.begin(), entities.end());
+                    entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+
+                    registry.destroy(entities.begin(), entities.end());
+                    break;
+                }
+                case CommandType::AddComponent:
+                {
+                    ZoneScopedN("Add Components");
+
+                    for (size_t i = runStart; i < runEnd; i++)
+                    {
+                        entt::entity entity = Resolve(commands[i].Target);
+                        if (entity == entt::null)
+                            continue;
+
+                        entities.push_back(entity);
+                        values.push_back(commands[i].Value);
+                    }
+
+                    if (!entities.empty())
+                        first.Component->Add(registry, entities, values);
+                    break;
+                }
+                case CommandType::EmplaceComponent:
+                {
+                    ZoneScopedN("Emplace Components");
+
+                    for (size_t i = runStart; i < runEnd; i++)
+                    {
+                        entt::entity entity = Resolve(commands[i].Target);
+                        if (entity != entt::null)
+                            entities.push_back(entity);
+                    }
+
+                    first.Component->Emplace(registry, entities);
+                    break;
+                }
+                case CommandType::RemoveComponent:
+                {
+                    ZoneScopedN("Remove Components");
+
+                    for (size_t i = runStart; i < runEnd; i++)
+                    {
+                        entt::entity entity = Resolve(commands[i].Target);
+                        if (entity != entt::null)
+                            entities.push_back(entity);
+                    }
+
+                    first.Component->Remove(registry, entities);
+                    break;
+                }
+                case CommandType::SetParent:
+                {
+                    ZoneScopedN("Set Parents");
+
+                    // The sibling lists are linked one entity at a time
+                    for (size_t i = runStart; i < runEnd; i++)
+                    {
+                        entt::entity entity = Resolve(commands[i].Target);
+                        bool toRoot = commands[i].Parent.Pending == UINT32_MAX && commands[i].Parent.Handle == entt::null;
+                        entt::entity parent = toRoot ? entt::null : Resolve(commands[i].Parent);
+
+                        if (entity != entt::null && (toRoot || parent != entt::null) && entity != parent)
+                            HierarchyComponent::Reparent(registry, entity, parent);
+                    }
+                    break;
+                }
+            }
+
+            runStart = runEnd;
+        }
+
+        m_Created.clear();
+    }
+
+    void EntityCommandBuffer::Clear()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        m_Commands.clear();
+        m_Names.clear();
+        m_ComponentValues.clear();
+        m_PendingCount = 0;
+    }
+
+}
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <entt/entt.hpp>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup scene Scene
+     * @{
+     */
+
+    class Entity;
+    class Scene;
+
+    /**
+     * @brief An entity the command buffer creates on playback.
+     *
+     * It can be the target of the commands recorded after it in the same buffer.
+     */
+    struct PendingEntity
+    {
+        uint32_t Index; ///< Order of the entity among the entities created by the buffer.
+    };
+
+    /**
+     * @brief The entity a command applies to, an existing entity or one created by the buffer.
+     */
+    struct CommandTarget
+    {
+        CommandTarget() = default;
+        CommandTarget(entt::entity entity) : Handle(entity) {}
+        CommandTarget(const Entity& entity);
+        CommandTarget(PendingEntity entity) : Pending(entity.Index) {}
+
+        entt::entity Handle = entt::null; ///< The existing entity, null for a pending one.
+        uint32_t Pending = UINT32_MAX; ///< Index of the pending entity, UINT32_MAX for an existing one.
+    };
+
+    /**
+     * @brief Records structural changes to a scene and applies them later, in bulk.
+     *
+     * Creating and destroying entities and adding and removing components reallocates the entt pools,
+     * which is not safe while iterating views or from other threads. The commands can be recorded from
+     * any thread and are applied in the order they were recorded by Playback(), on the main thread, at
+     * points of the frame where no view is iterated. Consecutive commands of the same kind, and of the
+     * same component type, are applied as one range operation on the pool, so the pool is looked up
+     * once and its signals fire together.
+     *
+     * Commands targeting an entity that no longer exists at playback are skipped.
+     */
+    class EntityCommandBuffer
+    {
+    public:
+        /**
+         * @brief Constructor for EntityCommandBuffer.
+         * @param scene The scene the commands apply to.
+         */
+        EntityCommandBuffer(Scene* scene);
+
+        EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+        EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+
+        /**
+         * @brief Records the creation of an entity, with the components of Scene::CreateEntity.
+         * @param name The name of the entity.
+         * @return The entity, to use as the target of later commands of this buffer.
+         */
+        PendingEntity CreateEntity(const std::string& name = std::string());
+
+        /**
+         * @brief Records the destruction of an entity and its children.
+         * @param entity The entity.
+         */
+        void DestroyEntity(CommandTarget entity);
+
+        /**
+         * @brief Records adding a component, replacing it if the entity already has it.
+         * @tparam T The component type.
+         * @param entity The entity.
+         * @param component The value of the component.
+         */
+        template<typename T>
+        void AddComponent(CommandTarget entity, T component = T())
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            ComponentValues<T>& values = GetComponentValues<T>();
+            values.Values.push_back(std::move(component));
+            m_Commands.push_back({ CommandType::AddComponent, entity, {}, &values, (uint32_t)values.Values.size() - 1 });
+        }
+
+        /**
+         * @brief Records adding a default constructed component, if the entity does not have it yet.
+         *
+         * The component is constructed on playback, on the main thread, so components whose constructor
+         * loads resources can be added from other threads.
+         * @tparam T The component type.
+         * @param entity The entity.
+         */
+        template<typename T>
+        void EmplaceComponent(CommandTarget entity)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            m_Commands.push_back({ CommandType::EmplaceComponent, entity, {}, &GetComponentValues<T>(), 0 });
+        }
+
+        /**
+         * @brief Records removing a component, if the entity has it.
+         * @tparam T The component type.
+         * @param entity The entity.
+         */
+        template<typename T>
+        void RemoveComponent(CommandTarget entity)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            m_Commands.push_back({ CommandType::RemoveComponent, entity, {}, &GetComponentValues<T>(), 0 });
+        }
+
+        /**
+         * @brief Records moving an entity under another parent.
+         * @param entity The entity.
+         * @param parent The new parent, a null entity to make it a root.
+         */
+        void SetParent(CommandTarget entity, CommandTarget parent);
+
+        /**
+         * @brief Applies the recorded commands and clears the buffer. Main thread only.
+         */
+        void Playback();
+
+        /**
+         * @brief Drops the recorded commands without applying them.
+         */
+        void Clear();
+
+        /**
+         * @brief Gets the number of recorded commands.
+         * @return The number of commands waiting for playback.
+         */
+        size_t GetCommandCount() const;
+
+    private:
+        enum class CommandType : uint8_t
+        {
+            CreateEntity,
+            DestroyEntity,
+            AddComponent,
+            EmplaceComponent,
+            RemoveComponent,
+            SetParent
+        };
+
+        // The values of the recorded AddComponent of one component type, and the range operations on its pool
+        struct ComponentValuesBase
+        {
+            virtual ~ComponentValuesBase() = default;
+            virtual void Add(entt::registry& registry, const std::vector<entt::entity>& entities, const std::vector<uint32_t>& values) = 0;
+            virtual void Emplace(entt::registry& registry, const std::vector<entt::entity>& entities) = 0;
+            virtual void Remove(entt::registry& registry, const std::vector<entt::entity>& entities) = 0;
+        };
+
+        template<typename T>
+        struct ComponentValues : ComponentValuesBase
+        {
+            std::vector<T> Values;
+
+            void Add(entt::registry& registry, const std::vector<entt::entity>& entities, const std::vector<uint32_t>& values) override
+            {
+                auto& storage = registry.storage<T>();
+
+                // One insert when the values are in order and every entity is new to the pool
+                bool contiguous = values.back() - values.front() + 1 == (uint32_t)values.size();
+                bool bulk = contiguous && std::none_of(entities.begin(), entities.end(), [&storage](entt::entity entity) {
+                    return storage.contains(entity);
+                });
+
+                if (bulk)
+                {
+                    std::vector<entt::entity> sorted = entities;
+                    std::sort(sorted.begin(), sorted.end());
+                    bulk = std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end();
+                }
+
+                if (bulk)
+                {
+                    registry.insert<T>(entities.begin(), entities.end(), Values.begin() + values.front());
+                    return;
+                }
+
+                for (size_t i = 0; i < entities.size(); i++)
+                {
+                    registry.emplace_or_replace<T>(entities[i], std::move(Values[values[i]]));
+                }
+            }
+
+            void Emplace(entt::registry& registry, const std::vector<entt::entity>& entities) override
+            {
+                auto& storage = registry.storage<T>();
+
+                for (entt::entity entity : entities)
+                {
+                    if (!storage.contains(entity))
+                        registry.emplace<T>(entity);
+                }
+            }
+
+            void Remove(entt::registry& registry, const std::vector<entt::entity>& entities) override
+            {
+                registry.remove<T>(entities.begin(), entities.end());
+            }
+
+        };
+
+        struct Command
+        {
+            CommandType Type;
+            CommandTarget Target; ///< The entity the command applies to.
+            CommandTarget Parent; ///< New parent of SetParent.
+            ComponentValuesBase* Component; ///< Component type of AddComponent, EmplaceComponent and RemoveComponent.
+            uint32_t Value; ///< Index of the component value of AddComponent, or of the name of CreateEntity.
+        };
+
+        template<typename T>
+        ComponentValues<T>& GetComponentValues()
+        {
+            Scope<ComponentValuesBase>& values = m_ComponentValues[entt::type_hash<T>::value()];
+            if (!values)
+                values = CreateScope<ComponentValues<T>>();
+            return static_cast<ComponentValues<T>&>(*values);
+        }
+
+        entt::entity Resolve(const CommandTarget& target) const;
+
+    private:
+        Scene* m_Scene;
+        mutable std::mutex m_Mutex; ///< Protects the recorded commands.
+        std::vector<Command> m_Commands; ///< The commands, in recording order.
+        std::vector<std::string> m_Names; ///< Names of the created entities.
+        std::unordered_map<entt::id_type, Scope<ComponentValuesBase>> m_ComponentValues; ///< Values of AddComponent per component type.
+        uint32_t m_PendingCount = 0; ///< Entities created by the buffer.
+        std::vector<entt::entity> m_Created; ///< Handles of the pending entities during playback.
+    };
+
+    /** @} */ // end of scene group
+}
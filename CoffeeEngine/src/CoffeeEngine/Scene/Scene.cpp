@@ -2,6 +2,8 @@
 
 #include "CoffeeEngine/Core/Base.h"
 #include "CoffeeEngine/Core/DataStructures/Octree.h"
+#include "CoffeeEngine/Core/FrameAllocator.h"
+#include "CoffeeEngine/Core/MemoryProfiler.h"
 #include "CoffeeEngine/Math/Frustum.h"
 #include "CoffeeEngine/Renderer/DebugRenderer.h"
 #include "CoffeeEngine/Renderer/EditorCamera.h"
@@ -11,6 +13,7 @@
 #include "CoffeeEngine/Scene/Components.h"
 #include "CoffeeEngine/Scene/Entity.h"
 #include "CoffeeEngine/Scene/PrimitiveMesh.h"
+#include "CoffeeEngine/Scene/SceneBinarySerializer.h"
 #include "CoffeeEngine/Scene/SceneCamera.h"
 #include "CoffeeEngine/Scene/SceneTree.h"
 #include "CoffeeEngine/Scripting/Lua/LuaBackend.h"
@@ -21,10 +24,13 @@
 
 #include <cstdint>
 #include <cstdlib>
+#include <limits>
 #include <glm/detail/type_quat.hpp>
 #include <glm/fwd.hpp>
 #include <string>
+#include <thread>
 #include <tracy/Tracy.hpp>
+#include <vector>
 
 #include <CoffeeEngine/Scripting/Script.h>
 #include <cereal/archives/json.hpp>
@@ -35,16 +41,17 @@ namespace Coffee {
     Scene::Scene() : m_Octree({glm::vec3(-50.0f), glm::vec3(50.0f)}, 10, 5)
     {
         m_SceneTree = CreateScope<SceneTree>(this);
+        m_CommandBuffer = CreateScope<EntityCommandBuffer>(this);
+
+        m_Registry.on_construct<ScriptComponent>().connect<&ScriptComponent::OnConstruct>(*this);
+        m_Registry.on_destroy<ScriptComponent>().connect<&ScriptComponent::OnDestroy>(*this);
     }
 
-/*     Scene::Scene(Ref<Scene> other)
+    Scene::~Scene()
     {
-        auto& srcRegistry = other->m_Registry;
-        auto& dstRegistry = m_Registry;
-
-        auto view = srcRegistry.view<entt::entity>();
-        dstRegistry.insert(view->data(), view->data() + view->size(), view->raw(), view->raw() + view.size());
-    } */
+        // Fires OnDestroy, so the scripting backends drop the instances pointing to this scene
+        m_Registry.clear<ScriptComponent>();
+    }
 
     Entity Scene::CreateEntity(const std::string& name)
     {
@@ -60,22 +67,19 @@ namespace Coffee {
 
     void Scene::DestroyEntity(Entity entity)
     {
-        auto& hierarchyComponent = m_Registry.get<HierarchyComponent>(entity);
-        auto curr = hierarchyComponent.m_First;
+        ZoneScoped;
 
-        while(curr != entt::null)
-        {
-            Entity e{curr, this};
-            curr = m_Registry.get<HierarchyComponent>(curr).m_Next;
-            DestroyEntity(e);
-        }
+        // The whole subtree is destroyed with one range operation on every pool
+        std::vector<entt::entity> entities;
+        HierarchyComponent::CollectSubtree(m_Registry, entity, entities);
 
-        m_Registry.destroy((entt::entity)entity);
+        m_Registry.destroy(entities.begin(), entities.end());
     }
 
     void Scene::OnInitEditor()
     {
         ZoneScoped;
+        COFFEE_MEMORY_TAG(Scene);
 
        /*  Entity light = CreateEntity("Directional Light");
         light.AddComponent<LightComponent>().Color = {1.0f, 0.9f, 0.85f};
@@ -94,13 +98,42 @@ namespace Coffee {
     void Scene::OnInitRuntime()
     {
         ZoneScoped;
+        COFFEE_MEMORY_TAG(Scene);
+
+        // The octree is only built here, every entity has to be loaded
+        FinishStreaming();
 
         m_SceneTree->Update();
 
+        // The static meshes are drawn through the batches of their material and cell
+        m_StaticBatches = StaticBatcher::Build(m_Registry);
+
+        for (auto& batch : m_StaticBatches)
+        {
+            ObjectContainer<Ref<Mesh>> objectContainer = {batch.Transform, batch.MergedMesh->GetAABB(), batch.MergedMesh};
+
+            m_Octree.Insert(objectContainer);
+        }
+
+        // The occluders are static, their vertices are transformed once
+        m_OcclusionCuller.ClearOccluders();
+        auto occluderView = m_Registry.view<StaticComponent, MeshComponent, TransformComponent>();
+        for (auto& entity : occluderView)
+        {
+            auto [staticComponent, meshComponent, transformComponent] = occluderView.get<StaticComponent, MeshComponent, TransformComponent>(entity);
+
+            if(staticComponent.Occluder)
+                m_OcclusionCuller.AddOccluder(meshComponent.GetMesh(), transformComponent.GetWorldTransform());
+        }
+
         auto view = m_Registry.view<MeshComponent>();
 
         for (auto& entity : view)
         {
+            auto* staticComponent = m_Registry.try_get<StaticComponent>(entity);
+            if(staticComponent && staticComponent->Batched)
+                continue;
+
             auto& meshComponent = view.get<MeshComponent>(entity);
             auto& transformComponent = m_Registry.get<TransformComponent>(entity);
 
@@ -110,9 +143,28 @@ namespace Coffee {
         }
     }
 
+    void Scene::BakeStaticBatches()
+    {
+        ZoneScoped;
+        COFFEE_MEMORY_TAG(Scene);
+
+        FinishStreaming();
+
+        m_SceneTree->Update();
+
+        // Only the cache is kept, the editor draws every entity on its own
+        StaticBatcher::Build(m_Registry, StaticBatcher::DefaultCellSize, false);
+    }
+
     void Scene::OnUpdateEditor(EditorCamera& camera, float dt)
     {
         ZoneScoped;
+        COFFEE_MEMORY_TAG(Scene);
+
+        UpdateStreaming();
+
+        // Changes recorded since the last update, before the transforms are propagated
+        m_CommandBuffer->Playback();
 
         m_SceneTree->Update();
 
@@ -160,6 +212,12 @@ namespace Coffee {
     void Scene::OnUpdateRuntime(float dt)
     {
         ZoneScoped;
+        COFFEE_MEMORY_TAG(Scene);
+
+        UpdateStreaming();
+
+        // Changes recorded since the last update, before the transforms are propagated
+        m_CommandBuffer->Playback();
 
         m_SceneTree->Update();
 
@@ -197,10 +255,28 @@ namespace Coffee {
         Frustum frustum = Frustum(camera->GetProjection() /* testProjection */ * glm::inverse(cameraTransform));
         DebugRenderer::DrawFrustum(frustum, glm::vec4(1.0f), 1.0f);
 
-        auto meshes = m_Octree.Query(frustum);
+        FrameVector<ObjectContainer<Ref<Mesh>>> meshes;
+        m_Octree.Query(frustum, meshes);
 
+        // The meshes hidden behind the occluders are not submitted
+        m_OcclusionCuller.Rasterize(camera->GetProjection() * glm::inverse(cameraTransform));
+
+        FrameVector<AABB> bounds;
+        bounds.reserve(meshes.size());
         for(auto& mesh : meshes)
         {
+            bounds.push_back(mesh.aabb.CalculateTransformedAABB(mesh.transform));
+        }
+
+        FrameVector<uint8_t> visible(meshes.size());
+        m_OcclusionCuller.TestVisibility(bounds.data(), bounds.size(), visible.data());
+
+        for(size_t i = 0; i < meshes.size(); i++)
+        {
+            if(!visible[i])
+                continue;
+
+            auto& mesh = meshes[i];
             Renderer::Submit(RenderCommand{mesh.transform, mesh.object, mesh.object->GetMaterial(), 0});
         }
         
@@ -236,19 +312,16 @@ namespace Coffee {
             Renderer::Submit(lightComponent);
         }
 
-        // Get all entities with ScriptComponent
-        auto scriptView = m_Registry.view<ScriptComponent>();
-
-        for (auto& entity : scriptView)
+        // Update the script instances, one call per script for all the entities using it
         {
-            Entity scriptEntity{entity, this};
-            ScriptManager::RegisterVariable("entity", (void*)&scriptEntity);
+            COFFEE_MEMORY_TAG(Scripting);
 
-            auto& scriptComponent = scriptView.get<ScriptComponent>(entity);
-
-            scriptComponent.script.OnUpdate();
+            ScriptManager::UpdateInstances(this);
         }
 
+        // Changes recorded by the scripts
+        m_CommandBuffer->Playback();
+
         Renderer::EndScene();
     }
 
@@ -270,66 +343,215 @@ namespace Coffee {
     Ref<Scene> Scene::Load(const std::filesystem::path& path)
     {
         ZoneScoped;
+        COFFEE_MEMORY_TAG(Scene);
 
         Ref<Scene> scene = CreateRef<Scene>();
 
-        std::ifstream sceneFile(path);
-        cereal::JSONInputArchive archive(sceneFile);
-
-        entt::snapshot_loader{scene->m_Registry}
-            .get<entt::entity>(archive)
-            .get<TagComponent>(archive)
-            .get<TransformComponent>(archive)
-            .get<HierarchyComponent>(archive)
-            .get<CameraComponent>(archive)
-            .get<MeshComponent>(archive)
-            .get<MaterialComponent>(archive)
-            .get<LightComponent>(archive);
+        if(SceneBinarySerializer::IsBinaryScene(path))
+        {
+            SceneSettings settings;
+            if(!SceneBinarySerializer::Load(path, scene->m_Registry, settings))
+                return nullptr;
+
+            scene->SetSettings(settings);
+        }
+        else
+        {
+            std::ifstream sceneFile(path);
+            cereal::JSONInputArchive archive(sceneFile);
+
+            // The loaded hierarchy links are already complete
+            HierarchyConstructGuard hierarchyGuard(scene->m_Registry);
+
+            entt::snapshot_loader loader{scene->m_Registry};
+            loader
+                .get<entt::entity>(archive)
+                .get<TagComponent>(archive)
+                .get<TransformComponent>(archive)
+                .get<HierarchyComponent>(archive)
+                .get<CameraComponent>(archive)
+                .get<MeshComponent>(archive)
+                .get<MaterialComponent>(archive)
+                .get<LightComponent>(archive);
+
+            // Scenes saved before static entities existed end here, and unversioned static components can not be read
+            try
+            {
+                loader.get<StaticComponent>(archive);
+            }
+            catch(const cereal::Exception& e)
+            {
+                COFFEE_CORE_WARN("Scene::Load: No static components read from {0}, it was saved by an older version: {1}", path.string(), e.what());
+            }
+
+            // Scenes saved before the settings existed keep the defaults
+            SceneSettings settings;
+            try
+            {
+                archive(cereal::make_nvp("Settings", settings));
+            }
+            catch(const cereal::Exception& e)
+            {
+                COFFEE_CORE_WARN("Scene::Load: No settings read from {0}, using the defaults: {1}", path.string(), e.what());
+            }
+
+            scene->SetSettings(settings);
+        }
         
         scene->m_FilePath = path;
 
-        auto view = scene->m_Registry.view<entt::entity>();
-        for (auto entity : view)
+        COFFEE_CORE_INFO("Scene::Load: Loaded {0}", path.string());
+
+        return scene;
+    }
+
+    template<typename Component>
+    static void CopyComponentPool(entt::registry& source, entt::registry& destination)
+    {
+        auto& storage = source.storage<Component>();
+
+        if(storage.empty())
+            return;
+
+        std::vector<entt::entity> entities;
+        std::vector<Component> components;
+        entities.reserve(storage.size());
+        components.reserve(storage.size());
+
+        for(auto [entity, component] : storage.each())
+        {
+            entities.push_back(entity);
+            components.push_back(component);
+        }
+
+        destination.insert<Component>(entities.begin(), entities.end(), components.begin());
+    }
+
+    Ref<Scene> Scene::Copy(const Ref<Scene>& other)
+    {
+        ZoneScoped;
+        COFFEE_MEMORY_TAG(Scene);
+
+        other->FinishStreaming();
+
+        Ref<Scene> scene = CreateRef<Scene>();
+        scene->m_FilePath = other->m_FilePath;
+        scene->SetSettings(other->m_Settings);
+
+        auto& source = other->m_Registry;
+        auto& destination = scene->m_Registry;
+
+        for(auto entity : source.view<entt::entity>())
         {
-            auto& tag = scene->m_Registry.get<TagComponent>(entity);
-            auto& hierarchy = scene->m_Registry.get<HierarchyComponent>(entity);
+            destination.create(entity);
+        }
 
-            COFFEE_INFO("Entity {0}, {1}", (uint32_t)entity, tag.Tag);
+        {
+            // The copied hierarchy links are already complete
+            HierarchyConstructGuard hierarchyGuard(destination);
+
+            CopyComponentPool<TagComponent>(source, destination);
+            CopyComponentPool<TransformComponent>(source, destination);
+            CopyComponentPool<HierarchyComponent>(source, destination);
+            CopyComponentPool<CameraComponent>(source, destination);
+            CopyComponentPool<MeshComponent>(source, destination);
+            CopyComponentPool<MaterialComponent>(source, destination);
+            CopyComponentPool<LightComponent>(source, destination);
+            CopyComponentPool<StaticComponent>(source, destination);
         }
 
+        // Last, so the entities are complete when the construct hook creates a new instance of each script from its path
+        CopyComponentPool<ScriptComponent>(source, destination);
+
         return scene;
     }
 
-    void Scene::Save(const std::filesystem::path& path, Ref<Scene> scene)
+    Ref<Scene> Scene::LoadAsync(const std::filesystem::path& path)
     {
         ZoneScoped;
 
-        std::ofstream sceneFile(path);
-        cereal::JSONOutputArchive archive(sceneFile);
-
-        //archive(*scene);
-
-        //TEMPORAL
-        entt::snapshot{scene->m_Registry}
-            .get<entt::entity>(archive)
-            .get<TagComponent>(archive)
-            .get<TransformComponent>(archive)
-            .get<HierarchyComponent>(archive)
-            .get<CameraComponent>(archive)
-            .get<MeshComponent>(archive)
-            .get<MaterialComponent>(archive)
-            .get<LightComponent>(archive);
-        
+        if(!SceneBinarySerializer::IsBinaryScene(path))
+            return Load(path);
+
+        Ref<Scene> scene = CreateRef<Scene>();
         scene->m_FilePath = path;
+        scene->m_Streamer = CreateScope<SceneStreamer>(path, scene->m_Registry);
 
-        auto view = scene->m_Registry.view<entt::entity>();
-        for (auto entity : view)
+        // Same as Load, a corrupt or outdated file is not opened as an empty scene
+        if(!scene->m_Streamer->IsValid())
+            return nullptr;
+
+        scene->SetSettings(scene->m_Streamer->GetSettings());
+
+        return scene;
+    }
+
+    void Scene::UpdateStreaming()
+    {
+        if(!m_Streamer)
+            return;
+
+        if(m_Streamer->Update())
         {
-            auto& tag = scene->m_Registry.get<TagComponent>(entity);
-            auto& hierarchy = scene->m_Registry.get<HierarchyComponent>(entity);
+            m_Streamer.reset();
+        }
+    }
+
+    void Scene::FinishStreaming()
+    {
+        if(!m_Streamer)
+            return;
+
+        ZoneScoped;
 
-            COFFEE_INFO("Entity {0}, {1}", (uint32_t)entity, tag.Tag);
+        while(!m_Streamer->Update(std::numeric_limits<double>::max()))
+        {
+            std::this_thread::yield();
         }
+
+        m_Streamer.reset();
+    }
+
+    void Scene::Save(const std::filesystem::path& path, Ref<Scene> scene, ResourceFormat format)
+    {
+        ZoneScoped;
+        COFFEE_MEMORY_TAG(Scene);
+
+        scene->FinishStreaming();
+
+        if(format == ResourceFormat::Binary)
+        {
+            SceneBinarySerializer::Save(path, scene->m_Registry, scene->m_Settings);
+        }
+        else
+        {
+            std::ofstream sceneFile(path);
+            cereal::JSONOutputArchive archive(sceneFile);
+
+            //archive(*scene);
+
+            //TEMPORAL
+            entt::snapshot{scene->m_Registry}
+                .get<entt::entity>(archive)
+                .get<TagComponent>(archive)
+                .get<TransformComponent>(archive)
+                .get<HierarchyComponent>(archive)
+                .get<CameraComponent>(archive)
+                .get<MeshComponent>(archive)
+                .get<MaterialComponent>(archive)
+                .get<LightComponent>(archive)
+                .get<StaticComponent>(archive);
+
+            archive(cereal::make_nvp("Settings", scene->m_Settings));
+        }
+        
+        scene->m_FilePath = path;
+    }
+
+    void Scene::SetSettings(const SceneSettings& settings)
+    {
+        m_Settings = settings;
+        m_SceneTree->SetSorted(settings.SortedTransforms);
     }
 
     // Is possible that this function will be moved to the SceneTreePanel but for now it will stay here
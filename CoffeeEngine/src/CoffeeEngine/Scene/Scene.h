@@ -2,8 +2,14 @@
 
 #include "CoffeeEngine/Core/DataStructures/Octree.h"
 #include "CoffeeEngine/Events/Event.h"
+#include "CoffeeEngine/IO/ResourceFormat.h"
 #include "CoffeeEngine/Renderer/EditorCamera.h"
+#include "CoffeeEngine/Renderer/OcclusionCuller.h"
+#include "CoffeeEngine/Scene/EntityCommandBuffer.h"
+#include "CoffeeEngine/Scene/SceneSettings.h"
+#include "CoffeeEngine/Scene/SceneStreamer.h"
 #include "CoffeeEngine/Scene/SceneTree.h"
+#include "CoffeeEngine/Scene/StaticBatcher.h"
 #include "entt/entity/fwd.hpp"
 
 #include <entt/entt.hpp>
@@ -33,11 +39,9 @@ namespace Coffee {
         Scene();
 
         /**
-         * @brief Default destructor.
+         * @brief Destructor, destroys the script instances of the scene.
          */
-        ~Scene() = default;
-
-        //Scene(Ref<Scene> other);
+        ~Scene();
 
         /**
          * @brief Create an entity in the scene.
@@ -47,11 +51,37 @@ namespace Coffee {
         Entity CreateEntity(const std::string& name = std::string());
 
         /**
-         * @brief Destroy an entity in the scene.
+         * @brief Destroy an entity and its children in the scene.
          * @param entity The entity to destroy.
          */
         void DestroyEntity(Entity entity);
 
+        /**
+         * @brief Get the command buffer of the scene.
+         *
+         * Its commands are played back at the start of the update and after the scripts have run.
+         * @return The command buffer.
+         */
+        EntityCommandBuffer& GetCommandBuffer() { return *m_CommandBuffer; }
+
+        /**
+         * @brief Get the scene tree, which propagates the transforms of the hierarchy.
+         * @return The scene tree.
+         */
+        SceneTree& GetSceneTree() { return *m_SceneTree; }
+
+        /**
+         * @brief Get the settings of the scene.
+         * @return The settings, saved with the scene.
+         */
+        const SceneSettings& GetSettings() const { return m_Settings; }
+
+        /**
+         * @brief Set the settings of the scene and apply them.
+         * @param settings The new settings.
+         */
+        void SetSettings(const SceneSettings& settings);
+
         /**
          * @brief Initialize the scene.
          */
@@ -83,6 +113,11 @@ namespace Coffee {
         void OnExitEditor();
         void OnExitRuntime();
 
+        /**
+         * @brief Merge the static meshes into batches and write them to the cache, so the runtime starts faster.
+         */
+        void BakeStaticBatches();
+
         template<typename... Components>
         auto GetAllEntitiesWithComponents()
         {
@@ -90,29 +125,80 @@ namespace Coffee {
         }
 
         /**
-         * @brief Load a scene from a file.
+         * @brief Create an in-memory copy of a scene.
+         *
+         * Every component pool is cloned directly between the registries, keeping the entity
+         * identifiers, so the HierarchyComponent links of the copy are valid as they are.
+         * The scripts are instantiated again from their paths, the state of the source instances is not copied.
+         * @param other The scene to copy.
+         * @return The copy of the scene.
+         */
+        static Ref<Scene> Copy(const Ref<Scene>& other);
+
+        /**
+         * @brief Load a scene from a file. The binary and JSON formats are detected from the file header.
          * @param path The path to the file.
-         * @return The loaded scene.
+         * @return The loaded scene, or nullptr if the binary scene could not be read.
          */
         static Ref<Scene> Load(const std::filesystem::path& path);
 
+        /**
+         * @brief Load a scene progressively.
+         *
+         * Binary scenes are deserialized on worker threads and merged into the scene a few hierarchies
+         * per frame by OnUpdateEditor and OnUpdateRuntime. JSON scenes are loaded synchronously.
+         * @param path The path to the file.
+         * @return The scene, empty at first for binary scenes, or nullptr if the file could not be read.
+         */
+        static Ref<Scene> LoadAsync(const std::filesystem::path& path);
+
+        /**
+         * @brief Check if the scene is still being streamed in.
+         * @return True while sections of the scene are waiting to be merged.
+         */
+        bool IsStreaming() const { return m_Streamer != nullptr; }
+
+        /**
+         * @brief Get the streaming progress.
+         * @return The fraction of the scene loaded, between 0 and 1.
+         */
+        float GetStreamingProgress() const { return m_Streamer ? m_Streamer->GetProgress() : 1.0f; }
+
         /**
          * @brief Save a scene to a file.
          * @param path The path to the file.
          * @param scene The scene to save.
+         * @param format JSON for a diffable text file, Binary for the fast chunked format.
          */
-        static void Save(const std::filesystem::path& path, Ref<Scene> scene);
+        static void Save(const std::filesystem::path& path, Ref<Scene> scene, ResourceFormat format = ResourceFormat::JSON);
 
         const std::filesystem::path& GetFilePath() { return m_FilePath; }
+    private:
+        /**
+         * @brief Merge the streamed sections that are ready, within the frame budget.
+         */
+        void UpdateStreaming();
+
+        /**
+         * @brief Block until the whole scene has been streamed in.
+         */
+        void FinishStreaming();
+
     private:
         entt::registry m_Registry;
         Scope<SceneTree> m_SceneTree;
+        SceneSettings m_Settings; ///< Saved with the scene, applied by SetSettings.
         Octree<Ref<Mesh>> m_Octree;
+        std::vector<StaticBatch> m_StaticBatches; ///< The merged static meshes, referenced by the octree.
+        OcclusionCuller m_OcclusionCuller; ///< Hides the meshes behind the static occluders at runtime.
+        Scope<SceneStreamer> m_Streamer; ///< Streams the scene in when loaded with LoadAsync.
+        Scope<EntityCommandBuffer> m_CommandBuffer; ///< Structural changes deferred to the playback points of the update.
 
         // Temporal: Scenes should be Resources and the Base Resource class already has a path variable.
         std::filesystem::path m_FilePath;
 
         friend class Entity;
+        friend class EntityCommandBuffer;
         friend class SceneTree;
         friend class SceneTreePanel;
 
@@ -0,0 +1,459 @@
+#include "SceneBinarySerializer.h"
+
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/IO/ResourceRegistry.h"
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    // How a component is written to and read from a chunk. Components that reference resources
+    // only store the UUID, their default constructors create resources and are too slow for bulk loads.
+    template<typename Component>
+    struct ChunkComponent
+    {
+        static void Write(cereal::BinaryOutputArchive& archive, const Component& component)
+        {
+            archive(component);
+        }
+    };
+
+    template<>
+    struct ChunkComponent<MeshComponent>
+    {
+        static void Write(cereal::BinaryOutputArchive& archive, const MeshComponent& component)
+        {
+            UUID meshUUID = component.mesh ? component.mesh->GetUUID() : UUID::null;
+            archive(meshUUID);
+        }
+    };
+
+    template<>
+    struct ChunkComponent<MaterialComponent>
+    {
+        static void Write(cereal::BinaryOutputArchive& archive, const MaterialComponent& component)
+        {
+            UUID materialUUID = component.material ? component.material->GetUUID() : UUID::null;
+            archive(materialUUID);
+        }
+    };
+
+    template<typename Component>
+    static void WriteChunk(cereal::BinaryOutputArchive& archive, entt::registry& registry, SceneChunk chunk, const std::vector<entt::entity>& sectionEntities, uint32_t& chunkCount)
+    {
+        auto& storage = registry.storage<Component>();
+
+        std::vector<uint32_t> entities;
+        for(entt::entity entity : sectionEntities)
+        {
+            if(storage.contains(entity))
+                entities.push_back(entt::to_integral(entity));
+        }
+
+        if(entities.empty())
+            return;
+
+        std::ostringstream payload(std::ios::binary);
+        {
+            cereal::BinaryOutputArchive payloadArchive(payload);
+            payloadArchive(entities);
+
+            for(uint32_t id : entities)
+            {
+                ChunkComponent<Component>::Write(payloadArchive, storage.get(entt::entity{id}));
+            }
+        }
+
+        const std::string& bytes = payload.str();
+        archive(static_cast<uint32_t>(chunk), static_cast<uint32_t>(entities.size()), static_cast<uint64_t>(bytes.size()));
+        archive(cereal::binary_data(bytes.data(), bytes.size()));
+
+        chunkCount++;
+    }
+
+    template<typename Stored>
+    static void ReadChunk(cereal::BinaryInputArchive& archive, SceneSectionPool<Stored>& pool, uint32_t count)
+    {
+        std::vector<uint32_t> ids;
+        archive(ids);
+
+        pool.Entities.reserve(pool.Entities.size() + ids.size());
+        for(uint32_t id : ids)
+        {
+            pool.Entities.push_back(entt::entity{id});
+        }
+
+        pool.Components.reserve(pool.Components.size() + count);
+        for(uint32_t i = 0; i < count; i++)
+        {
+            Stored component;
+            archive(component);
+            pool.Components.push_back(std::move(component));
+        }
+    }
+
+    template<typename Component>
+    static void InsertPool(entt::registry& registry, SceneSectionPool<Component>& pool)
+    {
+        if(pool.Entities.empty())
+            return;
+
+        // One allocation and one signal pass for the whole pool
+        registry.insert<Component>(pool.Entities.begin(), pool.Entities.end(), pool.Components.begin());
+
+        pool = {};
+    }
+
+    // Drops the components of the entities destroyed since they were reserved
+    template<typename Stored>
+    static void DropDestroyed(entt::registry& registry, SceneSectionPool<Stored>& pool)
+    {
+        size_t kept = 0;
+        for(size_t i = 0; i < pool.Entities.size(); i++)
+        {
+            if(!registry.valid(pool.Entities[i]))
+                continue;
+
+            pool.Entities[kept] = pool.Entities[i];
+            pool.Components[kept] = std::move(pool.Components[i]);
+            kept++;
+        }
+
+        pool.Entities.resize(kept);
+        pool.Components.resize(kept);
+    }
+
+    // Collects the entity and all its descendants, parents before children
+    static void CollectHierarchy(entt::registry& registry, entt::entity entity, std::vector<entt::entity>& entities)
+    {
+        if(registry.all_of<HierarchyComponent>(entity))
+            HierarchyComponent::CollectSubtree(registry, entity, entities);
+        else
+            entities.push_back(entity);
+    }
+
+    bool SceneBinarySerializer::IsBinaryScene(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+
+        uint32_t magic = 0;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+
+        return file && magic == Magic;
+    }
+
+    bool SceneBinarySerializer::Save(const std::filesystem::path& path, entt::registry& registry, const SceneSettings& settings, uint32_t sectionSize)
+    {
+        ZoneScoped;
+
+        std::ofstream file(path, std::ios::binary);
+
+        if(!file)
+        {
+            COFFEE_CORE_ERROR("SceneBinarySerializer::Save: Could not open {0} for writing", path.string());
+            return false;
+        }
+
+        // Group whole hierarchies into sections of about sectionSize entities
+        std::vector<std::vector<entt::entity>> sections(1);
+        for(auto entity : registry.view<entt::entity>())
+        {
+            auto* hierarchy = registry.try_get<HierarchyComponent>(entity);
+            if(hierarchy != nullptr && hierarchy->m_Parent != entt::null)
+                continue;
+
+            if(sections.back().size() >= sectionSize)
+                sections.emplace_back();
+
+            CollectHierarchy(registry, entity, sections.back());
+        }
+
+        if(sections.back().empty())
+            sections.pop_back();
+
+        // Every saved identifier, so a load can reserve them all before the first section is merged
+        std::vector<uint32_t> entityTable;
+        for(const std::vector<entt::entity>& sectionEntities : sections)
+        {
+            for(entt::entity entity : sectionEntities)
+            {
+                entityTable.push_back(entt::to_integral(entity));
+            }
+        }
+
+        cereal::BinaryOutputArchive archive(file);
+        archive(Magic, Version, settings, static_cast<uint32_t>(sections.size()));
+        archive(entityTable);
+
+        for(const std::vector<entt::entity>& sectionEntities : sections)
+        {
+            ZoneScopedN("SceneBinarySerializer::Save Section");
+
+            std::ostringstream section(std::ios::binary);
+            {
+                cereal::BinaryOutputArchive sectionArchive(section);
+
+                std::vector<uint32_t> entities;
+                entities.reserve(sectionEntities.size());
+                for(entt::entity entity : sectionEntities)
+                {
+                    entities.push_back(entt::to_integral(entity));
+                }
+                sectionArchive(entities);
+
+                std::ostringstream chunks(std::ios::binary);
+                uint32_t chunkCount = 0;
+                {
+                    cereal::BinaryOutputArchive chunkArchive(chunks);
+                    WriteChunk<TagComponent>(chunkArchive, registry, SceneChunk::Tag, sectionEntities, chunkCount);
+                    WriteChunk<TransformComponent>(chunkArchive, registry, SceneChunk::Transform, sectionEntities, chunkCount);
+                    WriteChunk<HierarchyComponent>(chunkArchive, registry, SceneChunk::Hierarchy, sectionEntities, chunkCount);
+                    WriteChunk<CameraComponent>(chunkArchive, registry, SceneChunk::Camera, sectionEntities, chunkCount);
+                    WriteChunk<MeshComponent>(chunkArchive, registry, SceneChunk::Mesh, sectionEntities, chunkCount);
+                    WriteChunk<MaterialComponent>(chunkArchive, registry, SceneChunk::Material, sectionEntities, chunkCount);
+                    WriteChunk<LightComponent>(chunkArchive, registry, SceneChunk::Light, sectionEntities, chunkCount);
+                    WriteChunk<StaticComponent>(chunkArchive, registry, SceneChunk::Static, sectionEntities, chunkCount);
+                }
+
+                const std::string& chunkBytes = chunks.str();
+                sectionArchive(chunkCount);
+                sectionArchive(cereal::binary_data(chunkBytes.data(), chunkBytes.size()));
+            }
+
+            const std::string& bytes = section.str();
+            archive(static_cast<uint64_t>(bytes.size()));
+            archive(cereal::binary_data(bytes.data(), bytes.size()));
+        }
+
+        return true;
+    }
+
+    bool SceneBinarySerializer::Load(const std::filesystem::path& path, entt::registry& registry, SceneSettings& settings)
+    {
+        ZoneScoped;
+
+        std::vector<SceneSectionInfo> sections;
+        std::vector<entt::entity> entities;
+        if(!ReadSectionTable(path, sections, entities, settings))
+            return false;
+
+        ReserveEntities(entities, registry);
+
+        std::ifstream file(path, std::ios::binary);
+
+        for(const SceneSectionInfo& info : sections)
+        {
+            SceneSection section;
+
+            file.seekg(static_cast<std::streamoff>(info.Offset));
+            ReadSection(file, section);
+
+            MergeSection(section, registry);
+        }
+
+        return true;
+    }
+
+    bool SceneBinarySerializer::ReadSectionTable(const std::filesystem::path& path, std::vector<SceneSectionInfo>& sections, std::vector<entt::entity>& entities, SceneSettings& settings)
+    {
+        ZoneScoped;
+
+        std::ifstream file(path, std::ios::binary);
+
+        if(!file)
+        {
+            COFFEE_CORE_ERROR("SceneBinarySerializer: Could not open {0}", path.string());
+            return false;
+        }
+
+        uint64_t fileSize = std::filesystem::file_size(path);
+
+        try
+        {
+            cereal::BinaryInputArchive archive(file);
+
+            uint32_t magic = 0, version = 0, sectionCount = 0;
+            archive(magic, version);
+
+            if(magic != Magic)
+            {
+                COFFEE_CORE_ERROR("SceneBinarySerializer: {0} is not a binary scene", path.string());
+                return false;
+            }
+
+            if(version != Version)
+            {
+                COFFEE_CORE_ERROR("SceneBinarySerializer: {0} has version {1}, expected {2}", path.string(), version, Version);
+                return false;
+            }
+
+            archive(settings, sectionCount);
+
+            std::vector<uint32_t> entityTable;
+            archive(entityTable);
+
+            entities.clear();
+            entities.reserve(entityTable.size());
+            for(uint32_t id : entityTable)
+            {
+                entities.push_back(entt::entity{id});
+            }
+
+            sections.clear();
+            sections.reserve(sectionCount);
+
+            for(uint32_t i = 0; i < sectionCount; i++)
+            {
+                uint64_t size = 0;
+                archive(size);
+
+                uint64_t offset = static_cast<uint64_t>(file.tellg());
+                if(size > fileSize - offset)
+                {
+                    COFFEE_CORE_ERROR("SceneBinarySerializer: Section {0} of {1} ends past the end of the file", i, path.string());
+                    return false;
+                }
+
+                sections.push_back({ offset, size });
+                file.seekg(static_cast<std::streamoff>(size), std::ios::cur);
+            }
+        }
+        catch(const cereal::Exception& e)
+        {
+            COFFEE_CORE_ERROR("SceneBinarySerializer: Could not read the section table of {0}: {1}", path.string(), e.what());
+            return false;
+        }
+
+        return true;
+    }
+
+    void SceneBinarySerializer::ReadSection(std::istream& stream, SceneSection& section)
+    {
+        ZoneScoped;
+
+        cereal::BinaryInputArchive archive(stream);
+
+        std::vector<uint32_t> entities;
+        archive(entities);
+
+        section.Entities.reserve(entities.size());
+        for(uint32_t id : entities)
+        {
+            section.Entities.push_back(entt::entity{id});
+        }
+
+        uint32_t chunkCount = 0;
+        archive(chunkCount);
+
+        for(uint32_t i = 0; i < chunkCount; i++)
+        {
+            uint32_t chunk = 0, count = 0;
+            uint64_t size = 0;
+            archive(chunk, count, size);
+
+            const std::streampos chunkEnd = stream.tellg() + static_cast<std::streamoff>(size);
+
+            // Read with an archive of its own, like it was written, so the class versions stored in the chunk are read from it
+            cereal::BinaryInputArchive chunkArchive(stream);
+
+            switch (static_cast<SceneChunk>(chunk))
+            {
+                case SceneChunk::Tag: ReadChunk(chunkArchive, section.Tags, count); break;
+                case SceneChunk::Transform: ReadChunk(chunkArchive, section.Transforms, count); break;
+                case SceneChunk::Hierarchy: ReadChunk(chunkArchive, section.Hierarchies, count); break;
+                case SceneChunk::Camera: ReadChunk(chunkArchive, section.Cameras, count); break;
+                case SceneChunk::Mesh: ReadChunk(chunkArchive, section.Meshes, count); break;
+                case SceneChunk::Material: ReadChunk(chunkArchive, section.Materials, count); break;
+                case SceneChunk::Light: ReadChunk(chunkArchive, section.Lights, count); break;
+                case SceneChunk::Static: ReadChunk(chunkArchive, section.Statics, count); break;
+                default:
+                    COFFEE_CORE_WARN("SceneBinarySerializer: Skipping unknown chunk {0}", chunk);
+                    break;
+            }
+
+            // A component that reads less than was written must not shift the chunks after it
+            stream.seekg(chunkEnd);
+        }
+    }
+
+    void SceneBinarySerializer::ReserveEntities(const std::vector<entt::entity>& entities, entt::registry& registry)
+    {
+        ZoneScoped;
+
+        // Keep the saved identifiers, the hierarchy links point to them
+        size_t remapped = 0;
+        for(entt::entity entity : entities)
+        {
+            if(registry.create(entity) != entity)
+                remapped++;
+        }
+
+        if(remapped > 0)
+            COFFEE_CORE_ERROR("SceneBinarySerializer: {0} saved entities were already in use, the registry was not empty", remapped);
+    }
+
+    void SceneBinarySerializer::MergeSection(SceneSection& section, entt::registry& registry)
+    {
+        ZoneScoped;
+
+        // The reserved entities are empty, nothing finds them but the whole entity view
+        bool destroyed = false;
+        for(entt::entity entity : section.Entities)
+        {
+            destroyed |= !registry.valid(entity);
+        }
+
+        if(destroyed)
+        {
+            COFFEE_CORE_WARN("SceneBinarySerializer: Entities of a section were destroyed before it was merged");
+            DropDestroyed(registry, section.Tags);
+            DropDestroyed(registry, section.Transforms);
+            DropDestroyed(registry, section.Hierarchies);
+            DropDestroyed(registry, section.Cameras);
+            DropDestroyed(registry, section.Meshes);
+            DropDestroyed(registry, section.Materials);
+            DropDestroyed(registry, section.Lights);
+            DropDestroyed(registry, section.Statics);
+        }
+
+        {
+            // The saved hierarchy links are already complete, the construct hook would walk every sibling list again
+            HierarchyConstructGuard hierarchyGuard(registry);
+
+            InsertPool(registry, section.Tags);
+            InsertPool(registry, section.Transforms);
+            InsertPool(registry, section.Hierarchies);
+            InsertPool(registry, section.Cameras);
+            InsertPool(registry, section.Lights);
+            InsertPool(registry, section.Statics);
+        }
+
+        // Resources are resolved here, the registry of resources is not thread safe
+        SceneSectionPool<MeshComponent> meshes;
+        meshes.Entities = std::move(section.Meshes.Entities);
+        meshes.Components.reserve(section.Meshes.Components.size());
+        for(UUID meshUUID : section.Meshes.Components)
+        {
+            meshes.Components.emplace_back(ResourceRegistry::Get<Mesh>(meshUUID));
+        }
+        InsertPool(registry, meshes);
+
+        SceneSectionPool<MaterialComponent> materials;
+        materials.Entities = std::move(section.Materials.Entities);
+        materials.Components.reserve(section.Materials.Components.size());
+        for(UUID materialUUID : section.Materials.Components)
+        {
+            materials.Components.emplace_back(ResourceRegistry::Get<Material>(materialUUID));
+        }
+        InsertPool(registry, materials);
+
+        section.Entities.clear();
+    }
+
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "CoffeeEngine/Core/UUID.h"
+#include "CoffeeEngine/Scene/Components.h"
+#include "CoffeeEngine/Scene/SceneSettings.h"
+#include "CoffeeEngine/Scene/SceneTree.h"
+
+#include <cstdint>
+#include <entt/entt.hpp>
+#include <filesystem>
+#include <istream>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup scene Scene
+     * @{
+     */
+
+    /**
+     * @brief Identifies a component pool stored in a binary scene.
+     * @ingroup scene
+     */
+    enum class SceneChunk : uint32_t
+    {
+        Tag = 1,
+        Transform = 2,
+        Hierarchy = 3,
+        Camera = 4,
+        Mesh = 5,
+        Material = 6,
+        Light = 7,
+        Static = 8
+    };
+
+    /**
+     * @brief The components of one pool of a section and the entities that own them.
+     * @ingroup scene
+     */
+    template<typename Component>
+    struct SceneSectionPool
+    {
+        std::vector<entt::entity> Entities; ///< The owners of the components.
+        std::vector<Component> Components; ///< The components, in the same order as the owners.
+    };
+
+    /**
+     * @brief A group of whole hierarchies deserialized from a binary scene, ready to be merged into a registry.
+     *
+     * Sections are read without touching any registry or resource, so they can be deserialized on
+     * worker threads. Meshes and materials are kept as UUIDs and resolved when merging.
+     * @ingroup scene
+     */
+    struct SceneSection
+    {
+        std::vector<entt::entity> Entities; ///< The entities of the section, with their saved identifiers.
+
+        SceneSectionPool<TagComponent> Tags;
+        SceneSectionPool<TransformComponent> Transforms;
+        SceneSectionPool<HierarchyComponent> Hierarchies;
+        SceneSectionPool<CameraComponent> Cameras;
+        SceneSectionPool<UUID> Meshes;
+        SceneSectionPool<UUID> Materials;
+        SceneSectionPool<LightComponent> Lights;
+        SceneSectionPool<StaticComponent> Statics;
+    };
+
+    /**
+     * @brief Location of a section inside a binary scene file.
+     * @ingroup scene
+     */
+    struct SceneSectionInfo
+    {
+        uint64_t Offset; ///< Offset of the section data from the start of the file.
+        uint64_t Size; ///< Size of the section data in bytes.
+    };
+
+    /**
+     * @brief Reads and writes scenes in the compact binary format.
+     *
+     * The file starts with a header (magic, version, scene settings, section count, every saved entity) followed by the sections.
+     * A section holds whole hierarchies (a root and all its descendants), so it can be merged on its
+     * own without leaving dangling HierarchyComponent links. Inside a section there is one chunk per
+     * component pool: type, number of components, size in bytes, the owning entities and the
+     * components, so each pool is merged with a single bulk insert and unknown chunks are skipped.
+     * Every chunk is written by its own archive, so the class versions of its components are stored in it.
+     * @ingroup scene
+     */
+    class SceneBinarySerializer
+    {
+    public:
+        static constexpr uint32_t Magic = 0x53414554; ///< "TEAS" in little endian.
+        static constexpr uint32_t Version = 5; ///< Bumped every time the layout changes.
+        static constexpr uint32_t DefaultSectionSize = 4096; ///< Entities per section, whole hierarchies are never split.
+
+        /**
+         * @brief Checks if a file is a binary scene.
+         * @param path The path to the file.
+         * @return True if the file starts with the binary scene magic.
+         */
+        static bool IsBinaryScene(const std::filesystem::path& path);
+
+        /**
+         * @brief Writes the entities and components of a registry to a binary scene file.
+         * @param path The path to the file.
+         * @param registry The registry to save.
+         * @param settings The settings of the scene.
+         * @param sectionSize Target number of entities per section.
+         * @return True if the file was written.
+         */
+        static bool Save(const std::filesystem::path& path, entt::registry& registry, const SceneSettings& settings, uint32_t sectionSize = DefaultSectionSize);
+
+        /**
+         * @brief Loads a binary scene file into an empty registry.
+         *
+         * The entities keep their identifiers, so the saved HierarchyComponent links are used as they are.
+         * @param path The path to the file.
+         * @param registry The registry to load into.
+         * @param settings The settings of the scene.
+         * @return True if the file was loaded.
+         */
+        static bool Load(const std::filesystem::path& path, entt::registry& registry, SceneSettings& settings);
+
+        /**
+         * @brief Reads the header of a binary scene and the location of its sections.
+         * @param path The path to the file.
+         * @param sections The location of every section.
+         * @param entities Every saved entity, to be reserved before the sections are merged.
+         * @param settings The settings of the scene.
+         * @return True if the header and the section table are valid.
+         */
+        static bool ReadSectionTable(const std::filesystem::path& path, std::vector<SceneSectionInfo>& sections, std::vector<entt::entity>& entities, SceneSettings& settings);
+
+        /**
+         * @brief Creates the saved entities in an empty registry, without components. Main thread only.
+         *
+         * Called before the first section is merged, so no entity created meanwhile can take a saved identifier.
+         * @param entities The saved entities, as read by ReadSectionTable.
+         * @param registry The registry to load into.
+         */
+        static void ReserveEntities(const std::vector<entt::entity>& entities, entt::registry& registry);
+
+        /**
+         * @brief Deserializes a section. Safe to call from any thread.
+         * @param stream The stream, positioned at the start of the section data.
+         * @param section The deserialized section.
+         */
+        static void ReadSection(std::istream& stream, SceneSection& section);
+
+        /**
+         * @brief Bulk inserts the components of a section into its reserved entities. Main thread only.
+         * @param section The section to merge, its pools are consumed.
+         * @param registry The registry to merge into.
+         */
+        static void MergeSection(SceneSection& section, entt::registry& registry);
+    };
+
+    /** @} */
+}
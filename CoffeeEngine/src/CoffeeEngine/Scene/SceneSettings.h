@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cereal/cereal.hpp>
+
+namespace Coffee {
+
+    /**
+     * @defgroup scene Scene
+     * @{
+     */
+
+    /**
+     * @brief Settings of a scene, saved with its entities.
+     * @ingroup scene
+     */
+    struct SceneSettings
+    {
+        bool SortedTransforms = false; ///< Keep the hierarchy and transform pools sorted, see SceneTree::SetSorted.
+
+        /**
+         * @brief Serialize the settings.
+         * @tparam Archive The archive type.
+         * @param archive The archive.
+         */
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("SortedTransforms", SortedTransforms));
+        }
+    };
+
+    /** @} */
+}
@@ -0,0 +1,125 @@
+#include "SceneStreamer.h"
+
+#include "CoffeeEngine/Core/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    SceneStreamer::SceneStreamer(const std::filesystem::path& path, entt::registry& registry)
+        : m_Path(path), m_Registry(registry)
+    {
+        ZoneScoped;
+
+        std::vector<entt::entity> entities;
+        if(!SceneBinarySerializer::ReadSectionTable(path, m_Sections, entities, m_Settings))
+            return;
+
+        m_Valid = true;
+
+        // Before the first update, so the entities created by the game and the scripts meanwhile get other identifiers
+        SceneBinarySerializer::ReserveEntities(entities, m_Registry);
+
+        size_t workerCount = std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, 4);
+        workerCount = std::min(workerCount, m_Sections.size());
+
+        for(size_t i = 0; i < workerCount; i++)
+        {
+            m_Workers.emplace_back(&SceneStreamer::WorkerLoop, this);
+        }
+    }
+
+    SceneStreamer::~SceneStreamer()
+    {
+        {
+            // Set under the mutex, otherwise a worker between its predicate check and its wait would sleep through the notify
+            std::lock_guard<std::mutex> lock(m_StagedMutex);
+            m_Stop = true;
+        }
+        m_StagedCondition.notify_all();
+
+        for(std::thread& worker : m_Workers)
+        {
+            worker.join();
+        }
+    }
+
+    void SceneStreamer::WorkerLoop()
+    {
+        std::ifstream file(m_Path, std::ios::binary);
+
+        while(!m_Stop)
+        {
+            size_t index = m_NextSection++;
+            if(index >= m_Sections.size())
+                break;
+
+            SceneSection section;
+
+            try
+            {
+                ZoneScopedN("SceneStreamer::ReadSection");
+
+                file.seekg(static_cast<std::streamoff>(m_Sections[index].Offset));
+                SceneBinarySerializer::ReadSection(file, section);
+            }
+            catch(const std::exception& e)
+            {
+                // An empty section is still staged so the load finishes
+                COFFEE_CORE_ERROR("SceneStreamer: Could not read section {0} of {1}: {2}", index, m_Path.string(), e.what());
+                file.clear();
+                section = SceneSection();
+            }
+
+            std::unique_lock<std::mutex> lock(m_StagedMutex);
+            m_StagedCondition.wait(lock, [this] { return m_Stop || m_Staged.size() < MaxStagedSections; });
+
+            if(m_Stop)
+                break;
+
+            m_Staged.push_back(std::move(section));
+        }
+    }
+
+    bool SceneStreamer::Update(double budgetMs)
+    {
+        if(IsFinished())
+            return true;
+
+        ZoneScoped;
+
+        auto start = std::chrono::steady_clock::now();
+
+        do
+        {
+            SceneSection section;
+            {
+                std::lock_guard<std::mutex> lock(m_StagedMutex);
+
+                if(m_Staged.empty())
+                    break;
+
+                section = std::move(m_Staged.front());
+                m_Staged.pop_front();
+            }
+            m_StagedCondition.notify_one();
+
+            SceneBinarySerializer::MergeSection(section, m_Registry);
+            m_MergedSections++;
+        }
+        while(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() < budgetMs);
+
+        if(IsFinished())
+        {
+            COFFEE_CORE_INFO("SceneStreamer: Finished streaming {0} ({1} sections)", m_Path.string(), m_Sections.size());
+            return true;
+        }
+
+        return false;
+    }
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "CoffeeEngine/Scene/SceneBinarySerializer.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <entt/entt.hpp>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup scene Scene
+     * @{
+     */
+
+    /**
+     * @brief Streams a binary scene into a registry over several frames.
+     *
+     * Worker threads deserialize the sections of the file into staging sections. The main thread
+     * merges the staged sections into the live registry in Update(), stopping once the time budget
+     * of the frame is spent. Sections hold whole hierarchies, so every merged entity has its
+     * parent and children already in the registry.
+     * @ingroup scene
+     */
+    class SceneStreamer
+    {
+    public:
+        static constexpr double DefaultBudgetMs = 2.0; ///< Default time spent merging sections per frame.
+        static constexpr size_t MaxStagedSections = 8; ///< Workers wait while this many sections are waiting to be merged.
+
+        /**
+         * @brief Starts streaming a binary scene.
+         * @param path The path to the binary scene.
+         * @param registry The registry the sections are merged into.
+         */
+        SceneStreamer(const std::filesystem::path& path, entt::registry& registry);
+
+        /**
+         * @brief Stops the workers. The sections already merged stay in the registry.
+         */
+        ~SceneStreamer();
+
+        /**
+         * @brief Merges the staged sections into the registry. Main thread only.
+         * @param budgetMs Time budget in milliseconds. At least one staged section is merged per call.
+         * @return True once every section has been merged.
+         */
+        bool Update(double budgetMs = DefaultBudgetMs);
+
+        /**
+         * @brief Checks if the header and the section table of the file could be read.
+         * @return False if the file is corrupt or was saved by another version, nothing is streamed then.
+         */
+        bool IsValid() const { return m_Valid; }
+
+        /**
+         * @brief Gets the settings saved with the scene, read with the section table.
+         * @return The settings of the scene.
+         */
+        const SceneSettings& GetSettings() const { return m_Settings; }
+
+        /**
+         * @brief Checks if every section has been merged.
+         * @return True if the scene is fully loaded.
+         */
+        bool IsFinished() const { return m_MergedSections == m_Sections.size(); }
+
+        /**
+         * @brief Gets the loading progress.
+         * @return The fraction of sections merged, between 0 and 1.
+         */
+        float GetProgress() const { return m_Sections.empty() ? 1.0f : (float)m_MergedSections / (float)m_Sections.size(); }
+
+    private:
+        void WorkerLoop();
+
+    private:
+        std::filesystem::path m_Path; ///< The binary scene.
+        entt::registry& m_Registry; ///< The registry the sections are merged into.
+
+        bool m_Valid = false; ///< The section table was read.
+        SceneSettings m_Settings; ///< The settings saved with the scene.
+        std::vector<SceneSectionInfo> m_Sections; ///< Location of the sections in the file.
+        std::atomic<size_t> m_NextSection = 0; ///< Next section to be deserialized by a worker.
+        size_t m_MergedSections = 0; ///< Sections merged into the registry.
+
+        std::vector<std::thread> m_Workers; ///< The deserialization threads.
+        std::atomic<bool> m_Stop = false; ///< Asks the workers to stop.
+
+        std::mutex m_StagedMutex; ///< Protects m_Staged, and the stores to m_Stop so waiting workers can't miss them.
+        std::condition_variable m_StagedCondition; ///< Wakes the workers when staged sections are merged.
+        std::deque<SceneSection> m_Staged; ///< Sections deserialized and waiting to be merged.
+    };
+
+    /** @} */
+}
@@ -12,6 +12,7 @@ namespace Coffee {
     {
         m_Parent = parent;
         m_First = entt::null;
+        m_Last = entt::null;
         m_Next = entt::null;
         m_Prev = entt::null;
     }
@@ -19,10 +20,46 @@ namespace Coffee {
     {
         m_Parent = entt::null;
         m_First = entt::null;
+        m_Last = entt::null;
         m_Next = entt::null;
         m_Prev = entt::null;
     }
 
+    entt::entity HierarchyComponent::GetLastChild(entt::registry& registry, entt::entity entity)
+    {
+        auto& hierarchy = registry.get<HierarchyComponent>(entity);
+        if(hierarchy.m_First == entt::null)
+            return entt::null;
+
+        // The cached child is trusted while it is still the tail of this list
+        if(hierarchy.m_Last != entt::null && registry.valid(hierarchy.m_Last))
+        {
+            auto* lastHierarchy = registry.try_get<HierarchyComponent>(hierarchy.m_Last);
+            if(lastHierarchy != nullptr && lastHierarchy->m_Parent == entity && lastHierarchy->m_Next == entt::null)
+                return hierarchy.m_Last;
+        }
+
+        // Loaded hierarchies do not have the cache, the siblings are walked once
+        auto lastEntity = hierarchy.m_First;
+        auto lastHierarchy = registry.try_get<HierarchyComponent>(lastEntity);
+        while(lastHierarchy != nullptr && lastHierarchy->m_Next != entt::null)
+        {
+            auto nextEntity = lastHierarchy->m_Next;
+            auto nextHierarchy = registry.try_get<HierarchyComponent>(nextEntity);
+
+            if(nextHierarchy == nullptr)
+            {
+                break;
+            }
+
+            lastEntity = nextEntity;
+            lastHierarchy = nextHierarchy;
+        }
+
+        hierarchy.m_Last = lastEntity;
+        return lastEntity;
+    }
+
     void HierarchyComponent::OnConstruct(entt::registry& registry, entt::entity entity)
     {
         auto& hierarchy = registry.get<HierarchyComponent>(entity);
@@ -34,31 +71,18 @@ namespace Coffee {
             if(parentHierarchy.m_First == entt::null)
             {
                 parentHierarchy.m_First = entity;
+                parentHierarchy.m_Last = entity;
             }
             else
             {
-                //Get the last child of the parent
-                auto lastEntity = parentHierarchy.m_First;
-                auto lastHierarchy = registry.try_get<HierarchyComponent>(lastEntity);
-                while(lastHierarchy != nullptr && lastHierarchy->m_Next != entt::null)
-                {
-                    auto nextEntity = lastHierarchy->m_Next;
-                    auto nextHierarchy = registry.try_get<HierarchyComponent>(nextEntity);
-
-                    if(nextHierarchy == nullptr)
-                    {
-                        break;
-                    }
-
-                    lastEntity = nextEntity;
-                    lastHierarchy = nextHierarchy;
-                }
+                auto lastEntity = GetLastChild(registry, hierarchy.m_Parent);
                 if (lastEntity == entity)
                 {
                     return;
                 }
-                lastHierarchy->m_Next = entity;
-                lastHierarchy->m_Prev = lastEntity;
+                registry.get<HierarchyComponent>(lastEntity).m_Next = entity;
+                hierarchy.m_Prev = lastEntity;
+                parentHierarchy.m_Last = entity;
             }
         }
     }
@@ -66,6 +90,18 @@ namespace Coffee {
     void HierarchyComponent::OnDestroy(entt::registry& registry, entt::entity entity)
     {
         auto& hierarchy = registry.get<HierarchyComponent>(entity);
+
+        // The previous sibling becomes the last child
+        if(hierarchy.m_Parent != entt::null && registry.valid(hierarchy.m_Parent))
+        {
+            auto* parentHierarchy = registry.try_get<HierarchyComponent>(hierarchy.m_Parent);
+            if(parentHierarchy != nullptr && parentHierarchy->m_Last == entity)
+            {
+                bool hasPrev = hierarchy.m_Prev != entt::null && registry.valid(hierarchy.m_Prev);
+                parentHierarchy->m_Last = hasPrev ? hierarchy.m_Prev : entt::null;
+            }
+        }
+
         // if is the first child
         if(hierarchy.m_Prev == entt::null || !registry.valid(hierarchy.m_Prev))
         {
@@ -125,6 +161,26 @@ namespace Coffee {
             hierarchyComponent->m_Parent = parent;
             HierarchyComponent::OnConstruct(registry, entity);
         }
+
+        // Lets the scene tree know the order of the hierarchy changed
+        registry.patch<HierarchyComponent>(entity);
+    }
+
+    void HierarchyComponent::CollectSubtree(entt::registry& registry, entt::entity entity, std::vector<entt::entity>& entities)
+    {
+        // Walked with the list itself as the queue, deep hierarchies do not recurse
+        size_t next = entities.size();
+        entities.push_back(entity);
+
+        while(next < entities.size())
+        {
+            auto child = registry.get<HierarchyComponent>(entities[next++]).m_First;
+            while(child != entt::null)
+            {
+                entities.push_back(child);
+                child = registry.get<HierarchyComponent>(child).m_Next;
+            }
+        }
     }
 
     SceneTree::SceneTree(Scene* scene) : m_Context(scene)
@@ -133,11 +189,44 @@ namespace Coffee {
         registry.on_construct<HierarchyComponent>().connect<&HierarchyComponent::OnConstruct>();
         registry.on_update<HierarchyComponent>().connect<&HierarchyComponent::OnUpdate>();
         registry.on_destroy<HierarchyComponent>().connect<&HierarchyComponent::OnDestroy>();
+
+        registry.on_construct<HierarchyComponent>().connect<&SceneTree::OnHierarchyChanged>(*this);
+        registry.on_update<HierarchyComponent>().connect<&SceneTree::OnHierarchyChanged>(*this);
+        registry.on_destroy<HierarchyComponent>().connect<&SceneTree::OnHierarchyChanged>(*this);
     }
 
     void SceneTree::Update()
     {
+        ZoneScoped;
+
         auto& registry = m_Context->m_Registry;
+
+        if(m_Sorted)
+        {
+            if(m_OrderDirty)
+            {
+                SortPools();
+            }
+
+            // Every parent comes before its children, so its world transform is already up to date
+            auto& hierarchies = registry.storage<HierarchyComponent>();
+            auto& transforms = registry.storage<TransformComponent>();
+            for(auto [entity, hierarchy] : hierarchies.each())
+            {
+                auto& transformComponent = transforms.get(entity);
+
+                if(hierarchy.m_Parent != entt::null)
+                {
+                    transformComponent.SetWorldTransform(transforms.get(hierarchy.m_Parent).GetWorldTransform());
+                }
+                else
+                {
+                    transformComponent.SetWorldTransform(glm::mat4(1.0f));
+                }
+            }
+            return;
+        }
+
         auto view = registry.view<HierarchyComponent>();
         for(auto entity : view)
         {
@@ -150,6 +239,41 @@ namespace Coffee {
         }
     }
 
+    void SceneTree::SetSorted(bool sorted)
+    {
+        m_Sorted = sorted;
+        m_OrderDirty = true;
+    }
+
+    void SceneTree::SortPools()
+    {
+        ZoneScoped;
+
+        auto& registry = m_Context->m_Registry;
+        auto& hierarchies = registry.storage<HierarchyComponent>();
+
+        // Each root followed by its descendants, level by level
+        std::vector<entt::entity> order;
+        order.reserve(hierarchies.size());
+        for(auto [entity, hierarchy] : hierarchies.each())
+        {
+            if(hierarchy.m_Parent == entt::null)
+            {
+                HierarchyComponent::CollectSubtree(registry, entity, order);
+            }
+        }
+
+        hierarchies.sort_as(order.begin(), order.end());
+        registry.sort<TransformComponent, HierarchyComponent>();
+
+        m_OrderDirty = false;
+    }
+
+    void SceneTree::OnHierarchyChanged(entt::registry& registry, entt::entity entity)
+    {
+        m_OrderDirty = true;
+    }
+
     void SceneTree::UpdateTransform(entt::entity entity)
     {
         auto& registry = m_Context->m_Registry;
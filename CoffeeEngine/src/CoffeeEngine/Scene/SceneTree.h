@@ -4,6 +4,7 @@
 #include "entt/entity/fwd.hpp"
 #include <cereal/cereal.hpp>
 #include <entt/entt.hpp>
+#include <vector>
 
 namespace Coffee {
 
@@ -60,8 +61,25 @@ namespace Coffee {
          */
         static void Reparent(entt::registry& registry, entt::entity entity, entt::entity parent);
 
+        /**
+         * @brief Get the last child of an entity, walking the children only if the cached one is stale.
+         * @param registry The entity registry.
+         * @param entity The parent entity.
+         * @return The last child, or a null entity if it has no children.
+         */
+        static entt::entity GetLastChild(entt::registry& registry, entt::entity entity);
+
+        /**
+         * @brief Append an entity and all its descendants to a list, parents before their children.
+         * @param registry The entity registry.
+         * @param entity The root of the subtree.
+         * @param entities The list to append to.
+         */
+        static void CollectSubtree(entt::registry& registry, entt::entity entity, std::vector<entt::entity>& entities);
+
         entt::entity m_Parent;
         entt::entity m_First;
+        entt::entity m_Last; ///< Cached last child, for O(1) appends. Not serialized, rebuilt by GetLastChild.
         entt::entity m_Next;
         entt::entity m_Prev;
 
@@ -87,6 +105,38 @@ namespace Coffee {
         }
     };
 
+    /**
+     * @brief Disconnects HierarchyComponent::OnConstruct for its lifetime, for bulk loads of hierarchy links that are already complete.
+     * @ingroup scene
+     *
+     * The callback is connected again when the guard goes out of scope, also when the load throws.
+     */
+    struct HierarchyConstructGuard
+    {
+        /**
+         * @brief Disconnects the callback.
+         * @param registry The entity registry.
+         */
+        explicit HierarchyConstructGuard(entt::registry& registry) : m_Registry(registry)
+        {
+            m_Registry.on_construct<HierarchyComponent>().disconnect<&HierarchyComponent::OnConstruct>();
+        }
+
+        /**
+         * @brief Connects the callback again.
+         */
+        ~HierarchyConstructGuard()
+        {
+            m_Registry.on_construct<HierarchyComponent>().connect<&HierarchyComponent::OnConstruct>();
+        }
+
+        HierarchyConstructGuard(const HierarchyConstructGuard&) = delete;
+        HierarchyConstructGuard& operator=(const HierarchyConstructGuard&) = delete;
+
+    private:
+        entt::registry& m_Registry;
+    };
+
     /**
      * @brief Class for managing the scene tree.
      * @ingroup scene
@@ -116,8 +166,41 @@ namespace Coffee {
          */
         void UpdateTransform(entt::entity entity);
 
+        /**
+         * @brief Keep the hierarchy and transform pools sorted parents before children.
+         *
+         * The pools are sorted again on the next Update after the hierarchy changed, and the world
+         * transforms are then propagated in one linear pass over the pools instead of recursing
+         * through the sibling lists. Sorting moves the components in their pools, so references to
+         * components are not valid across updates. Enabled by the SortedTransforms scene setting,
+         * see Scene::SetSettings.
+         * @param sorted True to enable the sorted mode.
+         */
+        void SetSorted(bool sorted);
+
+        /**
+         * @brief Check if the sorted mode is enabled.
+         * @return True if the pools are kept sorted.
+         */
+        bool IsSorted() const { return m_Sorted; }
+
+    private:
+        /**
+         * @brief Sort the hierarchy pool parents before children, and the transform pool in the same order.
+         */
+        void SortPools();
+
+        /**
+         * @brief Called when a hierarchy component is added, removed or relinked.
+         * @param registry The entity registry.
+         * @param entity The entity.
+         */
+        void OnHierarchyChanged(entt::registry& registry, entt::entity entity);
+
     private:
         Scene* m_Context;
+        bool m_Sorted = false; ///< Keep the pools sorted and propagate the transforms linearly.
+        bool m_OrderDirty = true; ///< The hierarchy changed since the pools were sorted.
     };
 
     /** @} */ // end of scene group
@@ -0,0 +1,290 @@
+#include "StaticBatcher.h"
+
+#include "CoffeeEngine/Core/JobSystem.h"
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/Core/Metrics.h"
+#include "CoffeeEngine/IO/CacheManager.h"
+#include "CoffeeEngine/Scene/Components.h"
+
+#include <algorithm>
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/vector.hpp>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <string>
+#include <tracy/Tracy.hpp>
+#include <tuple>
+#include <unordered_map>
+
+namespace Coffee {
+
+    // A static mesh and where it is drawn
+    struct BatchSource
+    {
+        entt::entity Entity;
+        Ref<Mesh> SourceMesh;
+        Ref<Material> SourceMaterial;
+        glm::mat4 Transform;
+    };
+
+    // The meshes of one batch and, once merged, its geometry
+    struct BatchGroup
+    {
+        Ref<Material> GroupMaterial;
+        glm::ivec3 Cell;
+        std::vector<const BatchSource*> Sources;
+
+        std::vector<Vertex> Vertices;
+        std::vector<uint32_t> Indices;
+        AABB Bounds;
+    };
+
+    static void HashBytes(uint64_t& hash, const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for(size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    }
+
+    template<typename T>
+    static void HashValue(uint64_t& hash, const T& value)
+    {
+        HashBytes(hash, &value, sizeof(T));
+    }
+
+    // Meshes without tangents have zero vectors, they stay zero
+    static glm::vec3 TransformDirection(const glm::mat3& matrix, const glm::vec3& direction)
+    {
+        glm::vec3 transformed = matrix * direction;
+        float length = glm::length(transformed);
+        return length > 0.0f ? transformed / length : transformed;
+    }
+
+    static void MergeGroup(BatchGroup& group)
+    {
+        size_t vertexCount = 0, indexCount = 0;
+        for(const BatchSource* source : group.Sources)
+        {
+            vertexCount += source->SourceMesh->GetVertices().size();
+            indexCount += source->SourceMesh->GetIndices().size();
+        }
+
+        group.Vertices.reserve(vertexCount);
+        group.Indices.reserve(indexCount);
+        group.Bounds = AABB(glm::vec3(std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::lowest()));
+
+        for(const BatchSource* source : group.Sources)
+        {
+            const glm::mat3 linear = glm::mat3(source->Transform);
+            const glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+            const uint32_t baseVertex = (uint32_t)group.Vertices.size();
+
+            for(const Vertex& vertex : source->SourceMesh->GetVertices())
+            {
+                Vertex merged;
+                merged.Position = glm::vec3(source->Transform * glm::vec4(vertex.Position, 1.0f));
+                merged.TexCoords = vertex.TexCoords;
+                merged.Normals = TransformDirection(normalMatrix, vertex.Normals);
+                merged.Tangent = TransformDirection(linear, vertex.Tangent);
+                merged.Bitangent = TransformDirection(linear, vertex.Bitangent);
+
+                group.Bounds.min = glm::min(group.Bounds.min, merged.Position);
+                group.Bounds.max = glm::max(group.Bounds.max, merged.Position);
+
+                group.Vertices.push_back(merged);
+            }
+
+            const std::vector<uint32_t>& indices = source->SourceMesh->GetIndices();
+            const size_t firstIndex = group.Indices.size();
+            for(uint32_t index : indices)
+            {
+                group.Indices.push_back(baseVertex + index);
+            }
+
+            // A mirroring transform flips the winding of the triangles
+            if(glm::determinant(linear) < 0.0f)
+            {
+                for(size_t i = firstIndex; i + 2 < group.Indices.size(); i += 3)
+                {
+                    std::swap(group.Indices[i + 1], group.Indices[i + 2]);
+                }
+            }
+        }
+    }
+
+    static bool ReadCache(const std::filesystem::path& path, std::vector<BatchGroup>& groups)
+    {
+        ZoneScoped;
+
+        std::ifstream file(path, std::ios::binary);
+        if(!file)
+            return false;
+
+        try
+        {
+            cereal::BinaryInputArchive archive(file);
+
+            uint32_t version = 0;
+            uint64_t groupCount = 0;
+            archive(version, groupCount);
+
+            if(version != StaticBatcher::CacheVersion || groupCount != groups.size())
+                return false;
+
+            for(BatchGroup& group : groups)
+            {
+                archive(group.Vertices, group.Indices, group.Bounds);
+            }
+        }
+        catch(const std::exception& e)
+        {
+            COFFEE_CORE_WARN("StaticBatcher: Could not read the cached batches {0}: {1}", path.string(), e.what());
+            for(BatchGroup& group : groups)
+            {
+                group.Vertices.clear();
+                group.Indices.clear();
+            }
+            return false;
+        }
+
+        return true;
+    }
+
+    static void WriteCache(const std::filesystem::path& path, std::vector<BatchGroup>& groups)
+    {
+        ZoneScoped;
+
+        CacheManager::CreateCacheDirectory();
+        std::ofstream file(path, std::ios::binary);
+
+        if(!file)
+        {
+            COFFEE_CORE_ERROR("StaticBatcher: Could not open {0} for writing", path.string());
+            return;
+        }
+
+        cereal::BinaryOutputArchive archive(file);
+        archive(StaticBatcher::CacheVersion, static_cast<uint64_t>(groups.size()));
+
+        for(BatchGroup& group : groups)
+        {
+            archive(group.Vertices, group.Indices, group.Bounds);
+        }
+    }
+
+    std::vector<StaticBatch> StaticBatcher::Build(entt::registry& registry, float cellSize, bool useCache)
+    {
+        ZoneScoped;
+
+        static Metric& batchesMetric = Metrics::Gauge("Static Batches");
+        static Metric& batchedMeshesMetric = Metrics::Gauge("Static Batched Meshes");
+
+        // In entity order, so the same scene always gives the same groups and the same hash
+        std::vector<BatchSource> sources;
+        auto view = registry.view<StaticComponent, MeshComponent, TransformComponent>();
+        for(auto entity : view)
+        {
+            auto [staticComponent, meshComponent, transformComponent] = view.get<StaticComponent, MeshComponent, TransformComponent>(entity);
+
+            if(!staticComponent.Batched || !meshComponent.GetMesh())
+                continue;
+
+            auto* materialComponent = registry.try_get<MaterialComponent>(entity);
+            Ref<Material> material = materialComponent ? materialComponent->material : meshComponent.GetMesh()->GetMaterial();
+
+            sources.push_back({ entity, meshComponent.GetMesh(), material, transformComponent.GetWorldTransform() });
+        }
+
+        std::sort(sources.begin(), sources.end(), [](const BatchSource& a, const BatchSource& b) { return a.Entity < b.Entity; });
+
+        uint64_t hash = 14695981039346656037ull;
+        HashValue(hash, cellSize);
+
+        // A reimported mesh keeps its UUID, so the key covers its data too. Hashed once per mesh, most are instanced
+        std::unordered_map<const Mesh*, uint64_t> meshDataHashes;
+
+        std::map<std::tuple<uint64_t, int, int, int>, BatchGroup> groupsByKey;
+        for(const BatchSource& source : sources)
+        {
+            uint64_t meshUUID = source.SourceMesh->GetUUID();
+            uint64_t materialUUID = source.SourceMaterial ? (uint64_t)source.SourceMaterial->GetUUID() : 0;
+
+            auto [meshDataHash, inserted] = meshDataHashes.try_emplace(source.SourceMesh.get(), 14695981039346656037ull);
+            if(inserted)
+            {
+                const std::vector<Vertex>& vertices = source.SourceMesh->GetVertices();
+                const std::vector<uint32_t>& indices = source.SourceMesh->GetIndices();
+
+                HashValue(meshDataHash->second, (uint64_t)vertices.size());
+                HashValue(meshDataHash->second, (uint64_t)indices.size());
+                HashBytes(meshDataHash->second, vertices.data(), vertices.size() * sizeof(Vertex));
+                HashBytes(meshDataHash->second, indices.data(), indices.size() * sizeof(uint32_t));
+            }
+
+            HashValue(hash, meshUUID);
+            HashValue(hash, materialUUID);
+            HashValue(hash, meshDataHash->second);
+            HashValue(hash, source.Transform);
+
+            // The cell the bounds are centered in, so every mesh belongs to exactly one cell
+            glm::vec3 center = source.SourceMesh->GetAABB().CalculateTransformedAABB(source.Transform).GetCenter();
+            glm::ivec3 cell = glm::ivec3(glm::floor(center / cellSize));
+
+            BatchGroup& group = groupsByKey[{ materialUUID, cell.x, cell.y, cell.z }];
+            group.GroupMaterial = source.SourceMaterial;
+            group.Cell = cell;
+            group.Sources.push_back(&source);
+        }
+
+        std::vector<BatchGroup> groups;
+        groups.reserve(groupsByKey.size());
+        for(auto& [key, group] : groupsByKey)
+        {
+            groups.push_back(std::move(group));
+        }
+
+        std::filesystem::path cachePath = CacheManager::GetCachePath() / (std::to_string(hash) + ".batch");
+
+        if(!useCache || !ReadCache(cachePath, groups))
+        {
+            JobSystem::ParallelFor("StaticBatcher::Merge", groups.size(), 1, [&groups](size_t begin, size_t end) {
+                for(size_t i = begin; i < end; i++)
+                {
+                    MergeGroup(groups[i]);
+                }
+            });
+
+            if(!groups.empty())
+                WriteCache(cachePath, groups);
+        }
+
+        // The buffers are uploaded here, on the main thread
+        std::vector<StaticBatch> batches;
+        batches.reserve(groups.size());
+        for(BatchGroup& group : groups)
+        {
+            ZoneScopedN("StaticBatcher::Create Mesh");
+
+            StaticBatch& batch = batches.emplace_back();
+            batch.MergedMesh = CreateRef<Mesh>(group.Vertices, group.Indices);
+            batch.MergedMesh->SetName("Static Batch");
+            batch.MergedMesh->SetAABB(group.Bounds);
+            batch.MergedMesh->SetMaterial(group.GroupMaterial);
+            batch.Cell = group.Cell;
+            batch.MeshCount = (uint32_t)group.Sources.size();
+        }
+
+        batchesMetric.Set((double)batches.size());
+        batchedMeshesMetric.Set((double)sources.size());
+
+        COFFEE_CORE_INFO("StaticBatcher: Merged {0} static meshes into {1} batches", sources.size(), batches.size());
+
+        return batches;
+    }
+
+}
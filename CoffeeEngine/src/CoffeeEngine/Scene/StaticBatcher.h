@@ -0,0 +1,60 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Renderer/Mesh.h"
+
+#include <cstdint>
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup scene Scene
+     * @{
+     */
+
+    /**
+     * @brief The static meshes of one material and one cell, merged into a single mesh.
+     */
+    struct StaticBatch
+    {
+        Ref<Mesh> MergedMesh; ///< The merged mesh, its vertices are in world space and it has the shared material.
+        glm::mat4 Transform = glm::mat4(1.0f); ///< Always the identity, kept here because the octree references it.
+        glm::ivec3 Cell = glm::ivec3(0); ///< The cell of the batch, in units of the cell size.
+        uint32_t MeshCount = 0; ///< Number of meshes merged into the batch.
+    };
+
+    /**
+     * @brief Merges the meshes of the static entities to reduce the draw calls.
+     *
+     * The entities with a StaticComponent and a MeshComponent are grouped by material and by the
+     * cell of a uniform grid their bounds are centered in. Each group becomes one mesh, with one vertex
+     * and one index buffer in world space, so the batches can still be culled cell by cell.
+     *
+     * The batches are cached in the cache directory, keyed by a hash of the meshes and their vertex
+     * and index data, the materials and the world transforms of the static entities, so a scene that
+     * did not change is not merged again and a reimported mesh is.
+     */
+    class StaticBatcher
+    {
+    public:
+        static constexpr float DefaultCellSize = 32.0f; ///< Size of the grid cells, in world units.
+        static constexpr uint32_t CacheVersion = 1; ///< Bumped every time the layout of the cache files changes.
+
+        /**
+         * @brief Builds the static batches of a registry, reading them from the cache when possible.
+         *
+         * The world transforms of the entities have to be up to date. Main thread only, the meshes
+         * upload their buffers when created.
+         * @param registry The registry.
+         * @param cellSize The size of the grid cells.
+         * @param useCache False to merge the meshes again and overwrite the cache.
+         * @return The batches.
+         */
+        static std::vector<StaticBatch> Build(entt::registry& registry, float cellSize = DefaultCellSize, bool useCache = true);
+    };
+
+    /** @} */ // end of scene group
+}
@@ -5,6 +5,9 @@
 
 namespace Coffee {
 
+    class Entity;
+    class Scene;
+
     class IScriptingBackend {
 
         public:
@@ -35,10 +38,30 @@ namespace Coffee {
              */
             virtual void RegisterFunction(const std::string& script, std::function<int()> func, const std::string& name) = 0;
 
-            virtual void BindFunction(const std::string& script, const std::string& name, std::function<int()>& func) = 0;
-
             virtual void RegisterVariable(const std::string& name, void* variable) = 0;
 
+            /**
+             * @brief Creates the instance of a script for an entity and calls its OnCreate.
+             *
+             * @param filepath The path of the script.
+             * @param entity The entity the instance belongs to, replacing its previous instance.
+             */
+            virtual void CreateInstance(const std::filesystem::path& filepath, const Entity& entity) = 0;
+
+            /**
+             * @brief Calls OnDestroy on the script instance of an entity and destroys it.
+             *
+             * @param entity The entity.
+             */
+            virtual void DestroyInstance(const Entity& entity) = 0;
+
+            /**
+             * @brief Calls OnUpdate on every script instance of a scene.
+             *
+             * @param scene The scene.
+             */
+            virtual void UpdateInstances(Scene* scene) = 0;
+
     };
 
 } // namespace Coffee
\ No newline at end of file
@@ -1,18 +1,326 @@
 #include "LuaBackend.h"
 
 #include "CoffeeEngine/Core/Input.h"
+#include "CoffeeEngine/Core/JobSystem.h"
 #include "CoffeeEngine/Core/KeyCodes.h"
 #include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/Core/MemoryProfiler.h"
+#include "CoffeeEngine/Core/Metrics.h"
 #include "CoffeeEngine/Core/MouseCodes.h"
+#include "CoffeeEngine/IO/CacheManager.h"
+#include "CoffeeEngine/IO/FileWatcher.h"
 #include "CoffeeEngine/Scene/Components.h"
 #include "CoffeeEngine/Scene/Entity.h"
+#include "CoffeeEngine/Scene/EntityCommandBuffer.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <tracy/Tracy.hpp>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
 
 #define SOL_PRINT_ERRORS 1
 
 namespace Coffee {
 
-    sol::state LuaBackend::luaState;
-    std::unordered_map<std::string, sol::environment> LuaBackend::scriptEnvironments;
+    // The bytes the scripts of one Lua state still hold. A block is charged to the script that allocated it until it is
+    // freed, so the memory budget covers what a script keeps alive across calls. Only used by the thread running the state
+    struct LuaStateMemory {
+        std::unordered_map<std::string, size_t> liveBytes; // Live bytes of each script
+    };
+
+    static void* LuaTrackedAlloc(void* userData, void* ptr, size_t oldSize, size_t newSize);
+
+    // Declared before the state, which frees its blocks when destroyed. Created with the tracked allocator, so every
+    // block of the state has its header
+    static LuaStateMemory s_MainStateMemory;
+    sol::state LuaBackend::luaState(sol::default_at_panic, LuaTrackedAlloc, &s_MainStateMemory);
+
+    static std::unordered_map<std::string, LuaCompiledScript> s_CompiledScripts;
+    static std::unordered_set<std::string> s_WatchedScripts;
+
+    // The instances of a script in a scene whose OnUpdate is dispatched in one call
+    struct LuaScriptBatch {
+        sol::table updates; // OnUpdate of every instance, from 1 like a Lua array
+        sol::table entities; // self of every instance, parallel to updates
+        std::vector<entt::entity> handles; // Entity of every instance, from 0
+    };
+
+    using LuaScriptBatches = std::unordered_map<std::string, LuaScriptBatch>;
+
+    struct LuaScriptUsage {
+        LuaScriptBudget budget;
+        LuaScriptStats lastFrame;
+        LuaScriptStats currentFrame;
+        uint64_t violations = 0;
+        uint32_t liveInstances = 0; // Instances alive, the memory budget covers all of them
+    };
+
+    // A Lua state of its own for the thread-safe scripts, updated by one job while the other jobs update the other states
+    struct LuaWorkerState {
+        LuaStateMemory memory; // Declared before the state, which frees its blocks when destroyed
+        sol::state state{ sol::default_at_panic, LuaTrackedAlloc, &memory };
+        sol::protected_function dispatcher;
+        std::unordered_map<std::string, LuaScriptUsage> usage; // Merged into s_ScriptUsage at the sync point
+    };
+
+    // Declared before the instances, so the environments are released before the states they live in are closed
+    static std::vector<Scope<LuaWorkerState>> s_WorkerStates;
+    static std::unordered_map<std::string, void*> s_RegisteredVariables; // Set again in the worker states created later
+    static uint32_t s_NextWorkerState = 0;
+    static bool s_ParallelScripts = false;
+
+    struct LuaScriptInstance {
+        std::string scriptPath;
+        sol::environment environment;
+        int32_t batchIndex = -1; // Index in the batch of the script, -1 if the script has no OnUpdate
+        int32_t workerState = -1; // Index in s_WorkerStates of the state the instance lives in, -1 for luaState
+    };
+
+    struct LuaSceneScripts {
+        std::unordered_map<entt::entity, LuaScriptInstance> instances;
+        LuaScriptBatches batches;
+        std::vector<LuaScriptBatches> workerBatches; // Batches of the thread-safe scripts, parallel to s_WorkerStates
+    };
+
+    static std::unordered_map<Scene*, LuaSceneScripts> s_SceneScripts;
+    static sol::protected_function s_UpdateDispatcher;
+
+    static LuaScriptBatches& GetInstanceBatches(LuaSceneScripts& sceneScripts, int32_t workerState) {
+        return workerState < 0 ? sceneScripts.batches : sceneScripts.workerBatches[workerState];
+    }
+
+    // Calls the OnUpdate of every instance of a script. A failing instance is reported and does not stop the others,
+    // unless report says the script is over its budget
+    static constexpr const char* s_UpdateDispatcherSource = R"(
+        local report = ...
+        return function(updates, entities, count)
+            for i = 1, count do
+                local update = updates[i]
+                if update then
+                    local ok, message = pcall(update, entities[i])
+                    if not ok and report(message) then
+                        return
+                    end
+                end
+            end
+        end
+    )";
+
+    static std::unordered_map<std::string, LuaScriptUsage> s_ScriptUsage;
+
+    // Set while a worker state is updated. The scripts then read copies of the components, and their writes are
+    // recorded here and played back on the main thread at the sync point
+    static thread_local EntityCommandBuffer* t_CommandBuffer = nullptr;
+
+    // The script running now, the hook and the allocator charge it and enforce its budget
+    struct LuaActiveScript {
+        const std::string* path = nullptr;
+        LuaScriptUsage* usage = nullptr;
+        uint64_t instructionLimit = 0;
+        size_t memoryLimit = 0;
+        uint64_t instructions = 0;
+        size_t allocatedBytes = 0;
+        bool overBudget = false;
+
+        LuaStateMemory* memory = nullptr; // State of the last allocation, liveBytes belongs to it
+        size_t* liveBytes = nullptr; // Live bytes of the script in that state
+        const void* refusedBlock = nullptr; // Last request refused, Lua collects the garbage and asks again once
+        size_t refusedSize = 0;
+    };
+
+    // Per thread, the worker states are updated concurrently
+    static thread_local LuaActiveScript s_ActiveScript;
+
+    static void ReportBudgetViolation(const char* resource) {
+        static Metric& violationsMetric = Metrics::Counter("Lua Budget Violations");
+
+        // Reported once per call, the script keeps failing until it returns
+        if (s_ActiveScript.overBudget)
+            return;
+
+        s_ActiveScript.overBudget = true;
+        s_ActiveScript.usage->violations++;
+        violationsMetric.Add();
+
+        COFFEE_CORE_ERROR("[Lua Budget]: {0} went over its {1} budget and was stopped", *s_ActiveScript.path, resource);
+    }
+
+    // Makes a script the active one while calling into it, and adds what the call used to its stats
+    class LuaScriptCallScope {
+    public:
+        LuaScriptCallScope(const std::string& path, uint32_t instances)
+            : LuaScriptCallScope(path, s_ScriptUsage[path], instances)
+        {
+        }
+
+        // A given usage, the one of a worker state holds a copy of the budget of the script
+        LuaScriptCallScope(const std::string& path, LuaScriptUsage& usage, uint32_t instances)
+            : m_Previous(s_ActiveScript), m_Start(std::chrono::steady_clock::now())
+        {
+            s_ActiveScript = {};
+            s_ActiveScript.path = &path;
+            s_ActiveScript.usage = &usage;
+            s_ActiveScript.instructionLimit = usage.budget.instructions * std::max(instances, 1u);
+            s_ActiveScript.memoryLimit = usage.budget.memory * std::max({instances, usage.liveInstances, 1u});
+
+            usage.currentFrame.instances += instances;
+        }
+
+        ~LuaScriptCallScope()
+        {
+            LuaScriptStats& stats = s_ActiveScript.usage->currentFrame;
+            stats.cpuTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_Start).count();
+            stats.instructions += s_ActiveScript.instructions;
+            stats.allocatedBytes += s_ActiveScript.allocatedBytes;
+
+            s_ActiveScript = m_Previous;
+        }
+
+        LuaScriptCallScope(const LuaScriptCallScope&) = delete;
+        LuaScriptCallScope& operator=(const LuaScriptCallScope&) = delete;
+
+    private:
+        LuaActiveScript m_Previous;
+        std::chrono::steady_clock::time_point m_Start;
+    };
+
+    static void LuaBudgetHook(lua_State* L, lua_Debug* debug) {
+        if (!s_ActiveScript.usage)
+            return;
+
+        s_ActiveScript.instructions += LuaBackend::InstructionCheckInterval;
+        if (s_ActiveScript.instructions > s_ActiveScript.instructionLimit) {
+            ReportBudgetViolation("instruction");
+            luaL_error(L, "instruction budget exceeded");
+        }
+    }
+
+    // Components the scripts can access. The type ID of a component in Lua is its index in the list
+    template<typename... Components>
+    struct ScriptComponentList {
+        static constexpr size_t Count = sizeof...(Components);
+    };
+
+    using ScriptComponents = ScriptComponentList<TagComponent, TransformComponent, MeshComponent, MaterialComponent, LightComponent, CameraComponent>;
+
+    static constexpr const char* s_ScriptComponentNames[] = { "Tag", "Transform", "Mesh", "Material", "Light", "Camera" };
+    static_assert(std::size(s_ScriptComponentNames) == ScriptComponents::Count, "Every script component needs a name");
+
+    // Access to one component type, so a type ID is resolved with an array index instead of comparing names
+    struct ComponentAccessor {
+        bool (*has)(Entity& entity);
+        sol::object (*get)(Entity& entity, sol::this_state state);
+        sol::object (*add)(Entity& entity, sol::this_state state);
+        void (*set)(Entity& entity, const sol::object& value);
+        void (*remove)(Entity& entity);
+    };
+
+    // Transforms are reached through their entity instead of a pointer into the storage: the sorted scene tree
+    // reorders the transform pool, which would leave the pointers held by the scripts on other entities
+    struct LuaTransformRef {
+        Entity entity;
+
+        TransformComponent& Get() const {
+            Entity target = entity;
+            TransformComponent* transform = target.TryGetComponent<TransformComponent>();
+            if (!transform) {
+                throw std::runtime_error("The entity of the transform no longer has a transform component");
+            }
+            return *transform;
+        }
+    };
+
+    template<typename Component>
+    static sol::object PushComponent(Entity& entity, Component& component, sol::this_state state) {
+        if constexpr (std::is_same_v<Component, TransformComponent>) {
+            return sol::make_object(state, LuaTransformRef{ entity });
+        } else {
+            return sol::make_object(state, &component);
+        }
+    }
+
+    template<typename Component>
+    static Component GetComponentValue(const sol::object& value) {
+        if constexpr (std::is_same_v<Component, TransformComponent>) {
+            if (value.is<LuaTransformRef>()) {
+                return value.as<LuaTransformRef>().Get();
+            }
+        }
+        return value.as<Component>();
+    }
+
+    // The components are pushed as pointers, so Lua gets a reference into the entt storage instead of a copy.
+    // The scripts of the worker states get copies instead, and their writes go to the command buffer. They only use
+    // the const lookups, the others create the storage of a component the scene does not have yet. They never default
+    // construct a component either, the mesh and material constructors load resources: a missing component is added
+    // on the main thread at the sync point, and AddComponent returns nil until then
+    template<typename Component>
+    static constexpr ComponentAccessor MakeComponentAccessor() {
+        return {
+            [](Entity& entity) {
+                return t_CommandBuffer ? std::as_const(entity).HasComponent<Component>() : entity.HasComponent<Component>();
+            },
+            [](Entity& entity, sol::this_state state) {
+                if (t_CommandBuffer) {
+                    const Component* component = std::as_const(entity).TryGetComponent<Component>();
+                    return component ? sol::make_object(state, *component) : sol::make_object(state, sol::lua_nil);
+                }
+                Component* component = entity.TryGetComponent<Component>();
+                return component ? PushComponent(entity, *component, state) : sol::make_object(state, sol::lua_nil);
+            },
+            [](Entity& entity, sol::this_state state) {
+                if (t_CommandBuffer) {
+                    const Component* component = std::as_const(entity).TryGetComponent<Component>();
+                    if (component)
+                        return sol::make_object(state, *component);
+
+                    t_CommandBuffer->EmplaceComponent<Component>(entity);
+                    return sol::make_object(state, sol::lua_nil);
+                }
+                Component* component = entity.TryGetComponent<Component>();
+                return PushComponent(entity, component ? *component : entity.AddComponent<Component>(), state);
+            },
+            [](Entity& entity, const sol::object& value) {
+                if (t_CommandBuffer) {
+                    t_CommandBuffer->AddComponent<Component>(entity, GetComponentValue<Component>(value));
+                } else if (Component* component = entity.TryGetComponent<Component>()) {
+                    *component = GetComponentValue<Component>(value);
+                } else {
+                    entity.AddComponent<Component>(GetComponentValue<Component>(value));
+                }
+            },
+            [](Entity& entity) {
+                if (t_CommandBuffer) {
+                    t_CommandBuffer->RemoveComponent<Component>(entity);
+                } else {
+                    entity.RemoveComponent<Component>();
+                }
+            }
+        };
+    }
+
+    template<typename... Components>
+    static constexpr std::array<ComponentAccessor, sizeof...(Components)> MakeComponentAccessors(ScriptComponentList<Components...>) {
+        return { MakeComponentAccessor<Components>()... };
+    }
+
+    static constexpr std::array<ComponentAccessor, ScriptComponents::Count> s_ComponentAccessors = MakeComponentAccessors(ScriptComponents{});
+
+    static const ComponentAccessor& GetComponentAccessor(int typeID) {
+        if (typeID < 0 || typeID >= (int)ScriptComponents::Count) {
+            throw std::runtime_error("Unknown component type " + std::to_string(typeID));
+        }
+        return s_ComponentAccessors[typeID];
+    }
 
     void BindKeyCodesToLua(sol::state& lua, sol::table& inputTable)
     {
@@ -290,9 +598,76 @@ namespace Coffee {
         inputTable["mousecode"] = mouseCodeTable;
     }
 
-    void LuaBackend::Initialize() {
-        luaState.open_libraries(sol::lib::base, sol::lib::math, sol::lib::string, sol::lib::table);
+    // Stored in front of every block of a Lua state, its size keeps the blocks aligned like malloc
+    struct alignas(std::max_align_t) LuaBlockHeader {
+        size_t* liveBytes; // Live bytes of the script charged for the block, null if no script was running
+    };
+
+    // Same as the default Lua allocator, but the blocks are counted under the Scripting memory tag and charged to the
+    // active script until they are freed. The owner is kept in the header of the block, so no lookup is needed
+    static void* LuaTrackedAlloc(void* userData, void* ptr, size_t oldSize, size_t newSize) {
+        LuaStateMemory& memory = *static_cast<LuaStateMemory*>(userData);
+        LuaBlockHeader* header = ptr ? static_cast<LuaBlockHeader*>(ptr) - 1 : nullptr;
+
+        // When ptr is null oldSize holds the type of the new object, not a size
+        int64_t previousSize = ptr ? (int64_t)oldSize : 0;
+        size_t* owner = header ? header->liveBytes : nullptr;
+
+        if (newSize == 0) {
+            if (owner)
+                *owner -= oldSize;
+            std::free(header);
+            MemoryProfiler::TrackExternal(MemoryTag::Scripting, -previousSize);
+            return nullptr;
+        }
+
+        size_t* liveBytes = nullptr;
+        if (s_ActiveScript.usage) {
+            if (s_ActiveScript.memory != &memory) {
+                s_ActiveScript.memory = &memory;
+                s_ActiveScript.liveBytes = &memory.liveBytes[*s_ActiveScript.path];
+            }
+            liveBytes = s_ActiveScript.liveBytes;
+
+            // Only growing can fail, Lua raises a memory error in the script
+            if ((int64_t)newSize > previousSize) {
+                size_t growth = (size_t)((int64_t)newSize - previousSize);
+                if (*liveBytes + growth > s_ActiveScript.memoryLimit) {
+                    // The first refusal lets Lua collect the garbage of the script, still held until then
+                    if (s_ActiveScript.refusedBlock == ptr && s_ActiveScript.refusedSize == newSize)
+                        ReportBudgetViolation("memory");
+
+                    s_ActiveScript.refusedBlock = ptr;
+                    s_ActiveScript.refusedSize = newSize;
+                    return nullptr;
+                }
+
+                s_ActiveScript.allocatedBytes += growth;
+                s_ActiveScript.refusedBlock = nullptr;
+                s_ActiveScript.refusedSize = 0;
+            }
+        }
+
+        LuaBlockHeader* block = static_cast<LuaBlockHeader*>(std::realloc(header, sizeof(LuaBlockHeader) + newSize));
+        if (!block)
+            return nullptr;
+
+        MemoryProfiler::TrackExternal(MemoryTag::Scripting, (int64_t)newSize - previousSize);
+
+        // A block resized outside the scripts stays charged to the script that allocated it
+        if (owner)
+            *owner -= oldSize;
+        if (!liveBytes)
+            liveBytes = owner;
+        if (liveBytes)
+            *liveBytes += newSize;
 
+        block->liveBytes = liveBytes;
+        return block + 1;
+    }
+
+    // Binds the engine API every Lua state gives the scripts
+    static void BindScriptingApi(sol::state& luaState) {
         # pragma region Bind Log Functions
         luaState.set_function("log", [](const std::string& message) {
             COFFEE_CORE_INFO("{0}", message);
@@ -337,54 +712,42 @@ namespace Coffee {
 
         #pragma region Bind Entity Functions
 
+        sol::table componentTable = luaState.create_table();
+        for (size_t typeID = 0; typeID < ScriptComponents::Count; typeID++) {
+            componentTable[s_ScriptComponentNames[typeID]] = typeID;
+        }
+        luaState["component"] = componentTable;
+
         luaState.new_usertype<Entity>("Entity",
         sol::constructors<Entity(), Entity(entt::entity, Scene*)>(),
 
-        "AddComponent", [](Entity& self, const std::string& componentName) {
-            if (componentName == "TagComponent") {
-                self.AddComponent<TagComponent>();
-            } else if (componentName == "TransformComponent") {
-                self.AddComponent<TransformComponent>();
-            } else {
-                throw std::runtime_error("Unknown component type");
-            }
+        "AddComponent", [](Entity& self, int typeID, sol::this_state state) {
+            return GetComponentAccessor(typeID).add(self, state);
         },
 
-/*        "GetComponent", [this](Entity& self, const std::string& componentName) -> sol::object {
-            if (componentName == "TagComponent") {
-                return sol::make_object(luaState, self.GetComponent<TagComponent>());
-            } else if (componentName == "TransformComponent") {
-                return sol::make_object(luaState, self.GetComponent<TransformComponent>());
-            } else {
-                throw std::runtime_error("Unknown component type");
-            }
-        },*/
+        "GetComponent", [](Entity& self, int typeID, sol::this_state state) {
+            return GetComponentAccessor(typeID).get(self, state);
+        },
 
-        "GetComponent", [this](Entity& self) -> sol::object {
-            return sol::make_object(luaState, self.GetComponent<TagComponent>());
+        "HasComponent", [](Entity& self, int typeID) {
+            return GetComponentAccessor(typeID).has(self);
         },
 
-        "HasComponent", [](Entity& self, const std::string& componentName) -> bool {
-            if (componentName == "TagComponent") {
-                return self.HasComponent<TagComponent>();
-            } else if (componentName == "TransformComponent") {
-                return self.HasComponent<TransformComponent>();
-            } else {
-                throw std::runtime_error("Unknown component type");
-            }
+        "SetComponent", [](Entity& self, int typeID, const sol::object& value) {
+            GetComponentAccessor(typeID).set(self, value);
+        },
+
+        "RemoveComponent", [](Entity& self, int typeID) {
+            GetComponentAccessor(typeID).remove(self);
         },
 
-        "RemoveComponent", [](Entity& self, const std::string& componentName) {
-            if (componentName == "TagComponent") {
-                self.RemoveComponent<TagComponent>();
-            } else if (componentName == "TransformComponent") {
-                self.RemoveComponent<TransformComponent>();
+        "SetParent", [](Entity& self, Entity parent) {
+            if (t_CommandBuffer) {
+                t_CommandBuffer->SetParent(self, parent);
             } else {
-                throw std::runtime_error("Unknown component type");
+                self.SetParent(parent);
             }
         },
-
-        "SetParent", &Entity::SetParent,
         "IsValid", [](Entity& self) { return static_cast<bool>(self); }
     );
 
@@ -407,9 +770,35 @@ namespace Coffee {
             "set_world_transform", &TransformComponent::SetWorldTransform
         );
 
+        luaState.new_usertype<LuaTransformRef>("transform_ref",
+            sol::no_constructor,
+            "position", sol::property(
+                [](const LuaTransformRef& self) -> glm::vec3& { return self.Get().Position; },
+                [](const LuaTransformRef& self, const glm::vec3& position) { self.Get().Position = position; }),
+            "rotation", sol::property(
+                [](const LuaTransformRef& self) -> glm::vec3& { return self.Get().Rotation; },
+                [](const LuaTransformRef& self, const glm::vec3& rotation) { self.Get().Rotation = rotation; }),
+            "scale", sol::property(
+                [](const LuaTransformRef& self) -> glm::vec3& { return self.Get().Scale; },
+                [](const LuaTransformRef& self, const glm::vec3& scale) { self.Get().Scale = scale; }),
+            "get_local_transform", [](const LuaTransformRef& self) { return self.Get().GetLocalTransform(); },
+            "set_local_transform", [](const LuaTransformRef& self, const glm::mat4& transform) { self.Get().SetLocalTransform(transform); },
+            "get_world_transform", [](const LuaTransformRef& self) { return self.Get().GetWorldTransform(); },
+            "set_world_transform", [](const LuaTransformRef& self, const glm::mat4& transform) { self.Get().SetWorldTransform(transform); }
+        );
+
         luaState.new_usertype<CameraComponent>("camera_component",
             sol::constructors<CameraComponent()>(),
-            "camera", &CameraComponent::Camera
+            "camera", &CameraComponent::Camera,
+            "fov", sol::property(
+                [](CameraComponent& self) { return self.Camera.GetFOV(); },
+                [](CameraComponent& self, float fov) { self.Camera.SetFOV(fov); }),
+            "near_clip", sol::property(
+                [](CameraComponent& self) { return self.Camera.GetNearClip(); },
+                [](CameraComponent& self, float nearClip) { self.Camera.SetNearClip(nearClip); }),
+            "far_clip", sol::property(
+                [](CameraComponent& self) { return self.Camera.GetFarClip(); },
+                [](CameraComponent& self, float farClip) { self.Camera.SetFarClip(farClip); })
         );
 
         luaState.new_usertype<MeshComponent>("mesh_component",
@@ -436,94 +825,650 @@ namespace Coffee {
             "type", &LightComponent::type
         );
         # pragma endregion
+    }
+
+    static sol::protected_function CreateUpdateDispatcher(sol::state& luaState) {
+        sol::protected_function dispatcherFactory = luaState.load(s_UpdateDispatcherSource, "=UpdateDispatcher");
+        return dispatcherFactory([](const std::string& message) {
+            COFFEE_CORE_ERROR("[Lua Error]: {0}", message);
+
+            // The budget covers every instance of the script, the remaining ones are skipped
+            return s_ActiveScript.overBudget;
+        });
+    }
+
+    // Registers the budget hook, opens the libraries and binds the engine API. The state already uses the tracked allocator
+    static void SetupState(sol::state& luaState) {
+        lua_sethook(luaState.lua_state(), LuaBudgetHook, LUA_MASKCOUNT, LuaBackend::InstructionCheckInterval);
 
+        luaState.open_libraries(sol::lib::base, sol::lib::math, sol::lib::string, sol::lib::table);
+        BindScriptingApi(luaState);
+    }
+
+    void LuaBackend::Initialize() {
+        COFFEE_MEMORY_TAG(Scripting);
+
+        SetupState(luaState);
+
+        // The collector only runs in the steps of CollectGarbage, within GarbageCollectionBudget every frame
+        lua_gc(luaState.lua_state(), LUA_GCSTOP, 0);
+
+        s_UpdateDispatcher = CreateUpdateDispatcher(luaState);
+    }
+
+    // The worker states are created on first use, one per job of the parallel update. Their collectors run on their own
+    static std::vector<Scope<LuaWorkerState>>& GetWorkerStates() {
+        if (s_WorkerStates.empty()) {
+            COFFEE_MEMORY_TAG(Scripting);
+
+            uint32_t count = JobSystem::GetWorkerCount() + 1;
+            for (uint32_t i = 0; i < count; i++) {
+                Scope<LuaWorkerState> workerState = CreateScope<LuaWorkerState>();
+                SetupState(workerState->state);
+                workerState->dispatcher = CreateUpdateDispatcher(workerState->state);
+
+                for (const auto& [name, variable] : s_RegisteredVariables) {
+                    workerState->state[name] = variable;
+                }
+
+                s_WorkerStates.push_back(std::move(workerState));
+            }
+        }
+
+        return s_WorkerStates;
     }
 
     void LuaBackend::ExecuteScript(const std::string& script) {
+        COFFEE_MEMORY_TAG(Scripting);
+
         try {
             sol::environment env(luaState, sol::create, luaState.globals());
-            scriptEnvironments[script] = env;
             luaState.script(script, env);
         } catch (const sol::error& e) {
             COFFEE_CORE_ERROR("[Lua Error]: {0}", e.what());
         }
     }
 
+    // Runs a script file in an environment of a state, the globals the script defines end up in the environment
+    static bool RunScriptFile(sol::state& luaState, const std::filesystem::path& filepath, sol::environment& env) {
+        const LuaCompiledScript* compiled = LuaBackend::CompileFile(filepath);
+        if (!compiled)
+            return false;
+
+        // Every execution loads its own copy of the chunk, so the functions it defines keep the environment they were created in
+        sol::load_result chunk = luaState.load(std::string_view(compiled->bytecode), "@" + filepath.string(), sol::load_mode::binary);
+        if (!chunk.valid()) {
+            sol::error error = chunk;
+            COFFEE_CORE_ERROR("[Lua Error]: Could not load the bytecode of {0}: {1}", filepath.string(), error.what());
+
+            // The cached bytecode is corrupt or from another Lua version, compile it again next time
+            std::filesystem::remove(CacheManager::GetCachePath() / (std::to_string(compiled->sourceHash) + ".luac"));
+            LuaBackend::InvalidateCompiledScript(filepath);
+            return false;
+        }
+
+        sol::protected_function function = chunk;
+        sol::set_environment(env, function);
+
+        sol::protected_function_result result = function();
+        if (!result.valid()) {
+            sol::error error = result;
+            COFFEE_CORE_ERROR("[Lua Error]: {0}", error.what());
+            return false;
+        }
+
+        return true;
+    }
+
     void LuaBackend::ExecuteFile(const std::filesystem::path& filepath) {
-        try {
-            sol::environment env(luaState, sol::create, luaState.globals());
-            scriptEnvironments[filepath.string()] = env;
-            luaState.script_file(filepath.string(), env);
-        } catch (const sol::error& e) {
-            COFFEE_CORE_ERROR("[Lua Error]: {0}", e.what());
+        ZoneScoped;
+        COFFEE_MEMORY_TAG(Scripting);
+
+        const std::string path = filepath.string();
+        LuaScriptCallScope callScope(path, 1);
+
+        sol::environment env(luaState, sol::create, luaState.globals());
+        RunScriptFile(luaState, filepath, env);
+    }
+
+    // Calls a function of a script instance if the script defines it, with self as the argument
+    static void CallInstanceFunction(const sol::environment& env, const char* name) {
+        sol::object function = env.get<sol::object>(name);
+        if (function.get_type() != sol::type::function)
+            return;
+
+        sol::protected_function_result result = function.as<sol::protected_function>()(env.get<sol::object>("self"));
+        if (!result.valid()) {
+            sol::error error = result;
+            COFFEE_CORE_ERROR("[Lua Error]: {0}", error.what());
         }
     }
 
-    void LuaBackend::RegisterFunction(const std::string& script, std::function<int()> func, const std::string& name) {
-        auto it = scriptEnvironments.find(script);
-        if (it != scriptEnvironments.end()) {
-            it->second.set_function(name, func);
-            COFFEE_CORE_INFO("Registered Lua function {0} in script {1}", name, script);
-        } else {
-            COFFEE_CORE_ERROR("Script environment for {0} not found", script);
+    void LuaBackend::CreateInstance(const std::filesystem::path& filepath, const Entity& entity) {
+        ZoneScoped;
+        COFFEE_MEMORY_TAG(Scripting);
+
+        DestroyInstance(entity);
+
+        const std::string path = filepath.string();
+
+        // Thread-safe scripts are spread over the worker states instance by instance, so one script with many
+        // instances is updated by every job
+        int32_t workerState = -1;
+        const LuaCompiledScript* compiled = CompileFile(filepath);
+        if (s_ParallelScripts && compiled && compiled->threadSafe) {
+            std::vector<Scope<LuaWorkerState>>& workerStates = GetWorkerStates();
+            workerState = (int32_t)(s_NextWorkerState++ % workerStates.size());
+        }
+
+        sol::state& state = workerState < 0 ? luaState : s_WorkerStates[workerState]->state;
+
+        sol::environment env(state, sol::create, state.globals());
+        env["self"] = entity;
+        env["entity"] = entity; // Name used by the scripts written before each entity had its own instance
+
+        // Counted first, the memory budget covers the new instance while its file runs
+        LuaScriptUsage& usage = s_ScriptUsage[path];
+        usage.liveInstances++;
+
+        // The budget only covers the script itself, the bookkeeping below must not fail
+        {
+            LuaScriptCallScope callScope(path, usage, 1);
+            if (!RunScriptFile(state, filepath, env)) {
+                usage.liveInstances--;
+                return;
+            }
+        }
+
+        LuaSceneScripts& sceneScripts = s_SceneScripts[entity.GetScene()];
+        sceneScripts.workerBatches.resize(s_WorkerStates.size());
+
+        LuaScriptInstance& instance = sceneScripts.instances[(entt::entity)entity];
+        instance.scriptPath = path;
+        instance.environment = env;
+        instance.workerState = workerState;
+
+        sol::object onUpdate = env["OnUpdate"];
+        if (onUpdate.get_type() == sol::type::function) {
+            LuaScriptBatch& batch = GetInstanceBatches(sceneScripts, workerState)[instance.scriptPath];
+            if (!batch.updates.valid()) {
+                batch.updates = state.create_table();
+                batch.entities = state.create_table();
+            }
+
+            instance.batchIndex = (int32_t)batch.handles.size();
+            batch.handles.push_back((entt::entity)entity);
+            batch.updates[batch.handles.size()] = onUpdate;
+            batch.entities[batch.handles.size()] = env["self"];
+        }
+
+        // Last, OnCreate may create other instances
+        LuaScriptCallScope callScope(path, 1);
+        CallInstanceFunction(env, "OnCreate");
+    }
+
+    void LuaBackend::DestroyInstance(const Entity& entity) {
+        ZoneScoped;
+        COFFEE_MEMORY_TAG(Scripting);
+
+        auto sceneIt = s_SceneScripts.find(entity.GetScene());
+        if (sceneIt == s_SceneScripts.end())
+            return;
+
+        LuaSceneScripts& sceneScripts = sceneIt->second;
+
+        auto instanceIt = sceneScripts.instances.find((entt::entity)entity);
+        if (instanceIt == sceneScripts.instances.end())
+            return;
+
+        sol::environment env = std::move(instanceIt->second.environment);
+        std::string scriptPath = std::move(instanceIt->second.scriptPath);
+        int32_t batchIndex = instanceIt->second.batchIndex;
+        LuaScriptBatches& batches = GetInstanceBatches(sceneScripts, instanceIt->second.workerState);
+        sceneScripts.instances.erase(instanceIt);
+
+        // The last instance of the batch takes the place of the removed one
+        if (batchIndex >= 0) {
+            LuaScriptBatch& batch = batches[scriptPath];
+            int32_t lastIndex = (int32_t)batch.handles.size() - 1;
+
+            if (batchIndex != lastIndex) {
+                entt::entity moved = batch.handles[lastIndex];
+                batch.handles[batchIndex] = moved;
+                batch.updates[batchIndex + 1] = batch.updates[lastIndex + 1];
+                batch.entities[batchIndex + 1] = batch.entities[lastIndex + 1];
+                sceneScripts.instances[moved].batchIndex = batchIndex;
+            }
+
+            batch.handles.pop_back();
+            batch.updates[lastIndex + 1] = sol::lua_nil;
+            batch.entities[lastIndex + 1] = sol::lua_nil;
+
+            if (batch.handles.empty())
+                batches.erase(scriptPath);
+        }
+
+        if (sceneScripts.instances.empty())
+            s_SceneScripts.erase(sceneIt);
+
+        LuaScriptUsage& usage = s_ScriptUsage[scriptPath];
+        {
+            LuaScriptCallScope callScope(scriptPath, usage, 1);
+            CallInstanceFunction(env, "OnDestroy");
+        }
+
+        if (usage.liveInstances > 0)
+            usage.liveInstances--;
+    }
+
+    // Runs the collector in small steps until a cycle ends or the frame budget is spent
+    static void CollectGarbage() {
+        ZoneScoped;
+
+        static Metric& garbageCollectionMetric = Metrics::Gauge("Lua GC Time");
+        static Metric& memoryMetric = Metrics::Gauge("Lua Memory");
+        static size_t memoryAfterCycle = 0;
+
+        lua_State* L = LuaBackend::luaState.lua_state();
+        auto getMemory = [L]() { return (size_t)lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0); };
+
+        auto start = std::chrono::steady_clock::now();
+        auto elapsed = [&start]() { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(); };
+
+        bool cycleEnded = false;
+        while (!cycleEnded && elapsed() < LuaBackend::GarbageCollectionBudget) {
+            cycleEnded = lua_gc(L, LUA_GCSTEP, 0) != 0;
+        }
+
+        // The scripts make garbage faster than the budget collects it, finish the cycle before the heap runs away
+        if (!cycleEnded && getMemory() > 2 * memoryAfterCycle + 8 * 1024 * 1024) {
+            ZoneScopedN("Full Collection");
+            lua_gc(L, LUA_GCCOLLECT, 0);
+            cycleEnded = true;
+        }
+
+        if (cycleEnded)
+            memoryAfterCycle = getMemory();
+
+        garbageCollectionMetric.Set(elapsed());
+        memoryMetric.Set(getMemory() / (1024.0 * 1024.0));
+    }
+
+    // Updates the thread-safe scripts, one job per worker state, then applies their deferred writes to the scene
+    static void UpdateWorkerStates(Scene* scene, std::vector<LuaScriptBatches>& workerBatches) {
+        ZoneScoped;
+
+        static Metric& updatesMetric = Metrics::Counter("Script Updates");
+
+        // One buffer per worker state, played back in order, so the result does not depend on the scheduling
+        std::vector<Scope<EntityCommandBuffer>> commandBuffers;
+        commandBuffers.reserve(workerBatches.size());
+        for (size_t i = 0; i < workerBatches.size(); i++) {
+            commandBuffers.push_back(CreateScope<EntityCommandBuffer>(scene));
+        }
+
+        // The jobs only read the budgets, copied to each worker state so nothing is shared
+        for (size_t i = 0; i < workerBatches.size(); i++) {
+            for (auto& [scriptPath, batch] : workerBatches[i]) {
+                LuaScriptUsage& workerUsage = s_WorkerStates[i]->usage[scriptPath];
+                workerUsage.budget = s_ScriptUsage[scriptPath].budget;
+                workerUsage.liveInstances = s_ScriptUsage[scriptPath].liveInstances;
+            }
+        }
+
+        // The scene is only read until the sync point, every write of the scripts is deferred
+        JobSystem::ParallelFor("Lua Scripts", workerBatches.size(), 1, [&workerBatches, &commandBuffers](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                ZoneScopedN("Lua Worker State");
+
+                LuaWorkerState& workerState = *s_WorkerStates[i];
+                t_CommandBuffer = commandBuffers[i].get();
+
+                for (auto& [scriptPath, batch] : workerBatches[i]) {
+                    uint32_t count = (uint32_t)batch.handles.size();
+                    LuaScriptCallScope callScope(scriptPath, workerState.usage[scriptPath], count);
+
+                    sol::protected_function_result result = workerState.dispatcher(batch.updates, batch.entities, count);
+                    if (!result.valid()) {
+                        sol::error error = result;
+                        COFFEE_CORE_ERROR("[Lua Error]: {0}", error.what());
+                    }
+
+                    updatesMetric.Add(count);
+                }
+
+                t_CommandBuffer = nullptr;
+            }
+        });
+
+        // Sync point
+        {
+            ZoneScopedN("Sync Point");
+            for (Scope<EntityCommandBuffer>& commandBuffer : commandBuffers) {
+                commandBuffer->Playback();
+            }
+
+            for (Scope<LuaWorkerState>& workerState : s_WorkerStates) {
+                for (auto& [scriptPath, usage] : workerState->usage) {
+                    LuaScriptUsage& totalUsage = s_ScriptUsage[scriptPath];
+                    totalUsage.currentFrame.cpuTime += usage.currentFrame.cpuTime;
+                    totalUsage.currentFrame.instructions += usage.currentFrame.instructions;
+                    totalUsage.currentFrame.allocatedBytes += usage.currentFrame.allocatedBytes;
+                    totalUsage.currentFrame.instances += usage.currentFrame.instances;
+                    totalUsage.violations += usage.violations;
+
+                    usage.currentFrame = {};
+                    usage.violations = 0;
+                }
+            }
+        }
+    }
+
+    void LuaBackend::UpdateInstances(Scene* scene) {
+        ZoneScoped;
+        COFFEE_MEMORY_TAG(Scripting);
+
+        static Metric& updatesMetric = Metrics::Counter("Script Updates");
+
+        // A new frame of stats
+        for (auto& [scriptPath, usage] : s_ScriptUsage) {
+            usage.lastFrame = usage.currentFrame;
+            usage.currentFrame = {};
+        }
+
+        auto sceneIt = s_SceneScripts.find(scene);
+        if (sceneIt != s_SceneScripts.end() && !sceneIt->second.workerBatches.empty())
+            UpdateWorkerStates(scene, sceneIt->second.workerBatches);
+
+        // The commands can create and destroy instances, the scene is looked up again
+        sceneIt = s_SceneScripts.find(scene);
+        if (sceneIt != s_SceneScripts.end()) {
+            // The scripts can create and destroy instances while they run, so the batches are taken first
+            struct PendingBatch {
+                std::string scriptPath;
+                sol::table updates;
+                sol::table entities;
+                uint32_t count;
+            };
+
+            std::vector<PendingBatch> pendingBatches;
+            pendingBatches.reserve(sceneIt->second.batches.size());
+            for (auto& [scriptPath, batch] : sceneIt->second.batches) {
+                pendingBatches.push_back({scriptPath, batch.updates, batch.entities, (uint32_t)batch.handles.size()});
+            }
+
+            for (PendingBatch& batch : pendingBatches) {
+                LuaScriptCallScope callScope(batch.scriptPath, batch.count);
+
+                sol::protected_function_result result = s_UpdateDispatcher(batch.updates, batch.entities, batch.count);
+                if (!result.valid()) {
+                    sol::error error = result;
+                    COFFEE_CORE_ERROR("[Lua Error]: {0}", error.what());
+                }
+
+                updatesMetric.Add(batch.count);
+            }
+        }
+
+        CollectGarbage();
+    }
+
+    void LuaBackend::SetScriptBudget(const std::string& script, const LuaScriptBudget& budget) {
+        s_ScriptUsage[script].budget = budget;
+    }
+
+    std::vector<std::pair<std::string, LuaScriptStats>> LuaBackend::GetScriptStats() {
+        std::vector<std::pair<std::string, LuaScriptStats>> stats;
+        stats.reserve(s_ScriptUsage.size());
+
+        auto addLiveBytes = [](const LuaStateMemory& memory, const std::string& scriptPath, size_t& liveBytes) {
+            auto liveIt = memory.liveBytes.find(scriptPath);
+            if (liveIt != memory.liveBytes.end())
+                liveBytes += liveIt->second;
+        };
+
+        for (const auto& [scriptPath, usage] : s_ScriptUsage) {
+            LuaScriptStats scriptStats = usage.lastFrame;
+            scriptStats.violations = usage.violations;
+
+            addLiveBytes(s_MainStateMemory, scriptPath, scriptStats.liveBytes);
+            for (const Scope<LuaWorkerState>& workerState : s_WorkerStates) {
+                addLiveBytes(workerState->memory, scriptPath, scriptStats.liveBytes);
+            }
+            stats.emplace_back(scriptPath, scriptStats);
+        }
+
+        return stats;
+    }
+
+    sol::environment* LuaBackend::GetInstanceEnvironment(const Entity& entity) {
+        auto sceneIt = s_SceneScripts.find(entity.GetScene());
+        if (sceneIt == s_SceneScripts.end())
+            return nullptr;
+
+        auto instanceIt = sceneIt->second.instances.find((entt::entity)entity);
+        return instanceIt != sceneIt->second.instances.end() ? &instanceIt->second.environment : nullptr;
+    }
+
+    // FNV-1a over the path and the source. The path is part of the key because the bytecode keeps it for the error messages
+    static uint64_t HashScriptSource(const std::string& path, const std::string& source) {
+        uint64_t hash = 14695981039346656037ull ^ (uint64_t)LUA_VERSION_NUM;
+
+        auto hashBytes = [&hash](const std::string& bytes) {
+            for (unsigned char c : bytes) {
+                hash ^= c;
+                hash *= 1099511628211ull;
+            }
+        };
+
+        hashBytes(path);
+        hashBytes(source);
+        return hash;
+    }
+
+    static std::string_view TrimWhitespace(std::string_view text) {
+        size_t first = text.find_first_not_of(" \t\r");
+        if (first == std::string_view::npos)
+            return {};
+
+        size_t last = text.find_last_not_of(" \t\r");
+        return text.substr(first, last - first + 1);
+    }
+
+    // The type the editor shows for the default value of an exported variable, lua_nil if it is not a literal
+    static sol::type GetLiteralType(std::string_view value) {
+        if (value == "true" || value == "false")
+            return sol::type::boolean;
+
+        if (value.front() == '"' || value.front() == '\'' || value.substr(0, 2) == "[[")
+            return sol::type::string;
+
+        std::string number(value);
+        char* end = nullptr;
+        std::strtod(number.c_str(), &end);
+        return end == number.c_str() + number.size() ? sol::type::number : sol::type::lua_nil;
+    }
+
+    // Finds the "--[[export]] name = value" variables and the "--[[header]] text" separators, one per line
+    static std::vector<LuaVariable> FindExportedVariables(std::string_view source) {
+        std::vector<LuaVariable> variables;
+
+        size_t lineStart = 0;
+        while (lineStart < source.size()) {
+            size_t lineEnd = source.find('\n', lineStart);
+            if (lineEnd == std::string_view::npos)
+                lineEnd = source.size();
+
+            std::string_view line = source.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+
+            size_t comment = line.find("--");
+            if (comment == std::string_view::npos)
+                continue;
+
+            std::string_view annotation = line.substr(comment + 2);
+
+            if (annotation.substr(0, 10) == "[[export]]") {
+                std::string_view declaration = annotation.substr(10);
+                if (declaration.empty() || (declaration.front() != ' ' && declaration.front() != '\t'))
+                    continue;
+
+                declaration = TrimWhitespace(declaration);
+
+                size_t nameEnd = 0;
+                while (nameEnd < declaration.size() && (std::isalnum((unsigned char)declaration[nameEnd]) || declaration[nameEnd] == '_'))
+                    nameEnd++;
+
+                std::string_view name = declaration.substr(0, nameEnd);
+                std::string_view assignment = TrimWhitespace(declaration.substr(nameEnd));
+                if (name.empty() || assignment.empty() || assignment.front() != '=')
+                    continue;
+
+                std::string_view value = TrimWhitespace(assignment.substr(1));
+                if (value.empty())
+                    continue;
+
+                variables.push_back({std::string(name), std::string(value), GetLiteralType(value)});
+            } else {
+                annotation = TrimWhitespace(annotation);
+                if (annotation.substr(0, 10) != "[[header]]")
+                    continue;
+
+                std::string_view text = TrimWhitespace(annotation.substr(10));
+                if (!text.empty())
+                    variables.push_back({"header", std::string(text), sol::type::none});
+            }
         }
+
+        return variables;
     }
 
-    void LuaBackend::BindFunction(const std::string& script, const std::string& name, std::function<int()>& func) {
-        auto it = scriptEnvironments.find(script);
-        if (it != scriptEnvironments.end()) {
-            func = it->second[name];
-            COFFEE_CORE_INFO("Bound Lua function {0} in script {1}", name, script);
+    // Finds the "--[[thread_safe]]" annotation, on a line of its own
+    static bool HasThreadSafeAnnotation(std::string_view source) {
+        size_t lineStart = 0;
+        while (lineStart < source.size()) {
+            size_t lineEnd = source.find('\n', lineStart);
+            if (lineEnd == std::string_view::npos)
+                lineEnd = source.size();
+
+            if (TrimWhitespace(source.substr(lineStart, lineEnd - lineStart)) == "--[[thread_safe]]")
+                return true;
+
+            lineStart = lineEnd + 1;
+        }
+
+        return false;
+    }
+
+    static int WriteBytecode(lua_State* L, const void* data, size_t size, void* userData) {
+        ((std::string*)userData)->append((const char*)data, size);
+        return 0;
+    }
+
+    const LuaCompiledScript* LuaBackend::CompileFile(const std::filesystem::path& filepath) {
+        ZoneScoped;
+
+        const std::string path = filepath.string();
+
+        // Scripts that failed are cached too, with no bytecode, so they are not read every frame until they change
+        auto it = s_CompiledScripts.find(path);
+        if (it != s_CompiledScripts.end())
+            return it->second.bytecode.empty() ? nullptr : &it->second;
+
+        // Edited scripts are compiled again on their next use
+        if (s_WatchedScripts.insert(path).second) {
+            FileWatcher::Watch(filepath, [path](const std::filesystem::path&) {
+                LuaBackend::InvalidateCompiledScript(path);
+            });
+        }
+
+        LuaCompiledScript& compiled = s_CompiledScripts[path];
+
+        std::ifstream scriptFile(filepath, std::ios::binary);
+        if (!scriptFile) {
+            COFFEE_CORE_ERROR("[Lua Error]: Could not open script {0}", path);
+            return nullptr;
+        }
+        std::string source((std::istreambuf_iterator<char>(scriptFile)), std::istreambuf_iterator<char>());
+
+        compiled.sourceHash = HashScriptSource(path, source);
+        compiled.variables = FindExportedVariables(source);
+        compiled.threadSafe = HasThreadSafeAnnotation(source);
+
+        std::filesystem::path cachedFilePath = CacheManager::GetCachePath() / (std::to_string(compiled.sourceHash) + ".luac");
+
+        std::ifstream cachedFile(cachedFilePath, std::ios::binary);
+        if (cachedFile) {
+            compiled.bytecode.assign((std::istreambuf_iterator<char>(cachedFile)), std::istreambuf_iterator<char>());
+        }
+
+        if (compiled.bytecode.empty()) {
+            ZoneScopedN("Compile");
+
+            lua_State* L = luaState.lua_state();
+            std::string chunkName = "@" + path;
+            if (luaL_loadbufferx(L, source.data(), source.size(), chunkName.c_str(), "t") != LUA_OK) {
+                COFFEE_CORE_ERROR("[Lua Error]: {0}", lua_tostring(L, -1));
+                lua_pop(L, 1);
+                return nullptr;
+            }
+
+            lua_dump(L, WriteBytecode, &compiled.bytecode, 0);
+            lua_pop(L, 1);
+
+            CacheManager::CreateCacheDirectory();
+            std::ofstream outputFile(cachedFilePath, std::ios::binary);
+            outputFile.write(compiled.bytecode.data(), (std::streamsize)compiled.bytecode.size());
+        }
+
+        return &compiled;
+    }
+
+    void LuaBackend::InvalidateCompiledScript(const std::filesystem::path& filepath) {
+        s_CompiledScripts.erase(filepath.string());
+    }
+
+    void LuaBackend::RegisterFunction(const std::string& script, std::function<int()> func, const std::string& name) {
+        uint32_t registered = 0;
+        for (auto& [scene, sceneScripts] : s_SceneScripts) {
+            for (auto& [entity, instance] : sceneScripts.instances) {
+                if (instance.scriptPath == script) {
+                    instance.environment.set_function(name, func);
+                    registered++;
+                }
+            }
+        }
+
+        if (registered > 0) {
+            COFFEE_CORE_INFO("Registered Lua function {0} in {1} instances of script {2}", name, registered, script);
         } else {
-            COFFEE_CORE_ERROR("Script environment for {0} not found", script);
+            COFFEE_CORE_ERROR("No instance of script {0} found", script);
         }
     }
 
     void LuaBackend::RegisterVariable(const std::string& name, void* variable)
     {
         luaState[name] = variable;
+        s_RegisteredVariables[name] = variable;
+
+        for (Scope<LuaWorkerState>& workerState : s_WorkerStates) {
+            workerState->state[name] = variable;
+        }
     }
 
-    // This function will check all the variables from the script and map them to a cpp map so we can expose them in the editor
-    std::vector<LuaVariable> LuaBackend::MapVariables(const std::string& scriptPath) {
-        std::vector<LuaVariable> variables;
-        std::ifstream scriptFile(scriptPath);
-        std::string script((std::istreambuf_iterator<char>(scriptFile)), std::istreambuf_iterator<char>());
-
-        std::regex exportRegex(R"(--\[\[export\]\]\s+(\w+)\s*=\s*(.+))"); // --[[export]] variable = value
-        std::regex headerRegex(R"(--\s*\[\[header\]\]\s*(.+))"); // --[[header]] Esto es un header
-        std::regex combinedRegex(R"(--\[\[export\]\]\s+(\w+)\s*=\s*(.+)|--\s*\[\[header\]\]\s*(.+))");
-        std::smatch match;
-        std::string::const_iterator searchStart(script.cbegin());
-
-        auto it = scriptEnvironments.find(scriptPath);
-        if (it == scriptEnvironments.end()) {
-            COFFEE_CORE_ERROR("Script environment for {0} not found", scriptPath);
-            return variables;
-        }
-
-        sol::environment& env = it->second;
-
-        while (std::regex_search(searchStart, script.cend(), match, combinedRegex)) {
-            LuaVariable variable;
-            if (match[1].matched) {
-                variable.name = match[1];
-                variable.value = match[2];
-                variable.type = env[variable.name].get_type();
-            } else if (match[3].matched) {
-                variable.name = "header";
-                variable.value = match[3];
-                variable.type = sol::type::none;
-            }
+    void LuaBackend::SetParallelScripts(bool enabled) {
+        s_ParallelScripts = enabled;
+    }
 
-            // Store the variable in the vector
-            variables.push_back(variable);
+    bool LuaBackend::IsParallelScriptsEnabled() {
+        return s_ParallelScripts;
+    }
 
-            // Move to the next match
-            searchStart = match.suffix().first;
-        }
+    const std::vector<LuaVariable>& LuaBackend::MapVariables(const std::string& scriptPath) {
+        static const std::vector<LuaVariable> noVariables;
 
-        return variables;
+        const LuaCompiledScript* compiled = CompileFile(scriptPath);
+        return compiled ? compiled->variables : noVariables;
     }
 
 } // namespace Coffee
\ No newline at end of file
@@ -6,7 +6,7 @@
 #include <sol/sol.hpp>
 #include <string>
 #include <fstream>
-#include <regex>
+#include <vector>
 
 namespace Coffee {
 
@@ -16,6 +16,36 @@ namespace Coffee {
         sol::type type;
     };
 
+    /**
+     * @brief A Lua script compiled to bytecode.
+     */
+    struct LuaCompiledScript {
+        uint64_t sourceHash = 0; ///< Hash of the path and source the bytecode was compiled from.
+        std::string bytecode; ///< Output of lua_dump, loaded in binary mode.
+        std::vector<LuaVariable> variables; ///< Exported variables and headers, in source order.
+        bool threadSafe = false; ///< The script is annotated with --[[thread_safe]].
+    };
+
+    /**
+     * @brief Limits of a script, for each of its instances. Instructions are counted per call, memory across calls.
+     */
+    struct LuaScriptBudget {
+        uint64_t instructions = 10000000; ///< Lua instructions an instance may run.
+        size_t memory = 16 * 1024 * 1024; ///< Bytes an instance may hold, across calls, until the collector frees them.
+    };
+
+    /**
+     * @brief Resources a script used, summed over its instances.
+     */
+    struct LuaScriptStats {
+        float cpuTime = 0.0f; ///< Milliseconds spent running the script in the last frame.
+        uint64_t instructions = 0; ///< Lua instructions run in the last frame, counted every InstructionCheckInterval instructions.
+        size_t allocatedBytes = 0; ///< Bytes allocated in the last frame.
+        size_t liveBytes = 0; ///< Bytes the script still holds, in every Lua state, garbage not collected yet included.
+        uint32_t instances = 0; ///< Instances updated in the last frame.
+        uint64_t violations = 0; ///< Times the script went over its budget since it was first run.
+    };
+
     class LuaBackend : public IScriptingBackend {
 
         public:
@@ -23,11 +53,86 @@ namespace Coffee {
             void ExecuteScript(const std::string& script) override;
             void ExecuteFile(const std::filesystem::path& filepath) override;
             void RegisterFunction(const std::string& script, std::function<int()> func, const std::string& name) override;
-            void BindFunction(const std::string& script, const std::string& name, std::function<int()>& func) override;
             void RegisterVariable(const std::string& name, void* variable) override;
-            static std::vector<LuaVariable> MapVariables(const std::string& script);
+            void CreateInstance(const std::filesystem::path& filepath, const Entity& entity) override;
+            void DestroyInstance(const Entity& entity) override;
+            void UpdateInstances(Scene* scene) override;
+
+            /**
+             * @brief Gets the variables a script exposes to the editor with --[[export]] and its --[[header]] separators.
+             *
+             * The variables are found when the script is compiled and cached with its bytecode, so this
+             * only reads the source again after the file changed.
+             *
+             * @param script The path of the script.
+             * @return The variables, empty if the script could not be compiled.
+             */
+            static const std::vector<LuaVariable>& MapVariables(const std::string& script);
+
+            /**
+             * @brief Gets the environment of the script instance of an entity, which holds its variables.
+             * @param entity The entity.
+             * @return The environment, nullptr if the entity has no Lua script instance.
+             */
+            static sol::environment* GetInstanceEnvironment(const Entity& entity);
+
+            /**
+             * @brief Compiles a script file to bytecode, or gets it from the cache.
+             *
+             * The bytecode is kept in memory until the file changes, and on disk in the cache
+             * directory under the hash of the source, so an unchanged script is only parsed once.
+             *
+             * @param filepath The path of the script.
+             * @return The compiled script, nullptr if it could not be read or compiled.
+             */
+            static const LuaCompiledScript* CompileFile(const std::filesystem::path& filepath);
+
+            /**
+             * @brief Drops the compiled script from the memory cache, so the next use recompiles it.
+             * @param filepath The path of the script.
+             */
+            static void InvalidateCompiledScript(const std::filesystem::path& filepath);
+
+            static constexpr int InstructionCheckInterval = 1000; ///< Instructions between two checks of the instruction budget.
+            static constexpr double GarbageCollectionBudget = 1.0; ///< Milliseconds of garbage collection per frame.
+
+            /**
+             * @brief Sets the budget of a script, scripts without one use the default LuaScriptBudget.
+             *
+             * A script over its budget is stopped with a Lua error, and the rest of its instances are
+             * not updated that frame. The violation is logged and counted in the "Lua Budget Violations" metric.
+             *
+             * @param script The path of the script.
+             * @param budget The budget.
+             */
+            static void SetScriptBudget(const std::string& script, const LuaScriptBudget& budget);
+
+            /**
+             * @brief Gets the resources used by every script that has run.
+             * @return The path and stats of each script.
+             */
+            static std::vector<std::pair<std::string, LuaScriptStats>> GetScriptStats();
+
+            /**
+             * @brief Enables running the thread-safe scripts in parallel, for the instances created afterwards.
+             *
+             * The instances of scripts annotated with --[[thread_safe]] are spread over worker Lua states,
+             * one per job of the JobSystem, whose OnUpdate run in parallel. In those states GetComponent
+             * returns a copy of the component, and SetComponent, AddComponent, RemoveComponent and SetParent
+             * are recorded and applied on the main thread once every worker state has been updated, before
+             * the other scripts run. OnCreate and OnDestroy still run on the main thread, with direct access.
+             *
+             * @param enabled True to run the thread-safe scripts in parallel.
+             */
+            static void SetParallelScripts(bool enabled);
+
+            /**
+             * @brief Whether the thread-safe scripts run in parallel.
+             * @return True if parallel scripts are enabled.
+             */
+            static bool IsParallelScriptsEnabled();
+
             static sol::state luaState;
-            static std::unordered_map<std::string, sol::environment> scriptEnvironments;
     };
 
 } // namespace Coffee
\ No newline at end of file
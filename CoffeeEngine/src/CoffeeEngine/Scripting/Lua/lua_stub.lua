@@ -318,7 +318,9 @@ TransformComponent = {
 }
 
 CameraComponent = {
-    Camera = {}
+    fov = 45.0,
+    near_clip = 0.1,
+    far_clip = 100.0
 }
 
 MeshComponent = {
@@ -345,20 +347,40 @@ LightComponent = {
     type = 0
 }
 
+-- Component type IDs, used with the Entity component functions
+component = {
+    Tag = 0,
+    Transform = 1,
+    Mesh = 2,
+    Material = 3,
+    Light = 4,
+    Camera = 5
+}
+
 -- Entity functions
+-- The components returned are references to the component of the entity, valid until components are added or removed.
+-- Transforms are looked up through their entity on each access instead, so they stay valid when the scene tree sorts
+-- the transform pool with the Sorted Transforms scene setting
+-- Scripts with a --[[thread_safe]] line may run on a worker thread when parallel scripts are enabled. Their OnUpdate then
+-- gets copies of the components, and SetComponent, AddComponent, RemoveComponent and SetParent take effect after every
+-- thread-safe script has been updated. AddComponent of a component the entity does not have yet returns nil there
 Entity = {
-    AddComponent = function(self, componentName)
+    AddComponent = function(self, componentType)
         -- Implementation here
+        return {}
     end,
-    GetComponent = function(self, componentName)
+    GetComponent = function(self, componentType)
         -- Implementation here
         return {}
     end,
-    HasComponent = function(self, componentName)
+    HasComponent = function(self, componentType)
         -- Implementation here
         return false
     end,
-    RemoveComponent = function(self, componentName)
+    SetComponent = function(self, componentType, value)
+        -- Implementation here
+    end,
+    RemoveComponent = function(self, componentType)
         -- Implementation here
     end,
     SetParent = function(self, parent)
@@ -368,4 +390,7 @@ Entity = {
         -- Implementation here
         return true
     end
-}
\ No newline at end of file
+}
+
+-- The entity the script instance belongs to, also passed to OnCreate, OnUpdate and OnDestroy
+self = Entity
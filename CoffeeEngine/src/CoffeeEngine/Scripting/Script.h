@@ -1,9 +1,9 @@
 #pragma once
 
+#include "CoffeeEngine/Scene/Entity.h"
 #include "CoffeeEngine/Scripting/ScriptManager.h"
 #include <entt/entity/registry.hpp>
 
-#include <functional>
 #include <filesystem>
 
 namespace Coffee
@@ -14,10 +14,6 @@ namespace Coffee
         Script(const std::filesystem::path& filepath, ScriptingLanguage language)
             : m_Language(language), m_Path(filepath) {}
 
-        std::function<int()> OnCreate;
-        std::function<int()> OnUpdate;
-        std::function<int()> OnDestroy;
-
         const std::filesystem::path& GetPath() const { return m_Path; }
         const ScriptingLanguage& GetLanguage() const { return m_Language; }
 
@@ -31,31 +27,22 @@ namespace Coffee
         Script script;
 
         ScriptComponent() = default;
-        ScriptComponent(const std::filesystem::path& filepath, ScriptingLanguage language, entt::registry& registry)
-            : script(filepath, language)
-        {
-            registry.on_construct<ScriptComponent>().connect<&ScriptComponent::OnConstruct>();
-            registry.on_destroy<ScriptComponent>().connect<&ScriptComponent::OnDestroy>();
-        }
+        ScriptComponent(const std::filesystem::path& filepath, ScriptingLanguage language)
+            : script(filepath, language) {}
         ScriptComponent(const Script& script)
             : script(script) {}
 
-        static void OnConstruct(entt::registry& registry, entt::entity entity)
+        // Connected by the Scene to its registry, each entity gets its own instance of the script
+        static void OnConstruct(Scene& scene, entt::registry& registry, entt::entity entity)
         {
             auto& scriptComponent = registry.get<ScriptComponent>(entity);
-            
-            ScriptManager::ExecuteScriptFromFile(scriptComponent.script);
-            ScriptManager::BindFunction(scriptComponent.script.GetPath().string(), "OnCreate", scriptComponent.script.OnCreate);
-            ScriptManager::BindFunction(scriptComponent.script.GetPath().string(), "OnUpdate", scriptComponent.script.OnUpdate);
-            ScriptManager::BindFunction(scriptComponent.script.GetPath().string(), "OnDestroy", scriptComponent.script.OnDestroy);
-
-            scriptComponent.script.OnCreate();
+            ScriptManager::CreateInstance(scriptComponent.script, Entity{entity, &scene});
         }
 
-        static void OnDestroy(entt::registry& registry, entt::entity entity)
+        static void OnDestroy(Scene& scene, entt::registry& registry, entt::entity entity)
         {
             auto& scriptComponent = registry.get<ScriptComponent>(entity);
-            scriptComponent.script.OnDestroy();
+            ScriptManager::DestroyInstance(scriptComponent.script, Entity{entity, &scene});
         }
     };
-}
\ No newline at end of file
+}
@@ -21,15 +21,29 @@ namespace Coffee {
         }
     }
 
-    void ScriptManager::BindFunction(const std::string& script, const std::string& name, std::function<int()>& func) {
+    void ScriptManager::RegisterVariable(const std::string& name, void* variable) {
         for(auto& backend : backends) {
-            backend.second->BindFunction(script, name, func);
+            backend.second->RegisterVariable(name, variable);
         }
     }
 
-    void ScriptManager::RegisterVariable(const std::string& name, void* variable) {
+    void ScriptManager::CreateInstance(const Script& script, const Entity& entity) {
+        auto it = backends.find(script.GetLanguage());
+        if (it != backends.end()) {
+            it->second->CreateInstance(script.GetPath(), entity);
+        }
+    }
+
+    void ScriptManager::DestroyInstance(const Script& script, const Entity& entity) {
+        auto it = backends.find(script.GetLanguage());
+        if (it != backends.end()) {
+            it->second->DestroyInstance(entity);
+        }
+    }
+
+    void ScriptManager::UpdateInstances(Scene* scene) {
         for(auto& backend : backends) {
-            backend.second->RegisterVariable(name, variable);
+            backend.second->UpdateInstances(scene);
         }
     }
 
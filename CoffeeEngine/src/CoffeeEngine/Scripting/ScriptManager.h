@@ -7,6 +7,8 @@
 
 namespace Coffee {
 
+    class Entity;
+    class Scene;
     class Script;
 
     enum class ScriptingLanguage {
@@ -19,8 +21,10 @@ namespace Coffee {
         static void RegisterBackend(ScriptingLanguage language, std::shared_ptr<IScriptingBackend> backend);
         static void ExecuteScriptFromFile(Script script);
         static void RegisterFunction(const std::string& script, const std::string& name, std::function<int()> func);
-        static void BindFunction(const std::string& script, const std::string& name, std::function<int()>& func);
         static void RegisterVariable(const std::string& name, void* variable);
+        static void CreateInstance(const Script& script, const Entity& entity);
+        static void DestroyInstance(const Script& script, const Entity& entity);
+        static void UpdateInstances(Scene* scene);
 
     private:
         static std::unordered_map<ScriptingLanguage, Ref<IScriptingBackend>> backends;
@@ -0,0 +1,254 @@
+#include "NullRendererAPI.h"
+#include "CoffeeEngine/Core/Log.h"
+
+#include <cstring>
+#include <glad/glad.h>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    static uint64_t s_GLCallCount = 0; ///< OpenGL calls swallowed by the null entry points.
+    static GLuint s_NextObjectID = 1; ///< Fake object names handed out by the null entry points.
+
+    // Generic entry point that accepts any arguments and returns a zero value
+    template<typename Function>
+    struct NullFunction;
+
+    template<typename R, typename... Args>
+    struct NullFunction<R (APIENTRYP)(Args...)>
+    {
+        static R APIENTRY Call(Args...)
+        {
+            s_GLCallCount++;
+            return R();
+        }
+    };
+
+    template<typename Function>
+    static void SetNull(Function& function)
+    {
+        function = NullFunction<Function>::Call;
+    }
+
+    // Entry points whose results are used by the resources need a meaningful answer
+
+    static void APIENTRY NullGenObjects(GLsizei n, GLuint* objects)
+    {
+        s_GLCallCount++;
+        for (GLsizei i = 0; i < n; i++)
+            objects[i] = s_NextObjectID++;
+    }
+
+    static void APIENTRY NullCreateTextures(GLenum target, GLsizei n, GLuint* textures)
+    {
+        NullGenObjects(n, textures);
+    }
+
+    static GLuint APIENTRY NullCreateShader(GLenum type)
+    {
+        s_GLCallCount++;
+        return s_NextObjectID++;
+    }
+
+    static GLuint APIENTRY NullCreateProgram()
+    {
+        s_GLCallCount++;
+        return s_NextObjectID++;
+    }
+
+    // Shaders always compile and link successfully
+    static void APIENTRY NullGetObjectiv(GLuint object, GLenum pname, GLint* params)
+    {
+        s_GLCallCount++;
+        *params = (pname == GL_COMPILE_STATUS || pname == GL_LINK_STATUS) ? GL_TRUE : 0;
+    }
+
+    static void APIENTRY NullGetInfoLog(GLuint object, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+    {
+        s_GLCallCount++;
+        if (length) *length = 0;
+        if (infoLog && bufSize > 0) infoLog[0] = '\0';
+    }
+
+    static GLint APIENTRY NullGetUniformLocation(GLuint program, const GLchar* name)
+    {
+        s_GLCallCount++;
+        return -1;
+    }
+
+    static const GLubyte* APIENTRY NullGetString(GLenum name)
+    {
+        s_GLCallCount++;
+        return reinterpret_cast<const GLubyte*>("Null");
+    }
+
+    static void APIENTRY NullGetTextureLevelParameteriv(GLuint texture, GLint level, GLenum pname, GLint* params)
+    {
+        s_GLCallCount++;
+        *params = (pname == GL_TEXTURE_INTERNAL_FORMAT) ? GL_RGBA8 : 1;
+    }
+
+    static void APIENTRY NullGetTextureParameteriv(GLuint texture, GLenum pname, GLint* params)
+    {
+        s_GLCallCount++;
+        *params = 1;
+    }
+
+    static void APIENTRY NullReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels)
+    {
+        s_GLCallCount++;
+
+        size_t components = (format == GL_RED) ? 1 : (format == GL_RG) ? 2 : (format == GL_RGB) ? 3 : 4;
+        size_t componentSize = (type == GL_FLOAT || type == GL_INT || type == GL_UNSIGNED_INT) ? 4 : 1;
+        std::memset(pixels, 0, width * height * components * componentSize);
+    }
+
+    // Points every GLAD entry point used by the engine to a null implementation
+    static void LoadNullGL()
+    {
+        SetNull(glad_glAttachShader);
+        SetNull(glad_glBindBuffer);
+        SetNull(glad_glBindBufferBase);
+        SetNull(glad_glBindFramebuffer);
+        SetNull(glad_glBindTexture);
+        SetNull(glad_glBindTextureUnit);
+        SetNull(glad_glBindVertexArray);
+        SetNull(glad_glBlendFunc);
+        SetNull(glad_glBufferData);
+        SetNull(glad_glBufferSubData);
+        SetNull(glad_glClear);
+        SetNull(glad_glClearColor);
+        SetNull(glad_glClearTexImage);
+        SetNull(glad_glCompileShader);
+        SetNull(glad_glCopyImageSubData);
+        SetNull(glad_glCullFace);
+        SetNull(glad_glDebugMessageCallback);
+        SetNull(glad_glDebugMessageControl);
+        SetNull(glad_glDeleteBuffers);
+        SetNull(glad_glDeleteFramebuffers);
+        SetNull(glad_glDeleteProgram);
+        SetNull(glad_glDeleteShader);
+        SetNull(glad_glDeleteTextures);
+        SetNull(glad_glDeleteVertexArrays);
+        SetNull(glad_glDepthFunc);
+        SetNull(glad_glDepthMask);
+        SetNull(glad_glDrawArrays);
+        SetNull(glad_glDrawElements);
+        SetNull(glad_glEnable);
+        SetNull(glad_glEnableVertexAttribArray);
+        SetNull(glad_glGenerateTextureMipmap);
+        SetNull(glad_glLineWidth);
+        SetNull(glad_glLinkProgram);
+        SetNull(glad_glNamedBufferData);
+        SetNull(glad_glNamedBufferSubData);
+        SetNull(glad_glNamedFramebufferDrawBuffers);
+        SetNull(glad_glNamedFramebufferTexture);
+        SetNull(glad_glReadBuffer);
+        SetNull(glad_glShaderSource);
+        SetNull(glad_glTexImage2D);
+        SetNull(glad_glTexParameteri);
+        SetNull(glad_glTextureParameterf);
+        SetNull(glad_glTextureParameteri);
+        SetNull(glad_glTextureStorage2D);
+        SetNull(glad_glTextureStorage3D);
+        SetNull(glad_glTextureSubImage2D);
+        SetNull(glad_glUniform1f);
+        SetNull(glad_glUniform1i);
+        SetNull(glad_glUniform2fv);
+        SetNull(glad_glUniform3fv);
+        SetNull(glad_glUniform4fv);
+        SetNull(glad_glUniformMatrix2fv);
+        SetNull(glad_glUniformMatrix3fv);
+        SetNull(glad_glUniformMatrix4fv);
+        SetNull(glad_glUseProgram);
+        SetNull(glad_glVertexAttribDivisor);
+        SetNull(glad_glVertexAttribIPointer);
+        SetNull(glad_glVertexAttribPointer);
+        SetNull(glad_glViewport);
+
+        glad_glGenBuffers = NullGenObjects;
+        glad_glGenTextures = NullGenObjects;
+        glad_glCreateBuffers = NullGenObjects;
+        glad_glCreateFramebuffers = NullGenObjects;
+        glad_glCreateVertexArrays = NullGenObjects;
+        glad_glCreateTextures = NullCreateTextures;
+        glad_glCreateShader = NullCreateShader;
+        glad_glCreateProgram = NullCreateProgram;
+        glad_glGetShaderiv = NullGetObjectiv;
+        glad_glGetProgramiv = NullGetObjectiv;
+        glad_glGetShaderInfoLog = NullGetInfoLog;
+        glad_glGetProgramInfoLog = NullGetInfoLog;
+        glad_glGetUniformLocation = NullGetUniformLocation;
+        glad_glGetString = NullGetString;
+        glad_glGetTextureLevelParameteriv = NullGetTextureLevelParameteriv;
+        glad_glGetTextureParameteriv = NullGetTextureParameteriv;
+        glad_glReadPixels = NullReadPixels;
+    }
+
+    NullRendererAPI::NullRendererAPI()
+    {
+        LoadNullGL();
+    }
+
+    void NullRendererAPI::InitImpl()
+    {
+        ZoneScoped;
+
+        COFFEE_CORE_INFO("NullRendererAPI: Running without a GPU, all the rendering commands are recorded and discarded");
+    }
+
+    void NullRendererAPI::SetClearColorImpl(const glm::vec4& color)
+    {
+        m_Counters.StateChanges++;
+        Record(Command::Type::SetClearColor);
+    }
+
+    void NullRendererAPI::ClearImpl()
+    {
+        m_Counters.Clears++;
+        Record(Command::Type::Clear);
+    }
+
+    void NullRendererAPI::SetDepthMaskImpl(bool enabled)
+    {
+        m_Counters.StateChanges++;
+        Record(Command::Type::SetDepthMask);
+    }
+
+    void NullRendererAPI::DrawIndexedImpl(const Ref<VertexArray>& vertexArray)
+    {
+        uint32_t count = vertexArray->GetIndexBuffer()->GetCount();
+
+        m_Counters.DrawCalls++;
+        m_Counters.IndexCount += count;
+        Record(Command::Type::DrawIndexed, count);
+    }
+
+    void NullRendererAPI::DrawLinesImpl(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, float lineWidth)
+    {
+        m_Counters.DrawCalls++;
+        m_Counters.LineVertexCount += vertexCount;
+        Record(Command::Type::DrawLines, vertexCount);
+    }
+
+    NullRendererAPI::Counters NullRendererAPI::GetCounters() const
+    {
+        Counters counters = m_Counters;
+        counters.GLCalls = s_GLCallCount;
+        return counters;
+    }
+
+    void NullRendererAPI::Reset()
+    {
+        m_Commands.clear();
+        m_Counters = Counters();
+        s_GLCallCount = 0;
+    }
+
+    void NullRendererAPI::Record(Command::Type type, uint32_t count)
+    {
+        if (m_Recording)
+            m_Commands.push_back({ type, count });
+    }
+
+}
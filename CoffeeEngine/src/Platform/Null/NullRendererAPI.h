@@ -0,0 +1,92 @@
+#pragma once
+
+#include "CoffeeEngine/Renderer/RendererAPI.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @brief Renderer API backend that runs without a GPU or window.
+     *
+     * Every call is accepted and recorded so the frames can be inspected by tests and benchmarks.
+     * On creation it also points the GLAD entry points to no-op functions, so Texture2D, Shader,
+     * Framebuffer, VertexArray and the buffers can be created without an OpenGL context.
+     */
+    class NullRendererAPI : public RendererAPI
+    {
+    public:
+        /**
+         * @brief A recorded Renderer API call.
+         */
+        struct Command
+        {
+            enum class Type
+            {
+                SetClearColor,
+                Clear,
+                SetDepthMask,
+                DrawIndexed,
+                DrawLines
+            };
+
+            Type CommandType; ///< The recorded call.
+            uint32_t Count = 0; ///< Index count for DrawIndexed, vertex count for DrawLines.
+        };
+
+        /**
+         * @brief Counters accumulated since the last Reset().
+         */
+        struct Counters
+        {
+            uint32_t DrawCalls = 0; ///< Number of DrawIndexed and DrawLines calls.
+            uint64_t IndexCount = 0; ///< Number of indices drawn.
+            uint64_t LineVertexCount = 0; ///< Number of line vertices drawn.
+            uint32_t Clears = 0; ///< Number of clears.
+            uint32_t StateChanges = 0; ///< Number of clear color and depth mask changes.
+            uint64_t GLCalls = 0; ///< Number of OpenGL calls made by the resources and swallowed.
+        };
+
+        NullRendererAPI();
+
+        void InitImpl() override;
+        void SetClearColorImpl(const glm::vec4& color) override;
+        void ClearImpl() override;
+        void SetDepthMaskImpl(bool enabled) override;
+        void DrawIndexedImpl(const Ref<VertexArray>& vertexArray) override;
+        void DrawLinesImpl(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, float lineWidth) override;
+
+        /**
+         * @brief Gets the recorded command stream.
+         * @return The commands recorded since the last Reset().
+         */
+        const std::vector<Command>& GetCommands() const { return m_Commands; }
+
+        /**
+         * @brief Gets the counters.
+         * @return The counters accumulated since the last Reset().
+         */
+        Counters GetCounters() const;
+
+        /**
+         * @brief Enables or disables recording the command stream. The counters are always updated.
+         * @param enabled True to record the commands.
+         */
+        void SetRecording(bool enabled) { m_Recording = enabled; }
+
+        /**
+         * @brief Clears the recorded commands and the counters.
+         */
+        void Reset();
+
+    private:
+        void Record(Command::Type type, uint32_t count = 0);
+
+    private:
+        std::vector<Command> m_Commands; ///< The recorded command stream.
+        Counters m_Counters; ///< The counters.
+        bool m_Recording = true; ///< Whether the command stream is recorded.
+    };
+
+}
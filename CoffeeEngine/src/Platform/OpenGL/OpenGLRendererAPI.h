@@ -0,0 +1,18 @@
+#pragma once
+
+#include "CoffeeEngine/Renderer/RendererAPI.h"
+
+namespace Coffee {
+
+    class OpenGLRendererAPI : public RendererAPI
+    {
+    public:
+        void InitImpl() override;
+        void SetClearColorImpl(const glm::vec4& color) override;
+        void ClearImpl() override;
+        void SetDepthMaskImpl(bool enabled) override;
+        void DrawIndexedImpl(const Ref<VertexArray>& vertexArray) override;
+        void DrawLinesImpl(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, float lineWidth) override;
+    };
+
+}
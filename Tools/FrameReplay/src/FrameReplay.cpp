@@ -0,0 +1,153 @@
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Core/FrameAllocator.h"
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/Core/Stopwatch.h"
+#include "CoffeeEngine/Core/Window.h"
+#include "CoffeeEngine/IO/CacheManager.h"
+#include "CoffeeEngine/Renderer/FrameCapture.h"
+#include "CoffeeEngine/Renderer/Renderer.h"
+#include "CoffeeEngine/Renderer/RendererAPI.h"
+#include "Platform/Null/NullRendererAPI.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace Coffee;
+
+static void PrintUsage()
+{
+    std::printf("Usage: FrameReplay <capture.TeaCapture> [--null] [--frames N] [--warmup N] [--cache <project cache directory>]\n");
+    std::printf("  --null     Replay against the null Renderer API backend, no GPU or window needed\n");
+    std::printf("  --frames   Number of measured replays (default 100)\n");
+    std::printf("  --warmup   Number of replays before measuring (default 10)\n");
+    std::printf("  --cache    Cache directory of the captured project, used to load the meshes and materials\n");
+}
+
+int main(int argc, const char** argv)
+{
+    std::filesystem::path capturePath;
+    std::filesystem::path cachePath;
+    bool useNullBackend = false;
+    int frames = 100;
+    int warmupFrames = 10;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--null")
+            useNullBackend = true;
+        else if (arg == "--frames" && i + 1 < argc)
+            frames = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--warmup" && i + 1 < argc)
+            warmupFrames = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--cache" && i + 1 < argc)
+            cachePath = argv[++i];
+        else if (capturePath.empty())
+            capturePath = arg;
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (capturePath.empty())
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    Log::Init();
+
+    FrameCaptureData capture;
+    if (!FrameCapture::Load(capturePath, capture))
+        return 1;
+
+    uint32_t width = capture.ViewportWidth > 0 ? capture.ViewportWidth : 1280;
+    uint32_t height = capture.ViewportHeight > 0 ? capture.ViewportHeight : 720;
+
+    // The backend has to be selected before any GPU resource is created
+    Scope<Window> window;
+    if (useNullBackend)
+    {
+        RendererAPI::SetAPI(RendererAPI::API::None);
+    }
+    else
+    {
+        window = Window::Create(WindowProps("Coffee Frame Replay", width, height));
+        window->SetVSync(false);
+    }
+
+    if (!cachePath.empty())
+        CacheManager::SetCachePath(cachePath);
+
+    FrameAllocator::Init();
+    Renderer::Init();
+    Renderer::OnResize(width, height);
+
+    std::vector<RenderCommand> renderQueue = FrameCapture::BuildRenderQueue(capture);
+
+    for (int i = 0; i < warmupFrames; i++)
+    {
+        FrameAllocator::NewFrame();
+        FrameCapture::Replay(capture, renderQueue);
+        if (window) window->OnUpdate();
+    }
+
+    NullRendererAPI* nullAPI = useNullBackend ? static_cast<NullRendererAPI*>(RendererAPI::Get()) : nullptr;
+    if (nullAPI)
+    {
+        nullAPI->SetRecording(false);
+        nullAPI->Reset();
+    }
+
+    std::vector<double> frameTimes;
+    frameTimes.reserve(frames);
+
+    for (int i = 0; i < frames; i++)
+    {
+        // Only the CPU submission is measured, presenting is left out
+        FrameAllocator::NewFrame();
+
+        Stopwatch stopwatch;
+        stopwatch.Start();
+        FrameCapture::Replay(capture, renderQueue);
+        stopwatch.Stop();
+
+        frameTimes.push_back(stopwatch.GetPreciseElapsedTime() * 1000.0);
+
+        if (window) window->OnUpdate();
+    }
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+
+    double total = 0.0;
+    for (double frameTime : frameTimes)
+        total += frameTime;
+
+    std::printf("Capture:  %s (%zu draws, %zu calls, %zu lights)\n", capturePath.string().c_str(), capture.Draws.size(), capture.Events.size(), capture.Lights.size());
+    std::printf("Backend:  %s\n", useNullBackend ? "Null" : "OpenGL");
+    std::printf("Frames:   %d\n", frames);
+    std::printf("Mean:     %.4f ms\n", total / frames);
+    std::printf("Median:   %.4f ms\n", frameTimes[frameTimes.size() / 2]);
+    std::printf("P95:      %.4f ms\n", frameTimes[std::min(frameTimes.size() - 1, frameTimes.size() * 95 / 100)]);
+    std::printf("Min/Max:  %.4f / %.4f ms\n", frameTimes.front(), frameTimes.back());
+
+    if (nullAPI)
+    {
+        NullRendererAPI::Counters counters = nullAPI->GetCounters();
+        std::printf("Per frame: %.1f draw calls, %.1f state changes, %.1f OpenGL calls\n",
+                    counters.DrawCalls / (double)frames, counters.StateChanges / (double)frames, counters.GLCalls / (double)frames);
+    }
+
+    Renderer::Shutdown();
+    FrameAllocator::Shutdown();
+    Log::Shutdown();
+
+    return 0;
+}
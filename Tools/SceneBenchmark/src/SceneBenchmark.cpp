@@ -0,0 +1,158 @@
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Core/JobSystem.h"
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/Core/Stopwatch.h"
+#include "CoffeeEngine/IO/ResourceFormat.h"
+#include "CoffeeEngine/Scene/Components.h"
+#include "CoffeeEngine/Scene/Entity.h"
+#include "CoffeeEngine/Scene/Scene.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace Coffee;
+
+static void PrintUsage()
+{
+    std::printf("Usage: SceneBenchmark [--entities N] [--runs N] [--output <directory>]\n");
+    std::printf("  --entities  Number of entities of the generated scene (default 100000)\n");
+    std::printf("  --runs      Number of measured saves and loads per format (default 5)\n");
+    std::printf("  --output    Directory the scene files are written to (default the temporary directory)\n");
+}
+
+// Roots with a few levels of children, every tenth entity is a light and every fifth one is static
+static Ref<Scene> BuildScene(int entityCount)
+{
+    Ref<Scene> scene = CreateRef<Scene>();
+
+    std::vector<Entity> parents;
+    for (int i = 0; i < entityCount; i++)
+    {
+        Entity entity = scene->CreateEntity("Entity " + std::to_string(i));
+
+        auto& transform = entity.GetComponent<TransformComponent>();
+        transform.Position = { (float)(i % 100), (float)(i / 100 % 100), (float)(i / 10000) };
+
+        if (i % 10 == 0)
+            entity.AddComponent<LightComponent>();
+        if (i % 5 == 0)
+            entity.AddComponent<StaticComponent>();
+
+        if (i % 8 == 0)
+        {
+            parents.clear();
+            parents.push_back(entity);
+        }
+        else
+        {
+            entity.SetParent(parents.back());
+            if (parents.size() < 4)
+                parents.push_back(entity);
+        }
+    }
+
+    return scene;
+}
+
+struct Timings
+{
+    std::vector<double> Save;
+    std::vector<double> Load;
+    uintmax_t FileSize = 0;
+    size_t LoadedEntities = 0;
+};
+
+static double Median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+static Timings Measure(const Ref<Scene>& scene, const std::filesystem::path& path, ResourceFormat format, int runs)
+{
+    Timings timings;
+
+    for (int i = 0; i < runs; i++)
+    {
+        Stopwatch stopwatch;
+        stopwatch.Start();
+        Scene::Save(path, scene, format);
+        stopwatch.Stop();
+        timings.Save.push_back(stopwatch.GetPreciseElapsedTime() * 1000.0);
+
+        stopwatch.Reset();
+        stopwatch.Start();
+        Ref<Scene> loaded = Scene::Load(path);
+        stopwatch.Stop();
+        timings.Load.push_back(stopwatch.GetPreciseElapsedTime() * 1000.0);
+
+        if (loaded)
+            timings.LoadedEntities = loaded->GetAllEntitiesWithComponents<TagComponent>().size();
+    }
+
+    timings.FileSize = std::filesystem::file_size(path);
+    return timings;
+}
+
+static void PrintTimings(const char* name, const Timings& timings)
+{
+    std::printf("%-7s save %10.2f ms   load %10.2f ms   file %8.2f MiB   loaded %zu entities\n",
+                name, Median(timings.Save), Median(timings.Load), timings.FileSize / (1024.0 * 1024.0), timings.LoadedEntities);
+}
+
+int main(int argc, const char** argv)
+{
+    int entityCount = 100000;
+    int runs = 5;
+    std::filesystem::path outputPath = std::filesystem::temp_directory_path();
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--entities" && i + 1 < argc)
+            entityCount = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--runs" && i + 1 < argc)
+            runs = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--output" && i + 1 < argc)
+            outputPath = argv[++i];
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    Log::Init();
+    JobSystem::Init();
+
+    Ref<Scene> scene = BuildScene(entityCount);
+
+    std::filesystem::path jsonPath = outputPath / "SceneBenchmark.TeaScene";
+    std::filesystem::path binaryPath = outputPath / "SceneBenchmark.binary.TeaScene";
+
+    // The per entity logging would be measured too
+    Log::GetCoreLogger()->set_level(spdlog::level::warn);
+
+    Timings json = Measure(scene, jsonPath, ResourceFormat::JSON, runs);
+    Timings binary = Measure(scene, binaryPath, ResourceFormat::Binary, runs);
+
+    std::printf("Entities: %d, median of %d runs\n", entityCount, runs);
+    PrintTimings("JSON", json);
+    PrintTimings("Binary", binary);
+    std::printf("Speedup: save %.1fx, load %.1fx\n", Median(json.Save) / Median(binary.Save), Median(json.Load) / Median(binary.Load));
+
+    std::filesystem::remove(jsonPath);
+    std::filesystem::remove(binaryPath);
+
+    scene.reset();
+
+    JobSystem::Shutdown();
+    Log::Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/IO/ResourceFormat.h"
+#include "CoffeeEngine/Renderer/RendererAPI.h"
+#include "CoffeeEngine/Scene/Components.h"
+#include "CoffeeEngine/Scene/Entity.h"
+#include "CoffeeEngine/Scene/Scene.h"
+#include "CoffeeEngine/Scene/SceneBinarySerializer.h"
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/vector.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Coffee;
+
+static int s_Failures = 0;
+
+static void Check(bool condition, const char* test, const std::string& message)
+{
+    if (condition)
+        return;
+
+    std::printf("FAILED %s: %s\n", test, message.c_str());
+    s_Failures++;
+}
+
+// Saves a small scene with every component that has no resources, loads it back and compares it entity by entity
+static void TestRoundTrip(const std::filesystem::path& path)
+{
+    const char* test = "RoundTrip";
+
+    Ref<Scene> scene = CreateRef<Scene>();
+
+    SceneSettings settings;
+    settings.SortedTransforms = true;
+    scene->SetSettings(settings);
+
+    std::vector<Entity> entities;
+    for (int i = 0; i < 32; i++)
+    {
+        Entity entity = scene->CreateEntity("Entity " + std::to_string(i));
+        entity.GetComponent<TransformComponent>().Position = { (float)i, (float)(i * 2), (float)(i * 3) };
+
+        if (i % 4 == 0)
+            entity.AddComponent<LightComponent>().Intensity = (float)i;
+        if (i % 3 == 0)
+            entity.AddComponent<StaticComponent>().Occluder = true;
+        if (i % 8 != 0)
+            entity.SetParent(entities[i - i % 8]);
+
+        entities.push_back(entity);
+    }
+
+    Scene::Save(path, scene, ResourceFormat::Binary);
+
+    Check(SceneBinarySerializer::IsBinaryScene(path), test, "the saved file is not a binary scene");
+
+    Ref<Scene> loaded = Scene::Load(path);
+    Check(loaded != nullptr, test, "the saved scene could not be loaded");
+    if (!loaded)
+        return;
+
+    Check(loaded->GetSettings().SortedTransforms, test, "the scene settings were not loaded");
+    Check(loaded->GetAllEntitiesWithComponents<TagComponent>().size() == entities.size(), test, "the entity count differs");
+
+    for (Entity original : entities)
+    {
+        Entity copy((entt::entity)original, loaded.get());
+        std::string name = original.GetComponent<TagComponent>().Tag;
+
+        const TagComponent* tag = copy.TryGetComponent<TagComponent>();
+        Check(tag && tag->Tag == name, test, name + " lost its tag");
+
+        const TransformComponent* transform = copy.TryGetComponent<TransformComponent>();
+        Check(transform && transform->Position == original.GetComponent<TransformComponent>().Position, test, name + " lost its position");
+
+        const HierarchyComponent* hierarchy = copy.TryGetComponent<HierarchyComponent>();
+        Check(hierarchy && hierarchy->m_Parent == original.GetComponent<HierarchyComponent>().m_Parent, test, name + " lost its parent");
+
+        const LightComponent* light = copy.TryGetComponent<LightComponent>();
+        const LightComponent* originalLight = original.TryGetComponent<LightComponent>();
+        Check((light != nullptr) == (originalLight != nullptr), test, name + " gained or lost its light");
+        if (light && originalLight)
+            Check(light->Intensity == originalLight->Intensity, test, name + " lost its light intensity");
+
+        const StaticComponent* staticComponent = copy.TryGetComponent<StaticComponent>();
+        Check((staticComponent != nullptr) == (original.TryGetComponent<StaticComponent>() != nullptr), test, name + " gained or lost its static component");
+        if (staticComponent)
+            Check(staticComponent->Occluder, test, name + " lost its occluder flag");
+    }
+}
+
+// Writes a chunk the way SceneBinarySerializer does: type, component count and size, then the payload
+static void WriteChunk(cereal::BinaryOutputArchive& archive, uint32_t chunk, uint32_t count, const std::string& payload)
+{
+    archive(chunk, count, static_cast<uint64_t>(payload.size()));
+    archive(cereal::binary_data(payload.data(), payload.size()));
+}
+
+// A section with a chunk of an unknown type and a static chunk written before the Occluder field existed
+static void TestOldAndUnknownChunks()
+{
+    const char* test = "OldAndUnknownChunks";
+
+    const std::vector<uint32_t> entities = { 0, 1 };
+
+    // Bytes a reader that does not skip the chunk would take for an entity list and components
+    std::string unknownPayload(64, '\xff');
+
+    // StaticComponent version 0, the class version is stored once before the first component of the chunk
+    std::ostringstream staticPayload(std::ios::binary);
+    {
+        cereal::BinaryOutputArchive archive(staticPayload);
+        archive(entities);
+        archive(static_cast<uint32_t>(0));
+        archive(false);
+        archive(true);
+    }
+
+    std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+    {
+        cereal::BinaryOutputArchive archive(stream);
+        archive(entities);
+        archive(static_cast<uint32_t>(2));
+        WriteChunk(archive, 0xC0FFEE, 1, unknownPayload);
+        WriteChunk(archive, static_cast<uint32_t>(SceneChunk::Static), static_cast<uint32_t>(entities.size()), staticPayload.str());
+    }
+
+    SceneSection section;
+    SceneBinarySerializer::ReadSection(stream, section);
+
+    Check(section.Entities.size() == entities.size(), test, "the section entities were not read");
+    Check(section.Statics.Components.size() == entities.size(), test, "the static chunk after the unknown chunk was not read");
+    if (section.Statics.Components.size() != entities.size())
+        return;
+
+    Check(!section.Statics.Components[0].Batched && section.Statics.Components[1].Batched, test, "the version 0 Batched fields were not read");
+    Check(!section.Statics.Components[0].Occluder && !section.Statics.Components[1].Occluder, test, "the missing Occluder fields are not the default");
+
+    entt::registry registry;
+    SceneBinarySerializer::ReserveEntities(section.Entities, registry);
+    SceneBinarySerializer::MergeSection(section, registry);
+
+    Check(registry.all_of<StaticComponent>(entt::entity{1}) && registry.get<StaticComponent>(entt::entity{1}).Batched, test, "the static components were not merged");
+}
+
+// A file of another format version is rejected instead of loaded as an empty scene
+static void TestOtherVersion(const std::filesystem::path& path)
+{
+    const char* test = "OtherVersion";
+
+    {
+        std::ofstream file(path, std::ios::binary);
+        cereal::BinaryOutputArchive archive(file);
+        archive(SceneBinarySerializer::Magic, SceneBinarySerializer::Version - 1, static_cast<uint32_t>(0));
+    }
+
+    Check(Scene::Load(path) == nullptr, test, "a scene of another version was loaded");
+}
+
+int main()
+{
+    Log::Init();
+
+    // Nothing here needs a GPU, and nothing may create a GL resource without a context
+    RendererAPI::SetAPI(RendererAPI::API::None);
+    RendererAPI::Init();
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "SceneFormatTest.TeaScene";
+
+    TestRoundTrip(path);
+    TestOldAndUnknownChunks();
+    TestOtherVersion(path);
+
+    std::filesystem::remove(path);
+
+    if (s_Failures == 0)
+        std::printf("All scene format tests passed\n");
+
+    Log::Shutdown();
+
+    return s_Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Core/JobSystem.h"
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/Core/Stopwatch.h"
+#include "CoffeeEngine/Scene/Entity.h"
+#include "CoffeeEngine/Scene/Scene.h"
+#include "CoffeeEngine/Scripting/Lua/LuaBackend.h"
+#include "CoffeeEngine/Scripting/Script.h"
+#include "CoffeeEngine/Scripting/ScriptManager.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Coffee;
+
+static void PrintUsage()
+{
+    std::printf("Usage: ScriptBenchmark [--entities N] [--frames N] [--warmup N]\n");
+    std::printf("  --entities  Number of scripted entities (default 10000)\n");
+    std::printf("  --frames    Number of measured updates (default 200)\n");
+    std::printf("  --warmup    Number of updates before measuring (default 20)\n");
+}
+
+struct BenchmarkCase
+{
+    const char* Name;
+    const char* Source;
+    bool Parallel;
+};
+
+// The empty update measures the dispatch alone, the others add a component read through self
+static const BenchmarkCase s_Cases[] = {
+    { "Empty OnUpdate", "function OnUpdate(self)\nend\n", false },
+    { "GetComponent", "function OnUpdate(self)\n    local tag = self:GetComponent(component.Tag).tag\nend\n", false },
+    { "GetComponent (parallel)", "--[[thread_safe]]\nfunction OnUpdate(self)\n    local tag = self:GetComponent(component.Tag).tag\nend\n", true },
+};
+
+static double RunCase(const BenchmarkCase& benchmarkCase, const std::filesystem::path& scriptPath, int entityCount, int frames, int warmupFrames)
+{
+    {
+        std::ofstream scriptFile(scriptPath);
+        scriptFile << benchmarkCase.Source;
+    }
+
+    LuaBackend::InvalidateCompiledScript(scriptPath);
+    LuaBackend::SetParallelScripts(benchmarkCase.Parallel);
+
+    Ref<Scene> scene = CreateRef<Scene>();
+    for (int i = 0; i < entityCount; i++)
+    {
+        Entity entity = scene->CreateEntity("Scripted " + std::to_string(i));
+        entity.AddComponent<ScriptComponent>(scriptPath, ScriptingLanguage::Lua);
+    }
+
+    for (int i = 0; i < warmupFrames; i++)
+        ScriptManager::UpdateInstances(scene.get());
+
+    std::vector<double> frameTimes;
+    frameTimes.reserve(frames);
+
+    for (int i = 0; i < frames; i++)
+    {
+        Stopwatch stopwatch;
+        stopwatch.Start();
+        ScriptManager::UpdateInstances(scene.get());
+        stopwatch.Stop();
+
+        frameTimes.push_back(stopwatch.GetPreciseElapsedTime() * 1000.0);
+    }
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    double median = frameTimes[frameTimes.size() / 2];
+
+    std::printf("%-24s median %8.3f ms   P95 %8.3f ms   %8.1f ns per entity\n",
+                benchmarkCase.Name, median, frameTimes[std::min(frameTimes.size() - 1, frameTimes.size() * 95 / 100)],
+                median * 1000000.0 / entityCount);
+
+    return median;
+}
+
+int main(int argc, const char** argv)
+{
+    int entityCount = 10000;
+    int frames = 200;
+    int warmupFrames = 20;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--entities" && i + 1 < argc)
+            entityCount = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--frames" && i + 1 < argc)
+            frames = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--warmup" && i + 1 < argc)
+            warmupFrames = std::max(0, std::atoi(argv[++i]));
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    Log::Init();
+    JobSystem::Init();
+
+    ScriptManager::RegisterBackend(ScriptingLanguage::Lua, std::make_shared<LuaBackend>());
+
+    std::filesystem::path scriptPath = std::filesystem::temp_directory_path() / "ScriptBenchmark.lua";
+
+    std::printf("Entities: %d, %d measured updates, %u workers\n", entityCount, frames, JobSystem::GetWorkerCount());
+    for (const BenchmarkCase& benchmarkCase : s_Cases)
+        RunCase(benchmarkCase, scriptPath, entityCount, frames, warmupFrames);
+
+    std::filesystem::remove(scriptPath);
+
+    JobSystem::Shutdown();
+    Log::Shutdown();
+
+    return 0;
+}